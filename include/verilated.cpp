@@ -200,6 +200,17 @@ void VL_FINISH_MT(const char* filename, int linenum, const char* hier) VL_MT_SAF
     }});
 }
 
+void VL_FINISH_INSTANCE_MT(int instance, int instances, const char* filename, int linenum,
+                           const char* hier) VL_MT_SAFE {
+    VerilatedThreadMsgQueue::post(VerilatedMsg{[=]() {
+        const int numFinished = Verilated::threadContextp()->finishInstance(instance, instances);
+        if (!numFinished) return;
+        VL_PRINTF(  // Not VL_PRINTF_MT, already on main thread
+            "- %s:%d: Verilog $finish of instance %d\n", filename, linenum, instance);
+        if (numFinished == instances) vl_finish(filename, linenum, hier);
+    }});
+}
+
 void VL_STOP_MT(const char* filename, int linenum, const char* hier, bool maybe) VL_MT_SAFE {
     VerilatedThreadMsgQueue::post(VerilatedMsg{[=]() {  //
         vl_stop_maybe(filename, linenum, hier, maybe);
@@ -1679,6 +1690,14 @@ IData VL_TESTPLUSARGS_I(const std::string& format) VL_MT_SAFE {
     return match.empty() ? 0 : 1;
 }
 
+std::string VL_INSTANCE_PLUSARGS(int instance, const std::string& ld) VL_MT_SAFE {
+    const std::string instld = std::to_string(instance) + ":" + ld;
+    // Same prefix as VL_VALUEPLUSARGS_IN*, the text before the first format
+    const std::string prefix = instld.substr(0, instld.find('%'));
+    const std::string& match = Verilated::threadContextp()->impp()->argPlusMatch(prefix.c_str());
+    return match.empty() ? ld : instld;
+}
+
 IData VL_VALUEPLUSARGS_INW(int rbits, const std::string& ld, WDataOutP rwp) VL_MT_SAFE {
     std::string prefix;
     bool inPct = false;
@@ -2403,6 +2422,10 @@ void VerilatedContext::gotError(bool flag) VL_MT_SAFE {
 void VerilatedContext::gotFinish(bool flag) VL_MT_SAFE {
     const VerilatedLockGuard lock{m_mutex};
     m_s.m_gotFinish = flag;
+    if (!flag) {  // Restarting, every copy of the top has to finish again
+        m_finishedInstances.clear();
+        m_numFinishedInstances = 0;
+    }
 }
 void VerilatedContext::profExecStart(uint64_t flag) VL_MT_SAFE {
     const VerilatedLockGuard lock{m_mutex};
@@ -2412,6 +2435,10 @@ void VerilatedContext::profExecWindow(uint64_t flag) VL_MT_SAFE {
     const VerilatedLockGuard lock{m_mutex};
     m_ns.m_profExecWindow = flag;
 }
+void VerilatedContext::profExecCounters(bool flag) VL_MT_SAFE {
+    const VerilatedLockGuard lock{m_mutex};
+    m_ns.m_profExecCounters = flag;
+}
 void VerilatedContext::profExecFilename(const std::string& flag) VL_MT_SAFE {
     const VerilatedLockGuard lock{m_mutex};
     m_ns.m_profExecFilename = flag;
@@ -2461,6 +2488,15 @@ void VerilatedContext::threads(unsigned n) {
     }
 }
 
+void VerilatedContext::threadsNuma(const std::string& nodes) {
+    if (m_threadPool) {
+        VL_FATAL_MT(__FILE__, __LINE__, "",
+                    "%Error: Cannot set simulation NUMA nodes after the thread pool has been "
+                    "created.");
+    }
+    m_threadsNuma = nodes;
+}
+
 void VerilatedContext::commandArgs(int argc, const char** argv) VL_MT_SAFE_EXCLUDES(m_argMutex) {
     // Not locking m_argMutex here, it is done in impp()->commandArgsAddGuts
     // m_argMutex here is the same as in impp()->commandArgsAddGuts;
@@ -2607,6 +2643,8 @@ void VerilatedContextImp::commandArgVl(const std::string& arg) {
                         "Exiting due to command line argument (not an error)");
         } else if (arg == "+verilator+noassert") {
             assertOn(false);
+        } else if (arg == "+verilator+prof+exec+counters") {
+            profExecCounters(true);
         } else if (commandArgVlUint64(arg, "+verilator+prof+exec+start+", u64)
                    || commandArgVlUint64(arg, "+verilator+prof+threads+start+", u64)) {
             profExecStart(u64);
@@ -2623,6 +2661,10 @@ void VerilatedContextImp::commandArgVl(const std::string& arg) {
         } else if (commandArgVlUint64(arg, "+verilator+seed+", u64, 1,
                                       std::numeric_limits<int>::max())) {
             randSeed(static_cast<int>(u64));
+        } else if (commandArgVlString(arg, "+verilator+threads+numa+", str)) {
+            threadsNuma(str);
+        } else if (arg == "+verilator+threads+spin") {
+            threadsSpin(true);
         } else if (arg == "+verilator+V") {
             VerilatedImp::versionDump();  // Someday more info too
             VL_FATAL_MT("COMMAND_LINE", 0, "",
@@ -2732,6 +2774,13 @@ const VerilatedScope* VerilatedContext::scopeFind(const char* namep) const VL_MT
 const VerilatedScopeNameMap* VerilatedContext::scopeNameMap() VL_MT_SAFE {
     return &(impp()->m_impdatap->m_nameMap);
 }
+int VerilatedContext::finishInstance(int instance, int instances) VL_MT_SAFE {
+    const VerilatedLockGuard lock{m_mutex};
+    if (m_finishedInstances.empty()) m_finishedInstances.resize(instances, false);
+    if (m_finishedInstances[instance]) return 0;
+    m_finishedInstances[instance] = true;
+    return ++m_numFinishedInstances;
+}
 
 //======================================================================
 // VerilatedSyms:: Methods
@@ -377,11 +377,16 @@ protected:
         // Fast path
         uint64_t m_profExecStart = 1;  // +prof+exec+start time
         uint32_t m_profExecWindow = 2;  // +prof+exec+window size
+        bool m_profExecCounters = false;  // +prof+exec+counters
         // Slow path
         std::string m_profExecFilename;  // +prof+exec+file filename
         std::string m_profVltFilename;  // +prof+vlt filename
     } m_ns;
 
+    // Copies of the top (--instances) that executed $finish, see finishInstance()
+    std::vector<bool> m_finishedInstances VL_GUARDED_BY(m_mutex);
+    int m_numFinishedInstances VL_GUARDED_BY(m_mutex) = 0;
+
     mutable VerilatedMutex m_argMutex;  // Protect m_argVec, m_argVecLoaded
     // no need to be save-restored (serialized) the
     // assumption is that the restore is allowed to pass different arguments
@@ -395,6 +400,10 @@ protected:
     const std::unique_ptr<VerilatedContextImpData> m_impdatap;
     // Number of threads to use for simulation (size of m_threadPool + 1 for main thread)
     unsigned m_threads = std::thread::hardware_concurrency();
+    // Pool threads spin instead of sleeping between evaluations
+    std::atomic<bool> m_threadsSpin{false};
+    // NUMA nodes the threads are pinned to, empty if not pinned
+    std::string m_threadsNuma;
     // The thread pool shared by all models added to this context
     std::unique_ptr<VerilatedVirtualBase> m_threadPool;
     // The execution profiler shared by all models added to this context
@@ -537,6 +546,17 @@ public:
     /// Set number of threads used for simulation (including the main thread)
     /// Can only be called before the thread pool is created (before first model is added).
     void threads(unsigned n);
+    /// Get whether idle pool threads spin rather than sleep between evaluations
+    bool threadsSpin() const VL_MT_SAFE { return m_threadsSpin.load(std::memory_order_relaxed); }
+    /// Set whether idle pool threads spin rather than sleep between evaluations.
+    /// Spinning makes dispatching tasks to the threads cheaper, but keeps every
+    /// thread of the pool busy until it is turned off again.
+    void threadsSpin(bool flag) VL_MT_SAFE { m_threadsSpin.store(flag); }
+    /// Get the NUMA nodes the simulation threads are pinned to, empty if not pinned
+    const std::string& threadsNuma() const { return m_threadsNuma; }
+    /// Set the NUMA nodes to pin the simulation threads to, as a list such as "0,1" or "0-1".
+    /// Can only be called before the thread pool is created (before first model is added).
+    void threadsNuma(const std::string& nodes);
 
     /// Allow traces to at some point be enabled (disables some optimizations)
     void traceEverOn(bool flag) VL_MT_SAFE {
@@ -577,6 +597,8 @@ public:
     uint64_t profExecStart() const VL_MT_SAFE { return m_ns.m_profExecStart; }
     void profExecWindow(uint64_t flag) VL_MT_SAFE;
     uint32_t profExecWindow() const VL_MT_SAFE { return m_ns.m_profExecWindow; }
+    void profExecCounters(bool flag) VL_MT_SAFE;
+    bool profExecCounters() const VL_MT_SAFE { return m_ns.m_profExecCounters; }
     void profExecFilename(const std::string& flag) VL_MT_SAFE;
     std::string profExecFilename() const VL_MT_SAFE;
     void profVltFilename(const std::string& flag) VL_MT_SAFE;
@@ -586,6 +608,10 @@ public:
     const VerilatedScope* scopeFind(const char* namep) const VL_MT_SAFE;
     const VerilatedScopeNameMap* scopeNameMap() VL_MT_SAFE;
 
+    // Internal: $finish of one of the copies of the top (--instances). Returns the number
+    // of copies finished so far, or 0 if this copy had already finished.
+    int finishInstance(int instance, int instances) VL_MT_SAFE;
+
     // Internal: Serialization setup
     static constexpr size_t serialized1Size() VL_PURE { return sizeof(m_s); }
     void* serialized1Ptr() VL_MT_UNSAFE { return &m_s; }
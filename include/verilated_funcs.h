@@ -63,6 +63,10 @@ extern void vl_warn(const char* filename, int linenum, const char* hier,
 
 /// Multithread safe wrapper for calls to $finish
 extern void VL_FINISH_MT(const char* filename, int linenum, const char* hier) VL_MT_SAFE;
+/// Multithread safe wrapper for calls to $finish in one of --instances, the
+/// simulation finishes once all instances did
+extern void VL_FINISH_INSTANCE_MT(int instance, int instances, const char* filename, int linenum,
+                                  const char* hier) VL_MT_SAFE;
 /// Multithread safe wrapper for calls to $stop
 extern void VL_STOP_MT(const char* filename, int linenum, const char* hier,
                        bool maybe = true) VL_MT_SAFE;
@@ -146,6 +150,8 @@ extern IData VL_SYSTEM_IQ(QData lhs) VL_MT_SAFE;
 inline IData VL_SYSTEM_II(IData lhs) VL_MT_SAFE { return VL_SYSTEM_IQ(lhs); }
 
 extern IData VL_TESTPLUSARGS_I(const std::string& format) VL_MT_SAFE;
+/// Plusargs search string of one of --instances, "+<instance>:<arg>" overrides "+<arg>"
+extern std::string VL_INSTANCE_PLUSARGS(int instance, const std::string& ld) VL_MT_SAFE;
 extern const char* vl_mc_scan_plusargs(const char* prefixp) VL_MT_SAFE;  // PLIish
 
 //=========================================================================
@@ -22,17 +22,96 @@
 
 #include "verilated_threads.h"
 
+#include <cerrno>
+#include <cstring>
 #include <fstream>
 #include <string>
 
+// clang-format off
+#if defined(__linux)
+# include <linux/perf_event.h>  // For perf_event_attr
+# include <sys/syscall.h>  // For SYS_perf_event_open
+# include <unistd.h>  // For syscall(), read(), close()
+#endif
+// clang-format on
+
 //=============================================================================
 // Globals
 
 // Internal note: Globals may multi-construct, see verilated.cpp top.
 
 thread_local VlExecutionProfiler::ExecutionTrace VlExecutionProfiler::t_trace;
+thread_local VlExecutionCounters VlExecutionProfiler::t_counters;
+thread_local VlExecutionCounters* VlExecutionCounters::t_countersp = nullptr;
 
 constexpr const char* const VlExecutionRecord::s_ascii[];
+constexpr const char* const VlExecutionCounters::s_ascii[];
+
+//=============================================================================
+// VlExecutionCounters implementation
+
+VlExecutionCounters::~VlExecutionCounters() {
+#if defined(__linux)
+    for (const int fd : m_fds) {
+        if (fd >= 0) ::close(fd);
+    }
+#endif
+}
+
+bool VlExecutionCounters::open() {
+#if defined(__linux)
+    static const std::array<std::pair<uint32_t, uint64_t>, _ENUM_END> s_events{{
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                 | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    }};
+    int error = 0;
+    for (size_t i = 0; i < s_events.size(); ++i) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = s_events[i].first;
+        attr.config = s_events[i].second;
+        attr.read_format = PERF_FORMAT_GROUP;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // Count the calling thread, on any CPU, in a single group read at once
+        m_fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, m_leaderFd, 0));
+        if (m_fds[i] < 0) {
+            error = errno;  // Some events are not available on every CPU, count the others
+        } else if (m_leaderFd < 0) {
+            m_leaderFd = m_fds[i];
+        }
+    }
+    if (m_leaderFd >= 0) return true;
+    static std::atomic<bool> s_warned{false};
+    if (!s_warned.exchange(true)) {
+        VL_PRINTF_MT("%%Warning: Cannot open hardware performance counters: %s\n"
+                     "        : See /proc/sys/kernel/perf_event_paranoid\n",
+                     std::strerror(error));
+    }
+#endif
+    return false;
+}
+
+bool VlExecutionCounters::read(Values& values) const {
+    values.fill(0);
+#if defined(__linux)
+    // PERF_FORMAT_GROUP layout: number of events, then their values in opening order
+    uint64_t buffer[_ENUM_END + 1];
+    if (::read(m_leaderFd, buffer, sizeof(buffer)) <= 0) return false;
+    size_t next = 1;
+    for (size_t i = 0; i < values.size() && next <= buffer[0]; ++i) {
+        if (m_fds[i] >= 0) values[i] = buffer[next++];
+    }
+    return true;
+#else
+    return false;
+#endif
+}
 
 //=============================================================================
 // VlPgoProfiler implementation
@@ -136,6 +215,13 @@ void VlExecutionProfiler::setupThread(uint32_t threadId) {
         const VerilatedLockGuard lock{m_mutex};
         exists = !m_traceps.emplace(threadId, &t_trace).second;
     }
+    if (m_context.profExecCounters() && t_counters.open()) {
+        t_counters.m_begins.reserve(RESERVED_TRACE_CAPACITY);
+        t_counters.m_deltas.reserve(RESERVED_TRACE_CAPACITY);
+        VlExecutionCounters::t_countersp = &t_counters;
+        const VerilatedLockGuard lock{m_mutex};
+        m_countersps.emplace(threadId, &t_counters);
+    }
     if (VL_UNLIKELY(exists)) {
         VL_FATAL_MT(__FILE__, __LINE__, "", "multiple initialization of profiler on some thread");
     }
@@ -149,6 +235,7 @@ void VlExecutionProfiler::clear() VL_MT_SAFE_EXCLUDES(m_mutex) {
         tracep->clear();
         tracep->reserve(reserve);
     }
+    for (const auto& pair : m_countersps) pair.second->m_deltas.clear();
 }
 
 void VlExecutionProfiler::dump(const char* filenamep, uint64_t tickEnd)
@@ -185,14 +272,33 @@ void VlExecutionProfiler::dump(const char* filenamep, uint64_t tickEnd)
         ExecutionTrace* const tracep = pair.second;
         fprintf(fp, "VLPROFTHREAD %" PRIu32 "\n", threadId);
 
+        // Counts of the thread, one per EVAL_END and MTASK_END record, in order
+        const auto cit = m_countersps.find(threadId);
+        const VlExecutionCounters* const countersp
+            = cit == m_countersps.end() ? nullptr : cit->second;
+        size_t nextDelta = 0;
+        const auto printCounters = [&]() {
+            if (!countersp || nextDelta >= countersp->m_deltas.size()) return;
+            const VlExecutionCounters::Sample& delta = countersp->m_deltas[nextDelta++];
+            if (!delta.m_valid) return;  // Read failed, report no counts for this record
+            for (size_t i = 0; i < delta.m_values.size(); ++i) {
+                if (countersp->m_fds[i] < 0) continue;
+                fprintf(fp, " %s %" PRIu64, VlExecutionCounters::s_ascii[i],
+                        delta.m_values[i]);
+            }
+        };
+
         for (const VlExecutionRecord& er : *tracep) {
             const char* const name = VlExecutionRecord::s_ascii[static_cast<uint8_t>(er.m_type)];
             const uint64_t time = er.m_tick - m_tickBegin;
             fprintf(fp, "VLPROFEXEC %s %" PRIu64, name, time);
 
             switch (er.m_type) {
-            case VlExecutionRecord::Type::EVAL_BEGIN:
             case VlExecutionRecord::Type::EVAL_END:
+                printCounters();
+                fprintf(fp, "\n");
+                break;
+            case VlExecutionRecord::Type::EVAL_BEGIN:
             case VlExecutionRecord::Type::EVAL_LOOP_BEGIN:
             case VlExecutionRecord::Type::EVAL_LOOP_END:
                 // No payload
@@ -206,7 +312,9 @@ void VlExecutionProfiler::dump(const char* filenamep, uint64_t tickEnd)
             }
             case VlExecutionRecord::Type::MTASK_END: {
                 const auto& payload = er.m_payload.mtaskEnd;
-                fprintf(fp, " id %u predictCost %u\n", payload.m_id, payload.m_predictCost);
+                fprintf(fp, " id %u predictCost %u", payload.m_id, payload.m_predictCost);
+                printCounters();
+                fprintf(fp, "\n");
                 break;
             }
             default: abort();  // LCOV_EXCL_LINE
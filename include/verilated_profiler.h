@@ -51,6 +51,73 @@ VL_ATTR_ALWINLINE QData VL_CPU_TICK() {
     return val;
 }
 
+//=============================================================================
+// Private class used by VlExecutionProfiler, hardware performance counters of one
+// thread, with +verilator+prof+exec+counters
+
+class VlExecutionCounters final {
+    friend class VlExecutionProfiler;
+
+public:
+    // TYPES
+    enum Event : uint8_t {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_MISSES,  // Level 1 data cache read misses
+        LLC_MISSES,  // Last level cache misses
+        BRANCH_MISSES,
+        _ENUM_END
+    };
+    using Values = std::array<uint64_t, _ENUM_END>;
+    struct Sample final {
+        Values m_values;
+        bool m_valid;  // False if the counters could not be read, do not report it
+    };
+
+private:
+    // STATE
+    static constexpr const char* const s_ascii[]
+        = {"cycles", "instructions", "l1dMisses", "llcMisses", "branchMisses"};
+    static thread_local VlExecutionCounters* t_countersp;  // Counters of this thread, if open
+    std::array<int, _ENUM_END> m_fds;  // File descriptor of each event, -1 if not counted
+    int m_leaderFd = -1;  // Event group read at once
+    std::vector<Sample> m_begins;  // Values at each begin not ended yet
+    std::vector<Sample> m_deltas;  // Counts between each begin and end, in order of end
+
+    bool open();  // Open the counters of the calling thread, false if none
+    bool read(Values& values) const;  // False if the read failed
+
+public:
+    // CONSTRUCTOR
+    VlExecutionCounters() { m_fds.fill(-1); }
+    ~VlExecutionCounters();
+
+    // METHODS
+    // Called on the profiled thread when an eval or mtask begins and ends
+    static void begin() {
+        if (VL_UNLIKELY(t_countersp)) {
+            t_countersp->m_begins.emplace_back();
+            Sample& begin = t_countersp->m_begins.back();
+            begin.m_valid = t_countersp->read(begin.m_values);
+        }
+    }
+    static void end() {
+        if (VL_UNLIKELY(t_countersp)) {
+            Sample delta;
+            delta.m_valid = t_countersp->read(delta.m_values);
+            const Sample& begin = t_countersp->m_begins.back();
+            // A failed read at either end would give a meaningless delta, keep the slot
+            // so deltas stay in step with the records, but mark it as not to be reported
+            delta.m_valid = delta.m_valid && begin.m_valid;
+            for (size_t i = 0; i < delta.m_values.size(); ++i) {
+                delta.m_values[i] -= begin.m_values[i];
+            }
+            t_countersp->m_begins.pop_back();
+            t_countersp->m_deltas.push_back(delta);
+        }
+    }
+};
+
 //=============================================================================
 // Private class used by VlExecutionProfiler
 
@@ -109,8 +176,14 @@ public:
     VlExecutionRecord() = default;
 
     // METHODS
-    void evalBegin() { m_type = Type::EVAL_BEGIN; }
-    void evalEnd() { m_type = Type::EVAL_END; }
+    void evalBegin() {
+        m_type = Type::EVAL_BEGIN;
+        VlExecutionCounters::begin();
+    }
+    void evalEnd() {
+        VlExecutionCounters::end();
+        m_type = Type::EVAL_END;
+    }
     void evalLoopBegin() { m_type = Type::EVAL_LOOP_BEGIN; }
     void evalLoopEnd() { m_type = Type::EVAL_LOOP_END; }
     void mtaskBegin(uint32_t id, uint32_t predictStart) {
@@ -118,8 +191,10 @@ public:
         m_payload.mtaskBegin.m_predictStart = predictStart;
         m_payload.mtaskBegin.m_cpu = getcpu();
         m_type = Type::MTASK_BEGIN;
+        VlExecutionCounters::begin();
     }
     void mtaskEnd(uint32_t id, uint32_t predictCost) {
+        VlExecutionCounters::end();
         m_payload.mtaskEnd.m_id = id;
         m_payload.mtaskEnd.m_predictCost = predictCost;
         m_type = Type::MTASK_END;
@@ -152,9 +227,12 @@ class VlExecutionProfiler final : public VerilatedVirtualBase {
     // STATE
     VerilatedContext& m_context;  // The context this profiler is under
     static thread_local ExecutionTrace t_trace;  // thread-local trace buffers
+    static thread_local VlExecutionCounters t_counters;  // thread-local counters
     mutable VerilatedMutex m_mutex;
     // Map from thread id to &t_trace of given thread
     std::map<uint32_t, ExecutionTrace*> m_traceps VL_GUARDED_BY(m_mutex);
+    // Map from thread id to &t_counters of given thread, if the counters are open
+    std::map<uint32_t, VlExecutionCounters*> m_countersps VL_GUARDED_BY(m_mutex);
 
     bool m_enabled = false;  // Is profiling currently enabled
 
@@ -25,10 +25,21 @@
 
 #include "verilated_threads.h"
 
+#include <algorithm>
+#include <cerrno>
 #include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <memory>
 #include <string>
 
+// clang-format off
+#if defined(__linux)
+# include <sys/syscall.h>  // For SYS_move_pages
+# include <unistd.h>  // For syscall(), sysconf()
+#endif
+// clang-format on
+
 //=============================================================================
 // Globals
 
@@ -48,8 +59,10 @@ VlMTaskVertex::VlMTaskVertex(uint32_t upstreamDepCount)
 //=============================================================================
 // VlWorkerThread
 
-VlWorkerThread::VlWorkerThread(VerilatedContext* contextp)
-    : m_ready_size{0}
+VlWorkerThread::VlWorkerThread(VerilatedContext* contextp, VlThreadPool* poolp, unsigned index)
+    : m_contextp{contextp}
+    , m_poolp{poolp}
+    , m_index{index}
     , m_cthread{startWorker, this, contextp} {}
 
 VlWorkerThread::~VlWorkerThread() {
@@ -62,6 +75,23 @@ static void shutdownTask(void*, bool) {  // LCOV_EXCL_LINE
     // Deliberately empty, we use the address of this function as a magic number
 }
 
+void VlWorkerThread::sleepUntilReady() VL_MT_SAFE_EXCLUDES(m_mutex) {
+    VerilatedLockGuard lock{m_mutex};
+    // Announce the wait before checking the ring again, addTask checks m_waiting
+    // after publishing a task, so one of the two sees the other
+    m_waiting.store(true, std::memory_order_seq_cst);
+    while (m_tail.load(std::memory_order_seq_cst) == m_head.load(std::memory_order_relaxed)
+           && m_jobGeneration.load(std::memory_order_seq_cst) == m_generation) {
+        m_cv.wait(lock);
+    }
+    m_waiting.store(false, std::memory_order_relaxed);
+}
+
+void VlWorkerThread::persistentTask(VlSelfP selfp, bool) {
+    VlWorkerThread* const workerp = static_cast<VlWorkerThread*>(selfp);
+    workerp->m_poolp->runJob(workerp->m_index);
+}
+
 void VlWorkerThread::shutdown() { addTask(shutdownTask, nullptr); }
 
 void VlWorkerThread::wait() {
@@ -93,17 +123,182 @@ void VlWorkerThread::workerLoop() {
 
 void VlWorkerThread::startWorker(VlWorkerThread* workerp, VerilatedContext* contextp) {
     Verilated::threadContextp(contextp);
+    workerp->m_poolp->numaPin(workerp->m_index);
     workerp->workerLoop();
 }
 
 //=============================================================================
 // VlThreadPool
 
-VlThreadPool::VlThreadPool(VerilatedContext* contextp, unsigned nThreads) {
-    for (unsigned i = 0; i < nThreads; ++i) m_workers.push_back(new VlWorkerThread{contextp});
+VlThreadPool::VlThreadPool(VerilatedContext* contextp, unsigned nThreads)
+    : m_jobFnps(nThreads, nullptr) {
+    if (!contextp->threadsNuma().empty()) {
+        numaSetup(contextp->threadsNuma());
+        numaPin(nThreads);
+    }
+    for (unsigned i = 0; i < nThreads; ++i) {
+        m_workers.push_back(new VlWorkerThread{contextp, this, i});
+    }
 }
 
 VlThreadPool::~VlThreadPool() {
     // Each ~WorkerThread will wait for its thread to exit.
     for (auto& i : m_workers) delete i;
 }
+
+void VlThreadPool::runPersistent(const VlExecFnp* fnpsp, size_t nFnps, VlSelfP selfp,
+                                 bool evenCycle) {
+    assert(nFnps <= m_workers.size());
+    std::copy(fnpsp, fnpsp + nFnps, m_jobFnps.begin());
+    m_jobSelfp = selfp;
+    m_jobEvenCycle = evenCycle;
+    // The previous job passed its barrier, so nothing else touches the count now
+    m_barrierCount.store(nFnps + 1, std::memory_order_relaxed);
+    // Only the workers of the graph get the job, the others keep sleeping
+    for (size_t i = 0; i < nFnps; ++i) m_workers[i]->addJob();
+}
+
+void VlThreadPool::runJob(unsigned index) {
+    m_jobFnps[index](m_jobSelfp, m_jobEvenCycle);
+    barrier();
+}
+
+void VlThreadPool::barrier() {
+    // The phase only advances once everyone arrived, including us
+    const uint32_t phase = m_barrierPhase.load(std::memory_order_relaxed);
+    if (m_barrierCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // Last to arrive, release the others
+        m_barrierPhase.store(phase + 1, std::memory_order_release);
+        return;
+    }
+    unsigned ct = 0;
+    while (m_barrierPhase.load(std::memory_order_acquire) == phase) {
+        VL_CPU_RELAX();
+        if (VL_UNLIKELY(++ct > VL_LOCK_SPINS)) {
+            ct = 0;
+            std::this_thread::yield();
+        }
+    }
+}
+
+//=============================================================================
+// VlThreadPool NUMA placement
+
+// Parse a list such as "0-3,8,10-11", as used by the nodes and the sysfs cpulist files
+static bool numaParseList(const std::string& list, std::vector<int>& valuesr) {
+    const char* sp = list.c_str();
+    while (*sp && *sp != '\n') {
+        char* endp;
+        const long first = std::strtol(sp, &endp, 10);
+        if (endp == sp || first < 0) return false;
+        long last = first;
+        sp = endp;
+        if (*sp == '-') {
+            last = std::strtol(sp + 1, &endp, 10);
+            if (endp == sp + 1 || last < first) return false;
+            sp = endp;
+        }
+        for (long i = first; i <= last; ++i) valuesr.push_back(static_cast<int>(i));
+        if (*sp == ',') ++sp;
+    }
+    return true;
+}
+
+void VlThreadPool::numaSetup(const std::string& nodes) {
+#if defined(__linux)
+    std::vector<int> nodeNums;
+    if (!numaParseList(nodes, nodeNums) || nodeNums.empty()) {
+        const std::string msg = "Cannot parse NUMA node list: '" + nodes + "'";
+        VL_FATAL_MT(__FILE__, __LINE__, "", msg.c_str());
+    }
+    // Fill the nodes one after the other, so consecutive threads share a node
+    std::vector<int> cpus;
+    std::vector<int> cpuNodes;
+    for (const int node : nodeNums) {
+        const std::string filename
+            = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+        std::ifstream ifs{filename};
+        std::string line;
+        std::vector<int> nodeCpus;
+        if (!std::getline(ifs, line) || !numaParseList(line, nodeCpus)) {
+            const std::string msg = "Cannot read CPUs of NUMA node " + std::to_string(node)
+                                    + " from " + filename;
+            VL_FATAL_MT(__FILE__, __LINE__, "", msg.c_str());
+        }
+        for (const int cpu : nodeCpus) {
+            cpus.push_back(cpu);
+            cpuNodes.push_back(node);
+        }
+    }
+    if (cpus.empty()) VL_FATAL_MT(__FILE__, __LINE__, "", "NUMA nodes have no CPUs");
+    const size_t nThreads = m_jobFnps.size() + 1;  // Workers are not created yet
+    if (nThreads > cpus.size()) {
+        VL_PRINTF_MT("%%Warning: NUMA nodes '%s' have %zu CPUs but simulation thread count is "
+                     "%zu. Threads will share CPUs.\n",
+                     nodes.c_str(), cpus.size(), nThreads);
+    }
+    for (size_t i = 0; i < nThreads; ++i) {
+        m_numaCpus.push_back(cpus[i % cpus.size()]);
+        m_numaNodes.push_back(cpuNodes[i % cpus.size()]);
+    }
+#else
+    VL_PRINTF_MT("%%Warning: NUMA nodes '%s' ignored, NUMA placement requires Linux\n",
+                 nodes.c_str());
+#endif
+}
+
+void VlThreadPool::numaPin(unsigned index) const {
+    if (m_numaCpus.empty()) return;
+#if defined(__linux)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(m_numaCpus[index], &cpuSet);
+    if (sched_setaffinity(0, sizeof(cpuSet), &cpuSet) != 0) {
+        VL_PRINTF_MT("%%Warning: Cannot pin simulation thread %u to CPU %d: %s\n", index,
+                     m_numaCpus[index], std::strerror(errno));
+    }
+#endif
+}
+
+void VlThreadPool::numaOwn(unsigned index, const void* datap, size_t size)
+    VL_MT_SAFE_EXCLUDES(m_numaMutex) {
+    if (m_numaNodes.empty() || !size) return;
+    if (index == MAIN_THREAD) index = m_workers.size();
+    assert(index < m_numaNodes.size());
+#if defined(__linux)
+    static const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+    const VerilatedLockGuard lock{m_numaMutex};
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(datap);
+    const uintptr_t end = begin + size;
+    for (uintptr_t page = begin & ~(pageSize - 1); page < end; page += pageSize) {
+        std::vector<size_t>& owned = m_numaPages[page];
+        owned.resize(m_numaNodes.size());
+        owned[index] += std::min(end, page + pageSize) - std::max(begin, page);
+    }
+#endif
+}
+
+void VlThreadPool::numaPlace() VL_MT_SAFE_EXCLUDES(m_numaMutex) {
+#if defined(__linux)
+    const VerilatedLockGuard lock{m_numaMutex};
+    if (m_numaPages.empty()) return;
+    std::vector<void*> pages;
+    std::vector<int> nodes;
+    for (const auto& pair : m_numaPages) {
+        const std::vector<size_t>& owned = pair.second;
+        const size_t index = std::max_element(owned.begin(), owned.end()) - owned.begin();
+        pages.push_back(reinterpret_cast<void*>(pair.first));
+        nodes.push_back(m_numaNodes[index]);
+    }
+    m_numaPages.clear();
+    // As move_pages(2), without depending on libnuma
+    constexpr int MPOL_MF_MOVE_FLAG = 1 << 1;
+    std::vector<int> status(pages.size());
+    if (syscall(SYS_move_pages, 0, pages.size(), pages.data(), nodes.data(), status.data(),
+                MPOL_MF_MOVE_FLAG)
+        < 0) {
+        VL_PRINTF_MT("%%Warning: Cannot move model state to its NUMA nodes: %s\n",
+                     std::strerror(errno));
+    }
+#endif
+}
@@ -29,6 +29,7 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <map>
 #include <set>
 #include <thread>
 #include <vector>
@@ -124,6 +125,8 @@ public:
     }
 };
 
+class VlThreadPool;
+
 class VlWorkerThread final {
 private:
     // TYPES
@@ -138,60 +141,100 @@ private:
             , m_evenCycle{evenCycle} {}
     };
 
+    // Pending tasks, a bounded single-producer single-consumer ring. Only the thread
+    // evaluating the models of the context adds tasks, so the ring needs no lock. We
+    // expect it to hold 0, 1 or 2 tasks, tracing may add more; if it ever fills up,
+    // addTask waits for the worker to make room.
+    static constexpr size_t RING_SIZE = 64;  // Power of two
+
     // MEMBERS
+    ExecRec m_ring[RING_SIZE];
+    // Index of the next task to run, written by the worker only
+    VL_ALIGNAS_CACHE_LINE std::atomic<size_t> m_head{0};
+    // Generation of the last persistent job taken, see VlThreadPool::runPersistent
+    uint64_t m_generation = 0;
+    // Index past the last task added, written by the producer only
+    VL_ALIGNAS_CACHE_LINE std::atomic<size_t> m_tail{0};
+    // Last persistent job posted to this worker, written by the producer only
+    std::atomic<uint64_t> m_jobGeneration{0};
+    // Slow path, when the worker goes to sleep on an empty ring
+    VL_ALIGNAS_CACHE_LINE std::atomic<bool> m_waiting{false};
     mutable VerilatedMutex m_mutex;
     std::condition_variable_any m_cv;
-    // Only notify the condition_variable if the worker is waiting
-    bool m_waiting VL_GUARDED_BY(m_mutex) = false;
-
-    // Why a vector? We expect the pending list to be very short, typically
-    // 0 or 1 or 2, so popping from the front shouldn't be
-    // expensive. Revisit if we ever have longer queues...
-    std::vector<ExecRec> m_ready VL_GUARDED_BY(m_mutex);
-    // Store the size atomically, so we can spin wait
-    std::atomic<size_t> m_ready_size;
+    VerilatedContext* const m_contextp;  // For VerilatedContext::threadsSpin
+    VlThreadPool* const m_poolp;  // Owner
+    const unsigned m_index;  // Index in the pool
 
     std::thread m_cthread;  // Underlying C++ thread record
 
     VL_UNCOPYABLE(VlWorkerThread);
 
+    bool readyEmpty() const {
+        return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_relaxed);
+    }
+    bool jobPending() const {
+        return m_jobGeneration.load(std::memory_order_acquire) != m_generation;
+    }
+    bool idle() const { return readyEmpty() && !jobPending(); }
+    void sleepUntilReady() VL_MT_SAFE_EXCLUDES(m_mutex);
+    static void persistentTask(VlSelfP selfp, bool);
+
 public:
     // CONSTRUCTORS
-    explicit VlWorkerThread(VerilatedContext* contextp);
+    VlWorkerThread(VerilatedContext* contextp, VlThreadPool* poolp, unsigned index);
     ~VlWorkerThread();
 
     // METHODS
     template <bool SpinWait>
     void dequeWork(ExecRec* workp) VL_MT_SAFE_EXCLUDES(m_mutex) {
-        // Spin for a while, waiting for new data
-        if VL_CONSTEXPR_CXX17 (SpinWait) {
-            for (unsigned i = 0; i < VL_LOCK_SPINS; ++i) {
-                if (VL_LIKELY(m_ready_size.load(std::memory_order_relaxed))) break;
-                VL_CPU_RELAX();
+        if (VL_UNLIKELY(idle())) {
+            // Spin for a while, or for as long as the context asks or this worker runs
+            // persistent jobs, waiting for new data
+            if VL_CONSTEXPR_CXX17 (SpinWait) {
+                for (unsigned i = 0; idle(); ++i) {
+                    if (i >= VL_LOCK_SPINS) {
+                        if (!m_contextp->threadsSpin() && !m_generation) break;
+                        i = 0;
+                    }
+                    VL_CPU_RELAX();
+                }
             }
+            if (idle()) sleepUntilReady();
         }
-        VerilatedLockGuard lock{m_mutex};
-        while (m_ready.empty()) {
-            m_waiting = true;
-            m_cv.wait(lock);
+        if (!readyEmpty()) {
+            const size_t head = m_head.load(std::memory_order_relaxed);
+            *workp = m_ring[head % RING_SIZE];
+            m_head.store(head + 1, std::memory_order_release);
+            return;
         }
-        m_waiting = false;
-        // As noted above this is inefficient if our ready list is ever
-        // long (but it shouldn't be)
-        *workp = m_ready.front();
-        m_ready.erase(m_ready.begin());
-        m_ready_size.fetch_sub(1, std::memory_order_relaxed);
+        // The next job is only posted once this one passed the barrier
+        ++m_generation;
+        *workp = ExecRec{persistentTask, this, false};
     }
     void addTask(VlExecFnp fnp, VlSelfP selfp, bool evenCycle = false)
         VL_MT_SAFE_EXCLUDES(m_mutex) {
-        bool notify;
-        {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        // Wait for room, only if the worker is far behind
+        while (VL_UNLIKELY(tail - m_head.load(std::memory_order_acquire) >= RING_SIZE)) {
+            VL_CPU_RELAX();
+        }
+        m_ring[tail % RING_SIZE] = ExecRec{fnp, selfp, evenCycle};
+        m_tail.store(tail + 1, std::memory_order_seq_cst);
+        wakeIfWaiting();
+    }
+    // Post the next persistent job, see VlThreadPool::runPersistent
+    void addJob() VL_MT_SAFE_EXCLUDES(m_mutex) {
+        m_jobGeneration.fetch_add(1, std::memory_order_seq_cst);
+        wakeIfWaiting();
+    }
+    // Called after publishing a task or job. Pairs with the store of m_waiting in
+    // sleepUntilReady, so the worker either sees the work or is woken up.
+    void wakeIfWaiting() VL_MT_SAFE_EXCLUDES(m_mutex) {
+        if (VL_UNLIKELY(m_waiting.load(std::memory_order_seq_cst))) {
+            // Holding the lock, the worker is either waiting on m_cv or yet to check the ring
             const VerilatedLockGuard lock{m_mutex};
-            m_ready.emplace_back(fnp, selfp, evenCycle);
-            m_ready_size.fetch_add(1, std::memory_order_relaxed);
-            notify = m_waiting;
+            m_cv.notify_one();
         }
-        if (notify) m_cv.notify_one();
     }
 
     void shutdown();  // Finish current tasks, then terminate thread
@@ -202,9 +245,36 @@ public:
 };
 
 class VlThreadPool final : public VerilatedVirtualBase {
+    friend class VlWorkerThread;
+
     // MEMBERS
     std::vector<VlWorkerThread*> m_workers;  // our workers
 
+    // Persistent jobs, see runPersistent. The job is written before it is posted to the
+    // workers, and they only read it after they saw their new job generation.
+    std::vector<VlExecFnp> m_jobFnps;  // Function of every worker of the job
+    VlSelfP m_jobSelfp = nullptr;
+    bool m_jobEvenCycle = false;
+    // Barrier of the workers of the job and the main thread that ends every job,
+    // runPersistent sets the count to the number of them. Not every worker takes part
+    // in every job, so rather than a sense that flips back and forth, the waiters watch
+    // a phase that only ever advances.
+    VL_ALIGNAS_CACHE_LINE std::atomic<uint32_t> m_barrierCount{0};
+    std::atomic<uint32_t> m_barrierPhase{0};
+
+    // NUMA placement, see VerilatedContext::threadsNuma. Threads are numbered as the
+    // workers, the thread that created the pool and runs eval is numThreads().
+    std::vector<int> m_numaCpus;  // CPU of each thread, empty if not pinned
+    std::vector<int> m_numaNodes;  // NUMA node of each thread
+    VerilatedMutex m_numaMutex;
+    // Bytes of each memory page owned by each thread, see numaOwn
+    std::map<uintptr_t, std::vector<size_t>> m_numaPages VL_GUARDED_BY(m_numaMutex);
+
+    void barrier();
+    void runJob(unsigned index);
+    void numaSetup(const std::string& nodes);
+    void numaPin(unsigned index) const;
+
 public:
     // CONSTRUCTORS
     // Construct a thread pool with 'nThreads' dedicated threads. The thread
@@ -213,6 +283,9 @@ public:
     VlThreadPool(VerilatedContext* contextp, unsigned nThreads);
     ~VlThreadPool() override;
 
+    // Index of the thread running eval for numaOwn, which is numThreads() in the pool
+    static constexpr unsigned MAIN_THREAD = ~0U;
+
     // METHODS
     int numThreads() const { return m_workers.size(); }
     VlWorkerThread* workerp(int index) {
@@ -220,6 +293,19 @@ public:
         assert(static_cast<size_t>(index) < m_workers.size());
         return m_workers[index];
     }
+    // With --threads-persistent, start fnpsp[i] on worker i for every i < nFnps,
+    // without allocating or locking. These workers spin between jobs from then on, the
+    // other workers are left alone and may sleep.
+    void runPersistent(const VlExecFnp* fnpsp, size_t nFnps, VlSelfP selfp, bool evenCycle);
+    // Wait until the workers finished the job of runPersistent
+    void waitPersistent() { barrier(); }
+    // With --threads-numa, the Verilated model registers the variables written mostly by
+    // worker 'index', or by the thread running eval if MAIN_THREAD, then moves their pages
+    // to the NUMA node of that thread. Each page
+    // goes to the thread owning most of its bytes. Nothing happens if the threads are not
+    // pinned to NUMA nodes.
+    void numaOwn(unsigned index, const void* datap, size_t size) VL_MT_SAFE_EXCLUDES(m_numaMutex);
+    void numaPlace() VL_MT_SAFE_EXCLUDES(m_numaMutex);
 
 private:
     VL_UNCOPYABLE(VlThreadPool);
@@ -268,6 +268,18 @@
 # define VL_CONSTEXPR_CXX17
 #endif
 
+// Start a member on its own cache line. Classes with such members are allocated with
+// plain new, which only honors the extended alignment with C++17's aligned new.
+// Without it, VL_CACHE_LINE_PAD instead declares a line of padding before the member,
+// so it still shares no cache line with the members before it.
+#ifdef __cpp_aligned_new
+# define VL_ALIGNAS_CACHE_LINE alignas(VL_CACHE_LINE_BYTES)
+# define VL_CACHE_LINE_PAD(name)
+#else
+# define VL_ALIGNAS_CACHE_LINE
+# define VL_CACHE_LINE_PAD(name) char name[VL_CACHE_LINE_BYTES];
+#endif
+
 
 //=========================================================================
 // Optimization
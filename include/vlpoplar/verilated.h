@@ -34,7 +34,12 @@
 
 #include "vlpoplar/verilatedos.h"
 #include "verilated_config.h"
+#ifdef VL_BSP_CPU
+#include <cstdint>
+#include <cstdio>
+#else
 #include <print.h> // poplar print
+#endif
 #include <cmath>
 
 //=========================================================================
@@ -0,0 +1,144 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// Code available from: https://verilator.org
+//
+// Copyright 2001-2023 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//=============================================================================
+///
+/// \file  verilated_bsp_checkpoint.cpp
+/// \brief Checkpoint files of BSP simulations
+///
+//=============================================================================
+
+#include "verilated_bsp_checkpoint.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr char CHECKPOINT_MAGIC[8] = "VLBSPCK";
+constexpr uint32_t CHECKPOINT_VERSION = 1;
+
+struct Header {
+    char m_magic[8];
+    uint32_t m_version;
+    uint32_t m_tensors;
+    uint64_t m_words;
+};
+
+// Bytes before the data, which starts 8-byte aligned
+uint64_t dataStart(uint64_t tensors) {
+    return (sizeof(Header) + tensors * 2 * sizeof(uint32_t) + 7) & ~7ULL;
+}
+}  // namespace
+
+void VlBspCheckpoint::add(int32_t id, uint32_t words) {
+    m_entries.push_back(Entry{id, words});
+    m_offsets.clear();
+}
+
+void VlBspCheckpoint::layout() const {
+    if (m_offsets.size() == m_entries.size()) return;
+    std::stable_sort(m_entries.begin(), m_entries.end(),
+                     [](const Entry& a, const Entry& b) { return a.m_id < b.m_id; });
+    m_offsets.clear();
+    m_words = 0;
+    for (const Entry& entry : m_entries) {
+        m_offsets.push_back(m_words);
+        m_words += entry.m_words;
+    }
+}
+
+void VlBspCheckpoint::save(const std::string& path, const std::vector<const uint32_t*>& datap) {
+    std::ofstream os{path, std::ios::out | std::ios::binary};
+    if (!os) {
+        std::cerr << "Can not create checkpoint " << path << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    layout();
+    Header header;
+    std::memcpy(header.m_magic, CHECKPOINT_MAGIC, sizeof(header.m_magic));
+    header.m_version = CHECKPOINT_VERSION;
+    header.m_tensors = m_entries.size();
+    header.m_words = m_words;
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const Entry& entry : m_entries) {
+        os.write(reinterpret_cast<const char*>(&entry.m_id), sizeof(entry.m_id));
+        os.write(reinterpret_cast<const char*>(&entry.m_words), sizeof(entry.m_words));
+    }
+    const uint64_t padding = dataStart(m_entries.size()) - static_cast<uint64_t>(os.tellp());
+    os.write("\0\0\0\0\0\0\0", padding);
+    for (size_t ix = 0; ix < m_entries.size(); ++ix) {
+        os.write(reinterpret_cast<const char*>(datap[ix]),
+                 m_entries[ix].m_words * sizeof(uint32_t));
+    }
+    if (!os) {
+        std::cerr << "Failed to write checkpoint " << path << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+const uint32_t* VlBspCheckpoint::restore(const std::string& path) {
+    layout();
+    unmap();
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || ::fstat(fd, &st) != 0) {
+        std::cerr << "Can not open checkpoint " << path << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    m_mapBytes = st.st_size;
+    m_mapp = m_mapBytes ? ::mmap(nullptr, m_mapBytes, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (m_mapp == MAP_FAILED) {
+        m_mapp = nullptr;
+        std::cerr << "Can not map checkpoint " << path << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    const auto fail = [&path](const std::string& why) {
+        std::cerr << "Invalid checkpoint " << path << ": " << why << std::endl;
+        std::exit(EXIT_FAILURE);
+    };
+    const char* const bytesp = static_cast<const char*>(m_mapp);
+    Header header;
+    if (m_mapBytes < sizeof(header)) fail("truncated header");
+    std::memcpy(&header, bytesp, sizeof(header));
+    if (std::memcmp(header.m_magic, CHECKPOINT_MAGIC, sizeof(header.m_magic)) != 0) {
+        fail("not a checkpoint");
+    }
+    if (header.m_version != CHECKPOINT_VERSION) fail("unsupported version");
+    if (header.m_tensors != m_entries.size() || header.m_words != m_words) {
+        fail("saved from a different program");
+    }
+    if (m_mapBytes < dataStart(header.m_tensors) + m_words * sizeof(uint32_t)) {
+        fail("truncated data");
+    }
+    const uint32_t* tablep = reinterpret_cast<const uint32_t*>(bytesp + sizeof(header));
+    for (const Entry& entry : m_entries) {
+        if (static_cast<int32_t>(tablep[0]) != entry.m_id || tablep[1] != entry.m_words) {
+            fail("saved from a different program");
+        }
+        tablep += 2;
+    }
+    return reinterpret_cast<const uint32_t*>(bytesp + dataStart(header.m_tensors));
+}
+
+void VlBspCheckpoint::unmap() {
+    if (m_mapp) ::munmap(m_mapp, m_mapBytes);
+    m_mapp = nullptr;
+    m_mapBytes = 0;
+}
@@ -0,0 +1,81 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// Code available from: https://verilator.org
+//
+// Copyright 2001-2023 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//=============================================================================
+///
+/// \file  verilated_bsp_checkpoint.h
+/// \brief Checkpoint files of BSP simulations
+///
+//=============================================================================
+
+#ifndef VERILATOR_VERILATED_BSP_CHECKPOINT_H_
+#define VERILATOR_VERILATED_BSP_CHECKPOINT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+///
+/// VlBspCheckpoint describes the state of a BSP program, every tensor that the
+/// context allocated in the order of their ids, and saves or restores it:
+///
+///     header  "VLBSPCK", version, number of tensors, number of words
+///     table   number of tensors x { tensor id, words }
+///     data    the words of all tensors one after another, 8-byte aligned
+///
+/// Both the IPU and the --bsp-cpu contexts pad tensors to two words and
+/// allocate them for the same ids, so they share checkpoints of a program.
+/// Restoring maps the file, the data can be streamed to the device as is.
+///
+class VlBspCheckpoint final {
+    struct Entry {
+        int32_t m_id;
+        uint32_t m_words;
+    };
+    mutable std::vector<Entry> m_entries;  // Sorted by id once laid out
+    mutable std::vector<uint64_t> m_offsets;  // Word offset of every entry in the data
+    mutable uint64_t m_words = 0;
+    void* m_mapp = nullptr;  // Mapped file of restore()
+    size_t m_mapBytes = 0;
+
+    void layout() const;
+    void unmap();
+
+public:
+    VlBspCheckpoint() = default;
+    ~VlBspCheckpoint() { unmap(); }
+    VlBspCheckpoint(const VlBspCheckpoint&) = delete;
+    VlBspCheckpoint& operator=(const VlBspCheckpoint&) = delete;
+
+    // Describe a tensor, in any order before save() or restore()
+    void add(int32_t id, uint32_t words);
+    size_t size() const { return m_entries.size(); }
+    uint64_t words() const {
+        layout();
+        return m_words;
+    }
+    int32_t id(size_t ix) const {
+        layout();
+        return m_entries[ix].m_id;
+    }
+    uint64_t offset(size_t ix) const {
+        layout();
+        return m_offsets[ix];
+    }
+    // Write the tensors to path, datap holds one pointer per tensor in id order
+    void save(const std::string& path, const std::vector<const uint32_t*>& datap);
+    // Map path and return all words(), checking that it was saved from the
+    // same layout. The words are valid until the next restore() or destruction.
+    const uint32_t* restore(const std::string& path);
+};
+
+#endif  // Guard
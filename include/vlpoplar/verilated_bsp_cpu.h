@@ -0,0 +1,149 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+//
+// Code available from: https://verilator.org
+//
+// Copyright 2003-2023 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+///
+/// \file
+/// \brief Host CPU stand-ins for the poplar vertex API used by --bsp-cpu
+///
+/// With --bsp-cpu the vertex classes emitted for the IPU are compiled by the
+/// host compiler instead of popc. This header provides the small subset of
+/// poplar/Vertex.hpp that the emitted code relies on, and a registry that
+/// lets the runtime (verilated_bsp_cpu_context.cpp) create vertices and bind
+/// their fields by name, as poplar::Graph::addVertex and connect would do.
+///
+//*************************************************************************
+
+#ifndef VERILATOR_VERILATED_BSP_CPU_H_
+#define VERILATOR_VERILATED_BSP_CPU_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//===================================================================
+// Field storage, a view over words owned by the runtime
+
+class VlBspCpuVecBase VL_NOT_FINAL {
+protected:
+    uint32_t* m_datap = nullptr;  // Tensor words, owned by the context
+    std::size_t m_size = 0;  // Number of words
+
+public:
+    void bind(uint32_t* datap, std::size_t size) {
+        m_datap = datap;
+        m_size = size;
+    }
+    std::size_t size() const { return m_size; }
+};
+
+namespace poplar {
+
+enum class VectorLayout { ONE_PTR, SPAN, COMPACT_PTR };
+
+template <typename T_Elem, VectorLayout T_Layout = VectorLayout::SPAN,
+          std::size_t T_Align = alignof(T_Elem)>
+class Vector : public VlBspCpuVecBase {
+public:
+    T_Elem* data() { return reinterpret_cast<T_Elem*>(m_datap); }
+    const T_Elem* data() const { return reinterpret_cast<const T_Elem*>(m_datap); }
+    T_Elem& operator[](std::size_t i) { return data()[i]; }
+    const T_Elem& operator[](std::size_t i) const { return data()[i]; }
+};
+
+template <typename T_Vec>
+class InOut final : public T_Vec {};
+
+template <typename T_Vec>
+class Input final : public T_Vec {
+public:
+    // Inputs are read only, like their poplar counterparts
+    auto data() const { return T_Vec::data(); }
+    const auto& operator[](std::size_t i) const { return T_Vec::operator[](i); }
+};
+
+class Vertex VL_NOT_FINAL {};
+class SupervisorVertex VL_NOT_FINAL {};
+
+}  // namespace poplar
+
+//===================================================================
+// Host stand-in for the tile PRNG, one xorshift state per worker thread. It lives here
+// rather than in verilated_funcs.h, so the runtime can save and restore it with the
+// rest of the state of a batch, see VlPoplarContext::saveState.
+
+class VlBspCpuRandom final {
+public:
+    static uint64_t& state() {
+        static thread_local uint64_t s_state = 0x9e3779b97f4a7c15ULL;
+        return s_state;
+    }
+};
+
+//===================================================================
+// Number of nbaTop evaluations skipped by activity gating on this thread (see
+// V3BspActivity), reported by the runtime log of the context
+
+class VlBspCpuActivity final {
+public:
+    static uint64_t& skips() {
+        static thread_local uint64_t s_skips = 0;
+        return s_skips;
+    }
+};
+
+//===================================================================
+// Vertex registry, filled by static registrars in the codelet files
+
+struct VlBspCpuVertexInfo final {
+    using Binder = std::function<VlBspCpuVecBase&(void*)>;
+    std::function<void*()> m_create;  // Allocate a new instance
+    std::function<void(void*)> m_destroy;  // Release an instance
+    std::function<void(void*)> m_compute;  // Run one superstep of the instance
+    std::unordered_map<std::string, Binder> m_fields;  // Field name -> member accessor
+};
+
+class VlBspCpuVertexRegistry final {
+public:
+    static std::unordered_map<std::string, VlBspCpuVertexInfo>& s() {
+        static std::unordered_map<std::string, VlBspCpuVertexInfo> s_registry;
+        return s_registry;
+    }
+};
+
+template <typename T_Vertex>
+class VlBspCpuVertexRegistrar final {
+public:
+    template <typename T_Member>
+    static std::pair<const std::string, VlBspCpuVertexInfo::Binder> field(const char* namep,
+                                                                           T_Member T_Vertex::*mp) {
+        return {namep, [mp](void* vtxp) -> VlBspCpuVecBase& {
+                    return static_cast<T_Vertex*>(vtxp)->*mp;
+                }};
+    }
+    VlBspCpuVertexRegistrar(
+        const char* namep,
+        std::initializer_list<std::pair<const std::string, VlBspCpuVertexInfo::Binder>> fields) {
+        VlBspCpuVertexInfo info;
+        info.m_create = []() -> void* { return new T_Vertex{}; };
+        info.m_destroy = [](void* vtxp) { delete static_cast<T_Vertex*>(vtxp); };
+        info.m_compute = [](void* vtxp) { static_cast<T_Vertex*>(vtxp)->compute(); };
+        info.m_fields = fields;
+        VlBspCpuVertexRegistry::s().emplace(namep, std::move(info));
+    }
+};
+
+#endif  // Guard
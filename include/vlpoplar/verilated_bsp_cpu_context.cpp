@@ -0,0 +1,590 @@
+#include VPROGRAM_HEADER /*defined by the Makefile*/
+
+#include "verilated_bsp_cpu_context.h"
+#ifdef VL_BSP_TRACE
+#include "verilated_bsp_trace.h"
+#endif
+
+#include <verilated.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+VlPoplarContext::~VlPoplarContext() {
+    if (!m_threads.empty()) {
+        m_shutdown = true;
+        start(E_RESET);
+        for (auto& t : m_threads) t.join();
+    }
+    for (auto& vtx : m_vertices) {
+        if (vtx.m_objp) vtx.m_infop->m_destroy(vtx.m_objp);
+    }
+}
+
+void VlPoplarContext::init(int argc, char* argv[]) {
+    // for +args
+    Verilated::commandArgs(argc, argv);
+    vprog = std::make_unique<VPROGRAM>(*this);
+    vprog->constructStatePairs();
+    vprog->constructAll();
+    vprog->initialize();
+    vprog->exchange();
+    vprog->dpiExchange();
+    vprog->dpiBroadcast();
+}
+
+void VlPoplarContext::build() {
+    if (interruptCond < 0) {
+        std::cerr << "Program has no host interface/stop condition!" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    for (const Connection& conn : m_connections) {
+        VertexInstance& vtx = m_vertices[conn.m_vertex];
+        const auto it = vtx.m_infop->m_fields.find(conn.m_field);
+        if (it == vtx.m_infop->m_fields.end()) {
+            std::cerr << "Can not find vertex field " << conn.m_field << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        TensorStorage& ts = m_storage[conn.m_tensor];
+        it->second(vtx.m_objp).bind(ts.data(), ts.m_size);
+    }
+
+    // Each used tile becomes a unit of work owned by one thread. Tiles are
+    // dealt to the threads in order, which keeps the tiles that the
+    // placement put next to each other on the same thread.
+    std::map<uint32_t, uint32_t> tileToWorker;
+    for (const VertexInstance& vtx : m_vertices) tileToWorker.emplace(vtx.m_tileId, 0);
+    const uint32_t hwThreads = std::max(1U, std::thread::hardware_concurrency());
+    const uint32_t numWorkers
+        = std::max<uint32_t>(1, std::min<uint32_t>(tileToWorker.size(), hwThreads));
+    {
+        uint32_t ix = 0;
+        for (auto& pair : tileToWorker) pair.second = (ix++ * numWorkers) / tileToWorker.size();
+    }
+    const auto workerOf = [&tileToWorker](uint32_t tileId) {
+        const auto it = tileToWorker.find(tileId);
+        return it == tileToWorker.end() ? 0 : it->second;
+    };
+    m_plans = std::vector<WorkerPlan>(numWorkers);
+    for (VertexInstance& vtx : m_vertices) {
+        WorkerPlan& plan = m_plans[workerOf(vtx.m_tileId)];
+        plan.m_vertices[vtx.m_computeSet].push_back(&vtx);
+        plan.m_tileNanos.emplace(vtx.m_tileId, 0);
+        // the condition of the previous cycle is evaluated with the workload, nothing
+        // else writes its inputs during the workload so they can share the step
+        if (VL_FUSED_COND && vtx.m_computeSet == CS_COND) {
+            plan.m_vertices[CS_WORKLOAD].push_back(&vtx);
+        }
+    }
+    for (uint32_t seq = 0; seq < _S_NUM; ++seq) {
+        for (CopyOp cp : m_copies[seq]) {
+            TensorStorage& to = m_storage[cp.m_to];
+            cp.m_fromp = m_storage[cp.m_from].data();
+            cp.m_top = to.data();
+            // the destination owner does the copy, so that the data is local for
+            // the next compute step
+            m_plans[workerOf(to.m_tileId)].m_copies[seq].push_back(cp);
+        }
+    }
+    if (VL_FUSED_COND && VL_CYCLE_BATCH > 1) {
+        // every cycle overwrites the exchange and dpiExchange destinations before
+        // reading them, everything else is state that a replay has to start from.
+        // A replay writes the records of a trace buffer again, only its head counts.
+        std::vector<bool> overwritten(m_storage.size(), false);
+        for (const CopyOp& cp : m_copies[S_EXCHANGE]) overwritten[cp.m_to] = true;
+        for (const CopyOp& cp : m_copies[S_RELAY]) overwritten[cp.m_to] = true;
+        for (const CopyOp& cp : m_copies[S_DPI]) overwritten[cp.m_to] = true;
+        for (const int ix : traceBuffers) m_storage[ix].m_stateWords = 1;
+        for (size_t ix = 0; ix < m_storage.size(); ++ix) {
+            if (overwritten[ix]) continue;
+            TensorStorage& ts = m_storage[ix];
+            if (!ts.m_stateWords) ts.m_stateWords = ts.m_size;
+            ts.m_snapshot = std::make_unique<uint64_t[]>((ts.m_stateWords + 1) / 2);
+            m_plans[workerOf(ts.m_tileId)].m_state.push_back(static_cast<int>(ix));
+        }
+    }
+    m_barrierp = std::make_unique<VlBspCpuBarrier>(numWorkers);
+    startWorkers();
+}
+
+void VlPoplarContext::startWorkers() {
+    const auto pin = [](std::thread::native_handle_type handle, uint32_t workerId) {
+#ifdef __linux__
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(workerId % std::max(1U, std::thread::hardware_concurrency()), &cpuset);
+        pthread_setaffinity_np(handle, sizeof(cpu_set_t), &cpuset);
+#endif
+    };
+    // worker 0 is the calling thread, which belongs to the user, only pin it on request
+    if (Verilated::commandArgsPlusMatch("bsp+pin")[0]) pin(pthread_self(), 0);
+    for (uint32_t wid = 1; wid < m_plans.size(); ++wid) {
+        m_threads.emplace_back([this, wid]() { workerLoop(wid); });
+        pin(m_threads.back().native_handle(), wid);
+    }
+}
+
+void VlPoplarContext::workerLoop(uint32_t workerId) {
+    uint64_t seen = 0;
+    while (true) {
+        uint64_t word;
+        while ((word = m_start.load(std::memory_order_acquire)) == seen) VL_CPU_RELAX();
+        seen = word;
+        if (m_shutdown) return;
+        execute(workerId, static_cast<EProgramId>(word & 0xff));
+    }
+}
+
+void VlPoplarContext::start(EProgramId prog) {
+    // the program travels with the sequence number, so a worker never reads the
+    // program of a later start than the one it woke up for. A program that ends
+    // without a barrier (E_INIT without init vertices) may be overtaken by the next
+    // one on a slow worker, which is fine as such a program has no work for it.
+    const uint64_t sequence = (m_start.load(std::memory_order_relaxed) >> 8) + 1;
+    m_start.store((sequence << 8) | prog, std::memory_order_release);
+}
+
+void VlPoplarContext::run(EProgramId prog) {
+    start(prog);
+    execute(0, prog);
+}
+
+void VlPoplarContext::sync(WorkerPlan& plan) {
+    // published by the barrier, so the host may sum the counts once a program is done
+    plan.m_activitySkips = VlBspCpuActivity::skips();
+    m_barrierp->wait(plan.m_sense, [this]() {
+        // only the last thread to arrive samples the condition, everyone else
+        // reads the snapshot once released
+        m_interrupt = m_storage[interruptCond].data()[0] != 0;
+        if (traceRequest >= 0) m_traceFull = m_storage[traceRequest].data()[0] != 0;
+    });
+}
+
+void VlPoplarContext::computeStep(WorkerPlan& plan, EComputeSet cs) {
+    if (VL_UNLIKELY(m_tileProfile) && cs == CS_WORKLOAD) {
+        profiledWorkload(plan);
+    } else {
+        for (VertexInstance* vtxp : plan.m_vertices[cs]) vtxp->m_infop->m_compute(vtxp->m_objp);
+    }
+    sync(plan);
+}
+
+void VlPoplarContext::profiledWorkload(WorkerPlan& plan) {
+    for (VertexInstance* vtxp : plan.m_vertices[CS_WORKLOAD]) {
+        const auto t0 = std::chrono::steady_clock::now();
+        vtxp->m_infop->m_compute(vtxp->m_objp);
+        const auto t1 = std::chrono::steady_clock::now();
+        plan.m_tileNanos[vtxp->m_tileId]
+            += std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    }
+    ++plan.m_workloads;
+}
+
+void VlPoplarContext::writeTileProfile() const {
+    // Same format as the tile profile of the IPU context (VL_INSTRUMENT), fed back
+    // with --bsp-profile-use. The unit is nanoseconds rather than cycles, only the
+    // relative cost of the tiles matters.
+    std::ofstream tileProfile{OBJ_DIR "/" ROOT_NAME "_tileProfile.txt", std::ios::out};
+    tileProfile << "# tile cycles" << std::endl;
+    for (const WorkerPlan& plan : m_plans) {
+        if (!plan.m_workloads) continue;
+        for (const auto& pair : plan.m_tileNanos) {
+            tileProfile << pair.first << " "
+                        << static_cast<double>(pair.second) / plan.m_workloads << std::endl;
+        }
+    }
+}
+
+void VlPoplarContext::copies(WorkerPlan& plan, ESequence seq) {
+    for (const CopyOp& cp : plan.m_copies[seq]) {
+        std::memcpy(cp.m_top, cp.m_fromp, cp.m_words * sizeof(uint32_t));
+    }
+}
+
+void VlPoplarContext::copyStep(WorkerPlan& plan, ESequence seq) {
+    copies(plan, seq);
+    sync(plan);
+}
+
+void VlPoplarContext::exchangeStep(WorkerPlan& plan) {
+    // the relays are filled before the broadcast targets read them, see addRelay
+    if (!m_copies[S_RELAY].empty()) copyStep(plan, S_RELAY);
+    copyStep(plan, S_EXCHANGE);
+}
+
+void VlPoplarContext::fusedCycle(WorkerPlan& plan, bool exchange) {
+    // the exchange and dpi copies write disjoint tensors, so they share a step
+    if (exchange && !m_copies[S_RELAY].empty()) copyStep(plan, S_RELAY);
+    if (exchange) copies(plan, S_EXCHANGE);
+    copyStep(plan, S_DPI);
+    computeStep(plan, CS_WORKLOAD);
+}
+
+void VlPoplarContext::saveState(WorkerPlan& plan, bool restore) {
+    // A replay draws the same $random values, the PRNG state is per worker thread and
+    // this runs on the thread of the plan
+    if (restore) {
+        VlBspCpuRandom::state() = plan.m_randState;
+    } else {
+        plan.m_randState = VlBspCpuRandom::state();
+    }
+    for (const int ix : plan.m_state) {
+        TensorStorage& ts = m_storage[ix];
+        uint32_t* const snapshotp = reinterpret_cast<uint32_t*>(ts.m_snapshot.get());
+        if (restore) {
+            std::memcpy(ts.data(), snapshotp, ts.m_stateWords * sizeof(uint32_t));
+        } else {
+            std::memcpy(snapshotp, ts.data(), ts.m_stateWords * sizeof(uint32_t));
+        }
+    }
+}
+
+void VlPoplarContext::traceCheck(WorkerPlan& plan) {
+    // a cycle that raised hasDpi may still be rolled back, see VL_CYCLE_BATCH
+    if (m_interrupt || !m_traceFull) return;
+    if (&plan == &m_plans[0]) traceDrain();
+    sync(plan);
+}
+
+void VlPoplarContext::traceDrain() {
+#ifdef VL_BSP_TRACE
+    if (m_traceWriterp) {
+        std::vector<const uint32_t*> buffersp;
+        for (const int ix : traceBuffers) buffersp.push_back(m_storage[ix].data());
+        m_traceWriterp->drain(buffersp);
+    }
+#endif
+    for (const int ix : traceBuffers) m_storage[ix].data()[0] = 0;
+}
+
+void VlPoplarContext::execute(uint32_t workerId, EProgramId prog) {
+    WorkerPlan& plan = m_plans[workerId];
+    switch (prog) {
+    case E_RESET:
+        if (workerId == 0) {
+            m_storage[interruptCond].data()[0] = 0;
+            for (int hreq : hostRequest) m_storage[hreq].data()[0] = 0;
+        }
+        sync(plan);
+        break;
+    case E_INIT:
+        // hasDpi is sticky with VL_CYCLE_BATCH, see V3BspDpi
+        if (VL_CYCLE_BATCH > 1 && workerId == 0) m_storage[interruptCond].data()[0] = 0;
+        if (hasInit) {
+            computeStep(plan, CS_INIT);
+            copyStep(plan, S_DPI);
+            computeStep(plan, CS_COND);
+            copyStep(plan, S_DPI_BROADCAST);
+        }
+        break;
+    case E_INITCOPY:
+        copyStep(plan, S_INIT);
+        if (VL_FUSED_COND) {
+            copyStep(plan, S_DPI);
+            computeStep(plan, CS_WORKLOAD);
+        }
+        break;
+    case E_NBA:
+        if (VL_FUSED_COND && VL_CYCLE_BATCH > 1) {
+            // check the sticky hasDpi once per batch, then roll the batch that raised
+            // it back and replay it checking every cycle, see buildReEntrant in
+            // verilated_poplar_context.cpp
+            if (workerId == 0) m_storage[interruptCond].data()[0] = 0;
+            sync(plan);  // before the owner of hasDpi saves it
+            do {
+                saveState(plan, false);
+                // within a batch, only the first cycle of every VL_LOOKAHEAD exchanges,
+                // see V3BspLookahead
+                for (int n = 0; n < VL_CYCLE_BATCH; ++n) fusedCycle(plan, n % VL_LOOKAHEAD == 0);
+                traceCheck(plan);
+            } while (!m_interrupt);
+            saveState(plan, true);  // hasDpi was clear when the state was saved
+            if (workerId == 0) ++m_batchReplays;
+            sync(plan);
+            do {
+                fusedCycle(plan);
+                traceCheck(plan);
+            } while (!m_interrupt);
+            break;
+        } else if (VL_FUSED_COND) {
+            do {
+                fusedCycle(plan);
+                traceCheck(plan);
+            } while (!m_interrupt);
+            break;
+        }
+        computeStep(plan, CS_COND);
+        copyStep(plan, S_DPI_BROADCAST);
+        if (m_interrupt) {
+            computeStep(plan, CS_WORKLOAD);
+            copyStep(plan, S_DPI);
+            computeStep(plan, CS_COND);
+            if (!m_interrupt) exchangeStep(plan);
+        }
+        if (!m_interrupt) {
+            // simLoop, stays on the workers until a host request is raised
+            copyStep(plan, S_DPI_BROADCAST);
+            computeStep(plan, CS_WORKLOAD);
+            while (true) {
+                copyStep(plan, S_DPI);
+                computeStep(plan, CS_COND);
+                if (m_interrupt) break;
+                traceCheck(plan);
+                exchangeStep(plan);
+                computeStep(plan, CS_WORKLOAD);
+            }
+        }
+        break;
+    default: break;
+    }
+}
+
+void VlPoplarContext::runReEntrant() {
+    std::ofstream profile(OBJ_DIR "/" ROOT_NAME "_runtime.log", std::ios::out);
+    // published to the workers with the first program
+    m_tileProfile = Verilated::commandArgsPlusMatch("bsp+profile")[0] != '\0';
+    const auto simStartTime = std::chrono::high_resolution_clock::now();
+    auto measure = [&profile](auto&& lazyValue, const std::string& n) {
+        const auto t0 = std::chrono::high_resolution_clock::now();
+        lazyValue();
+        const auto t1 = std::chrono::high_resolution_clock::now();
+        profile << n << ": " << std::fixed << std::setw(15) << std::setprecision(6)
+                << std::chrono::duration<double>(t1 - t0).count() << "s" << std::endl;
+    };
+    measure(
+        [this]() {
+            vprog->plusArgs();
+            vprog->plusArgsCopy();
+            vprog->readMem();
+            vprog->readMemCopy();
+            run(E_RESET);
+        },
+        "load");
+    profile << "workers: " << m_plans.size() << std::endl;
+    int invIndex = 0;
+    uint32_t interrupt = 0;
+    const std::string restorePath = Verilated::commandArgsPlusMatch("checkpoint+restore+");
+    if (!restorePath.empty()) {
+        // the checkpoint already holds the plusargs, memories and the initial state
+        measure([this, &restorePath]() { restoreCheckpoint(restorePath.substr(20)); },
+                "restore");
+    } else {
+        do {
+            profile << "init " << invIndex << std::endl;
+            measure(
+                [this]() {
+                    run(E_INIT);
+                    vprog->hostHandle();
+                },
+                "\twall");
+            interrupt = getHostData<uint32_t>("interrupt");
+        } while (interrupt && !Verilated::gotFinish());
+        run(E_INITCOPY);
+    }
+#ifdef VL_BSP_TRACE
+    if (!traceBuffers.empty()) {
+        const std::string fstPath = Verilated::commandArgsPlusMatch("trace+file+")[0]
+                                        ? Verilated::commandArgsPlusMatch("trace+file+") + 12
+                                        : OBJ_DIR "/" ROOT_NAME ".fst";
+        m_traceWriterp = std::make_unique<VlBspTraceWriter>(OBJ_DIR "/" ROOT_NAME "_trace.txt",
+                                                            fstPath);
+    }
+#endif
+
+    const auto simLoopStart = std::chrono::high_resolution_clock::now();
+    while (!Verilated::gotFinish()) {
+        profile << "run " << invIndex++ << std::endl;
+        measure(
+            [this]() {
+                run(E_NBA);
+                traceDrain();
+            },
+            "\twall");
+        vprog->hostHandle();
+    }
+#ifdef VL_BSP_TRACE
+    if (m_traceWriterp) m_traceWriterp->close();
+#endif
+    const std::string savePath = Verilated::commandArgsPlusMatch("checkpoint+save+");
+    if (!savePath.empty()) {
+        measure([this, &savePath]() { saveCheckpoint(savePath.substr(17)); }, "save");
+    }
+    const auto simEnd = std::chrono::high_resolution_clock::now();
+    uint64_t activitySkips = 0;
+    for (const WorkerPlan& plan : m_plans) activitySkips += plan.m_activitySkips;
+    profile << "activity skips: " << activitySkips << std::endl;
+    profile << "batch replays: " << m_batchReplays << std::endl;
+    profile << "sim: " << std::chrono::duration<double>(simEnd - simLoopStart).count() << "s"
+            << std::endl;
+    profile << "all: " << std::chrono::duration<double>(simEnd - simStartTime).count() << "s"
+            << std::endl;
+    profile.close();
+    if (m_tileProfile) writeTileProfile();
+}
+
+void VlPoplarContext::saveCheckpoint(const std::string& path) {
+    // the workers wait for the next program, the host owns all storage
+    std::vector<const uint32_t*> datap;
+    for (size_t ix = 0; ix < checkpoint.size(); ++ix) {
+        datap.push_back(m_storage[storageIndex(checkpoint.id(ix))].data());
+    }
+    checkpoint.save(path, datap);
+}
+
+void VlPoplarContext::restoreCheckpoint(const std::string& path) {
+    const uint32_t* const datap = checkpoint.restore(path);
+    for (size_t ix = 0; ix < checkpoint.size(); ++ix) {
+        TensorStorage& ts = m_storage[storageIndex(checkpoint.id(ix))];
+        std::memcpy(ts.data(), datap + checkpoint.offset(ix),
+                    std::max(ts.m_size, 2u) * sizeof(uint32_t));
+    }
+}
+
+void VlPoplarContext::addNextCurrentPair(const TensorId& next, const TensorId& current,
+                                         uint32_t size) {
+    if (tensors.count(next) == 0) {
+        const int nextIx = addTensor(size, next);
+        const int currentIx = addTensor(size, current);
+        nextToCurrent.emplace(next, current);
+        m_copies[S_EXCHANGE].push_back(CopyOp{nextIx, currentIx, nullptr, nullptr, size});
+    }
+    if (tensors.count(current) == 0) {
+        // alias the current value of an already existing pair
+        tensors.emplace(current, storageIndex(nextToCurrent[next]));
+    }
+}
+
+void VlPoplarContext::addRelay(const TensorId& source, const TensorId& relay, uint32_t size,
+                               uint32_t tileId) {
+    // as on the IPU, the relay receives the source once and the targets on its IPU read
+    // the relay, which keeps the traffic between the workers of distant tiles down
+    if (tensors.count(source) == 0) addTensor(size, source);
+    const int relayIx = addTensor(size, relay);
+    m_storage[relayIx].m_tileId = tileId;
+    m_copies[S_RELAY].push_back(CopyOp{storageIndex(source), relayIx, nullptr, nullptr, size});
+}
+
+void VlPoplarContext::addBroadcastTarget(const TensorId& source, const TensorId& target,
+                                         uint32_t size) {
+    if (tensors.count(source) == 0) addTensor(size, source);
+    const int targetIx = tensors.count(target) ? storageIndex(target) : addTensor(size, target);
+    m_copies[S_EXCHANGE].push_back(
+        CopyOp{storageIndex(source), targetIx, nullptr, nullptr, size});
+}
+
+void VlPoplarContext::addCopy(const TensorId& from, const TensorId& to, uint32_t size,
+                              const std::string& kind) {
+    // exchange copies are already created through addNextCurrentPair
+    if (kind == "exchange") return;
+    const CopyOp cp{storageIndex(from), storageIndex(to), nullptr, nullptr, size};
+    if (kind == "initialize") {
+        m_copies[S_INIT].push_back(cp);
+    } else if (kind == "dpiExchange") {
+        m_copies[S_DPI].push_back(cp);
+    } else if (kind == "dpiBroadcast") {
+        m_copies[S_DPI_BROADCAST].push_back(cp);
+    } else {
+        std::cerr << "invalid copy operation \"" << kind << "\"\n";
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+int VlPoplarContext::addTensor(uint32_t size, const TensorId& name) {
+    TensorStorage ts;
+    // pad to 8 bytes like the IPU tensors, so that host handles may read two words
+    const uint32_t padded = std::max(size, 2u);
+    ts.m_size = size;
+    ts.m_words = std::make_unique<uint64_t[]>((padded + 1) / 2);  // zero-initialized
+    m_storage.emplace_back(std::move(ts));
+    const int ix = static_cast<int>(m_storage.size()) - 1;
+    tensors.emplace(name, ix);
+    checkpoint.add(name, padded);
+    return ix;
+}
+
+poplar::Tensor VlPoplarContext::getOrAddTensor(uint32_t size, const TensorId& name) {
+    const auto it = tensors.find(name);
+    if (it == tensors.end()) return poplar::Tensor{addTensor(size, name)};
+    return poplar::Tensor{it->second};
+}
+
+poplar::VertexRef VlPoplarContext::getOrAddVertex(const std::string& name,
+                                                  const std::string& where) {
+    const auto it = vertices.find(name);
+    if (it != vertices.end()) return poplar::VertexRef{it->second};
+    const auto infoIt = VlBspCpuVertexRegistry::s().find(name);
+    if (infoIt == VlBspCpuVertexRegistry::s().end()) {
+        std::cerr << "Can not find codelet \"" << name << "\"" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    VertexInstance vtx;
+    if (where == "compute") {
+        vtx.m_computeSet = CS_WORKLOAD;
+    } else if (where == "init") {
+        hasInit = true;
+        vtx.m_computeSet = CS_INIT;
+    } else if (where == "condeval") {
+        vtx.m_computeSet = CS_COND;
+    } else {
+        std::cerr << "invalid computeset \"" << where << "\"" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    vtx.m_infop = &infoIt->second;
+    vtx.m_objp = vtx.m_infop->m_create();
+    m_vertices.push_back(vtx);
+    const int ix = static_cast<int>(m_vertices.size()) - 1;
+    vertices.emplace(name, ix);
+    return poplar::VertexRef{ix};
+}
+
+void VlPoplarContext::setTileMapping(poplar::VertexRef& vtxRef, uint32_t tileId) {
+    m_vertices[vtxRef.index()].m_tileId = tileId;
+}
+void VlPoplarContext::setTileMapping(poplar::Tensor& tensor, uint32_t tileId) {
+    m_storage[tensor.index()].m_tileId = tileId;
+}
+void VlPoplarContext::connect(poplar::VertexRef& vtx, const std::string& field,
+                              poplar::Tensor& tensor) {
+    m_connections.push_back(Connection{vtx.index(), field, tensor.index()});
+}
+void VlPoplarContext::createHostRead(const std::string& handle, poplar::Tensor& tensor,
+                                     uint32_t numElems) {
+    hbuffers.emplace(handle, HostBuffer{tensor.index(),
+                                        std::vector<uint32_t>(std::max(numElems, 2u))});
+}
+void VlPoplarContext::createHostWrite(const std::string& handle, poplar::Tensor& tensor,
+                                      uint32_t numElems) {
+    hbuffers.emplace(handle, HostBuffer{tensor.index(),
+                                        std::vector<uint32_t>(std::max(numElems, 2u))});
+}
+
+void VlPoplarContext::isHostRequest(poplar::Tensor& tensor, bool isInterruptCond) {
+    if (interruptCond >= 0 && isInterruptCond) {
+        std::cerr << "Can not have multiple interrupt conditions" << std::endl;
+        std::exit(EXIT_FAILURE);
+    } else if (isInterruptCond) {
+        interruptCond = tensor.index();
+    }
+    hostRequest.push_back(tensor.index());
+}
+
+void VlPoplarContext::addTraceBuffer(const TensorId& name, uint32_t) {
+    traceBuffers.push_back(storageIndex(name));
+}
+void VlPoplarContext::isTraceRequest(poplar::Tensor& tensor) { traceRequest = tensor.index(); }
+
+int main(int argc, char* argv[]) {
+    VlPoplarContext ctx;
+    ctx.init(argc, argv);
+    ctx.build();
+    ctx.runReEntrant();
+    return EXIT_SUCCESS;
+}
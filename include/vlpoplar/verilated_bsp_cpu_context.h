@@ -0,0 +1,279 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// Code available from: https://verilator.org
+//
+// Copyright 2001-2023 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//=============================================================================
+///
+/// \file  verilated_bsp_cpu_context.h
+/// \brief Shared-memory host implementation of the poplar context (--bsp-cpu)
+///
+//=============================================================================
+
+#ifndef VERILATOR_BSPCPUCONTEXT_H_
+#define VERILATOR_BSPCPUCONTEXT_H_
+
+#include <verilated.h>
+
+#include <vlpoplar/verilated_bsp_checkpoint.h>
+#include <vlpoplar/verilated_bsp_cpu.h>
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifndef VL_FUSED_COND
+#define VL_FUSED_COND 0
+#endif
+#ifndef VL_CYCLE_BATCH
+#define VL_CYCLE_BATCH 1
+#endif
+#ifndef VL_LOOKAHEAD
+#define VL_LOOKAHEAD 1
+#endif
+
+#ifdef VPROGRAM
+class VPROGRAM;
+#else
+#error "VPROGRAM is not defined"
+#endif
+class VlBspTraceWriter;
+
+// Handles used by the generated host program, they only index into the context
+namespace poplar {
+class Tensor final {
+    int m_index = -1;
+
+public:
+    Tensor() = default;
+    explicit Tensor(int index)
+        : m_index{index} {}
+    int index() const { return m_index; }
+    bool valid() const { return m_index >= 0; }
+};
+class VertexRef final {
+    int m_index = -1;
+
+public:
+    VertexRef() = default;
+    explicit VertexRef(int index)
+        : m_index{index} {}
+    int index() const { return m_index; }
+};
+}  // namespace poplar
+
+/// Spinning sense-reversing barrier, the last thread to arrive runs a
+/// completion callback before releasing the others.
+class VlBspCpuBarrier final {
+    const unsigned m_count;  // Number of participating threads
+    alignas(64) std::atomic<unsigned> m_waiting{0};  // Threads arrived in this phase
+    alignas(64) std::atomic<bool> m_sense{false};  // Flipped once per phase
+public:
+    explicit VlBspCpuBarrier(unsigned count)
+        : m_count{count} {}
+    template <typename T_Completion>
+    void wait(bool& localSense, T_Completion&& completion) {
+        localSense = !localSense;
+        if (m_waiting.fetch_add(1, std::memory_order_acq_rel) == m_count - 1) {
+            completion();
+            m_waiting.store(0, std::memory_order_relaxed);
+            m_sense.store(localSense, std::memory_order_release);
+        } else {
+            while (m_sense.load(std::memory_order_acquire) != localSense) VL_CPU_RELAX();
+        }
+    }
+};
+
+///
+/// VlPoplarContext for --bsp-cpu: runs the same BSP program as the IPU
+/// context, but on host threads. Every tile of the partitioned design is
+/// owned by one pinned worker thread. A superstep runs the vertices of each
+/// worker, then all workers meet on a spinning barrier and perform the copies
+/// whose destination they own (a plain memcpy of next to current buffers),
+/// followed by another barrier. The control flow of the programs mirrors
+/// VlPoplarContext::buildReEntrant in verilated_poplar_context.h, and so do
+/// the checkpoints, which are interchangeable with those of the IPU context.
+///
+class VlPoplarContext final {
+public:
+    using TensorId = int;
+
+private:
+    enum EProgramId : uint32_t { E_RESET = 0, E_INIT = 1, E_INITCOPY = 2, E_NBA = 3, _E_NUM_PROG };
+    enum EComputeSet : uint32_t { CS_WORKLOAD = 0, CS_INIT = 1, CS_COND = 2, _CS_NUM };
+    enum ESequence : uint32_t {
+        S_INIT = 0,
+        S_EXCHANGE = 1,
+        S_DPI = 2,
+        S_DPI_BROADCAST = 3,
+        S_RELAY = 4,  // Broadcast relays, before S_EXCHANGE
+        _S_NUM
+    };
+
+    struct TensorStorage {
+        std::unique_ptr<uint64_t[]> m_words;  // 8-byte aligned, as on the IPU
+        uint32_t m_size = 0;  // Size in 32-bit words
+        uint32_t m_tileId = 0;
+        std::unique_ptr<uint64_t[]> m_snapshot;  // Saved words, see VL_CYCLE_BATCH
+        uint32_t m_stateWords = 0;  // Number of saved words
+        uint32_t* data() { return reinterpret_cast<uint32_t*>(m_words.get()); }
+    };
+    struct VertexInstance {
+        const VlBspCpuVertexInfo* m_infop = nullptr;
+        void* m_objp = nullptr;
+        EComputeSet m_computeSet = CS_WORKLOAD;
+        uint32_t m_tileId = 0;
+    };
+    struct Connection {
+        int m_vertex;
+        std::string m_field;
+        int m_tensor;
+    };
+    struct CopyOp {
+        int m_from, m_to;  // Tensor indices
+        const uint32_t* m_fromp = nullptr;
+        uint32_t* m_top = nullptr;
+        uint32_t m_words = 0;
+    };
+    struct HostBuffer {
+        int m_tensor;
+        std::vector<uint32_t> buff;
+    };
+    // Work owned by a single thread, padded to avoid sharing lines with others
+    struct alignas(64) WorkerPlan {
+        std::array<std::vector<VertexInstance*>, _CS_NUM> m_vertices;
+        std::array<std::vector<CopyOp>, _S_NUM> m_copies;
+        std::vector<int> m_state;  // Storage saved before a batch of cycles
+        uint64_t m_randState = 0;  // PRNG state of the worker saved with m_state
+        uint64_t m_activitySkips = 0;  // Gated evaluations skipped, see sync
+        std::map<uint32_t, uint64_t> m_tileNanos;  // +bsp+profile, workload time per tile
+        uint64_t m_workloads = 0;  // +bsp+profile, number of workload steps
+        bool m_sense = false;  // Barrier sense
+    };
+
+    std::unique_ptr<VPROGRAM> vprog;
+    std::vector<TensorStorage> m_storage;
+    std::unordered_map<TensorId, int> tensors;  // Tensor id -> storage index
+    VlBspCheckpoint checkpoint;  // Every allocated tensor
+    std::unordered_map<TensorId, TensorId> nextToCurrent;
+    std::vector<VertexInstance> m_vertices;
+    std::unordered_map<std::string, int> vertices;  // Vertex name -> index
+    std::vector<Connection> m_connections;
+    std::array<std::vector<CopyOp>, _S_NUM> m_copies;
+    std::unordered_map<std::string, HostBuffer> hbuffers;
+    std::vector<int> hostRequest;
+    int interruptCond = -1;
+    std::vector<int> traceBuffers;  // --trace, change buffers of the BSP classes
+    int traceRequest = -1;  // Raised when a trace buffer may fill up
+#ifdef VL_BSP_TRACE
+    std::unique_ptr<VlBspTraceWriter> m_traceWriterp;
+#endif
+    bool hasInit = false;
+
+    // Execution state
+    std::vector<WorkerPlan> m_plans;
+    std::vector<std::thread> m_threads;
+    std::unique_ptr<VlBspCpuBarrier> m_barrierp;
+    // Sequence number << 8 | program, stored by the calling thread to start a program
+    alignas(64) std::atomic<uint64_t> m_start{0};
+    bool m_shutdown = false;
+    bool m_interrupt = false;  // Snapshot of interruptCond, taken at each barrier
+    bool m_traceFull = false;  // Snapshot of traceRequest, taken at each barrier
+    bool m_tileProfile = false;  // +bsp+profile, time the workload of every tile
+    uint64_t m_batchReplays = 0;  // Batches rolled back and replayed, see VL_CYCLE_BATCH
+
+    int storageIndex(const TensorId tid) const {
+        const auto it = tensors.find(tid);
+        if (it == tensors.end()) {
+            std::cerr << "Can not find tensor " << tid << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        return it->second;
+    }
+    int addTensor(uint32_t size, const TensorId& name);
+    HostBuffer& hostBuffer(const std::string& handle) {
+        const auto it = hbuffers.find(handle);
+        if (it == hbuffers.end()) {
+            std::cerr << "Can not find host handle " << handle << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        return it->second;
+    }
+
+    void startWorkers();
+    void workerLoop(uint32_t workerId);
+    void start(EProgramId prog);
+    void execute(uint32_t workerId, EProgramId prog);
+    void sync(WorkerPlan& plan);
+    void computeStep(WorkerPlan& plan, EComputeSet cs);
+    void profiledWorkload(WorkerPlan& plan);
+    void writeTileProfile() const;
+    void copies(WorkerPlan& plan, ESequence seq);
+    void copyStep(WorkerPlan& plan, ESequence seq);
+    void exchangeStep(WorkerPlan& plan);
+    void fusedCycle(WorkerPlan& plan, bool exchange = true);
+    void saveState(WorkerPlan& plan, bool restore);
+    void traceCheck(WorkerPlan& plan);
+    void traceDrain();
+    void run(EProgramId prog);
+
+public:
+    VlPoplarContext() = default;
+    ~VlPoplarContext();
+    void init(int argc, char* argv[]);
+    void build();
+    void runReEntrant();
+    void saveCheckpoint(const std::string& path);
+    void restoreCheckpoint(const std::string& path);
+    void addCopy(const TensorId& from, const TensorId& to, uint32_t size, const std::string& kind);
+    void addNextCurrentPair(const TensorId& next, const TensorId& current, uint32_t size);
+    void addRelay(const TensorId& source, const TensorId& relay, uint32_t size, uint32_t tileId);
+    void addBroadcastTarget(const TensorId& source, const TensorId& target, uint32_t size);
+
+    void setTileMapping(poplar::VertexRef& vtxRef, uint32_t tileId);
+    void setTileMapping(poplar::Tensor& tensor, uint32_t tileId);
+    void connect(poplar::VertexRef& vtxRef, const std::string& vtxField, poplar::Tensor& tensor);
+    void isHostRequest(poplar::Tensor& tensor, bool isInterruptCond);
+    void addTraceBuffer(const TensorId& name, uint32_t size);
+    void isTraceRequest(poplar::Tensor& tensor);
+    void createHostRead(const std::string& handleName, poplar::Tensor& tensor, uint32_t numElems);
+    void createHostWrite(const std::string& handleName, poplar::Tensor& tensor, uint32_t numElems);
+    // host reads and writes of a tensor share its storage, nothing to keep coherent
+    void pairHostReadWrite(const std::string&, const std::string&) {}
+    void setPerfEstimate(poplar::VertexRef&, int) {}
+    poplar::VertexRef getOrAddVertex(const std::string& name, const std::string& where);
+
+    poplar::Tensor getOrAddTensor(uint32_t size, const TensorId& name);
+
+    template <typename T>
+    inline T getHostData(const std::string& handle) {
+        static_assert(std::is_trivially_copy_assignable<T>());
+        static_assert(std::is_trivially_copy_constructible<T>());
+        HostBuffer& hb = hostBuffer(handle);
+        std::memcpy(hb.buff.data(), m_storage[hb.m_tensor].data(),
+                    hb.buff.size() * sizeof(uint32_t));
+        return (*reinterpret_cast<T*>(hb.buff.data()));
+    }
+    template <typename T>
+    inline void setHostData(const std::string& handle, const T& value) {
+        static_assert(std::is_trivially_copy_assignable<T>());
+        static_assert(std::is_trivially_copy_constructible<T>());
+        HostBuffer& hb = hostBuffer(handle);
+        std::memcpy(m_storage[hb.m_tensor].data(), &value,
+                    std::min(sizeof(T), hb.buff.size() * sizeof(uint32_t)));
+    }
+};
+
+#endif
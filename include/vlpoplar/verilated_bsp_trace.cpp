@@ -0,0 +1,184 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// Code available from: https://verilator.org
+//
+// Copyright 2001-2023 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//=============================================================================
+///
+/// \file  verilated_bsp_trace.cpp
+/// \brief Writes the change buffers of the BSP classes to an FST file
+///
+//=============================================================================
+
+#include "verilated_bsp_trace.h"
+
+// GTKWave configuration
+#define HAVE_LIBPTHREAD
+#define FST_WRITER_PARALLEL
+
+// Include the GTKWave implementation directly
+#define FST_CONFIG_INCLUDE "fst_config.h"
+#include "gtkwave/fastlz.c"
+#include "gtkwave/fstapi.c"
+#include "gtkwave/lz4.c"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+VlBspTraceWriter::VlBspTraceWriter(const std::string& tablePath, const std::string& fstPath) {
+    std::ifstream table{tablePath, std::ios::in};
+    if (!table) {
+        std::cerr << "Can not open " << tablePath << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    struct Entry {
+        std::string m_name;
+        uint32_t m_code;
+        uint32_t m_width;
+    };
+    std::vector<Entry> entries;
+    for (std::string ln; std::getline(table, ln);) {
+        if (ln.empty() || ln[0] == '#') continue;
+        std::istringstream is{ln};
+        Entry entry;
+        is >> entry.m_code >> entry.m_width >> std::ws;
+        std::getline(is, entry.m_name);
+        entries.push_back(entry);
+    }
+    m_fstp = fstWriterCreate(fstPath.c_str(), 1);
+    if (!m_fstp) {
+        std::cerr << "Can not create " << fstPath << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    fstWriterSetPackType(m_fstp, FST_WR_PT_LZ4);
+    fstWriterSetTimescaleFromString(m_fstp, "1ns");
+    fstWriterSetParallelMode(m_fstp, 1);
+
+    // Open and close the scopes between two signals in name order
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.m_name < b.m_name; });
+    std::vector<std::string> scopes;
+    for (const Entry& entry : entries) {
+        std::vector<std::string> path;
+        std::string::size_type begin = 0, dot;
+        while ((dot = entry.m_name.find('.', begin)) != std::string::npos) {
+            path.push_back(entry.m_name.substr(begin, dot - begin));
+            begin = dot + 1;
+        }
+        size_t common = 0;
+        while (common < scopes.size() && common < path.size() && scopes[common] == path[common]) {
+            ++common;
+        }
+        for (; scopes.size() > common; scopes.pop_back()) fstWriterSetUpscope(m_fstp);
+        for (; scopes.size() < path.size(); scopes.push_back(path[scopes.size()])) {
+            fstWriterSetScope(m_fstp, FST_ST_VCD_MODULE, path[scopes.size()].c_str(), nullptr);
+        }
+        if (entry.m_code >= m_signals.size()) m_signals.resize(entry.m_code + 1);
+        Signal& sig = m_signals[entry.m_code];
+        sig.m_width = entry.m_width;
+        sig.m_words = (entry.m_width + 31) / 32;
+        sig.m_handle = fstWriterCreateVar(m_fstp, FST_VT_VCD_WIRE, FST_VD_IMPLICIT,
+                                          entry.m_width, entry.m_name.substr(begin).c_str(), 0);
+    }
+    for (; !scopes.empty(); scopes.pop_back()) fstWriterSetUpscope(m_fstp);
+
+    // The device compares against zero in the first cycle
+    fstWriterEmitTimeChange(m_fstp, 0);
+    std::vector<uint32_t> zeros;
+    for (const Signal& sig : m_signals) {
+        if (!sig.m_handle) continue;
+        zeros.resize(std::max<size_t>(zeros.size(), sig.m_words), 0);
+        fstWriterEmitValueChangeVec32(m_fstp, sig.m_handle, sig.m_width, zeros.data());
+    }
+    m_thread = std::thread{[this]() { writerLoop(); }};
+}
+
+VlBspTraceWriter::~VlBspTraceWriter() { close(); }
+
+void VlBspTraceWriter::drain(const std::vector<const uint32_t*>& buffersp) {
+    std::vector<uint32_t> words;
+    for (const uint32_t* const bufp : buffersp) {
+        if (bufp[0]) words.insert(words.end(), bufp, bufp + 1 + bufp[0]);
+    }
+    if (words.empty()) return;
+    {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        m_queue.push_back(std::move(words));
+    }
+    m_cv.notify_one();
+}
+
+void VlBspTraceWriter::close() {
+    if (!m_fstp) return;
+    {
+        const std::lock_guard<std::mutex> lock{m_mutex};
+        m_done = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+    fstWriterClose(m_fstp);
+    m_fstp = nullptr;
+}
+
+void VlBspTraceWriter::writerLoop() {
+    while (true) {
+        std::vector<uint32_t> buffers;
+        {
+            std::unique_lock<std::mutex> lock{m_mutex};
+            m_cv.wait(lock, [this]() { return m_done || !m_queue.empty(); });
+            if (m_queue.empty()) return;  // done
+            buffers = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        write(buffers);
+    }
+}
+
+void VlBspTraceWriter::write(const std::vector<uint32_t>& buffers) {
+    struct Change {
+        uint64_t m_cycle;
+        uint32_t m_code;
+        const uint32_t* m_valuep;
+    };
+    // Every buffer is in cycle order, the changes of all of them are merged
+    std::vector<Change> changes;
+    const auto extend = [this](uint32_t cycle) {
+        uint64_t full = (m_lastCycle & ~0xffffffffULL) | cycle;
+        if (full + 0x80000000ULL < m_lastCycle) full += 0x100000000ULL;
+        return full;
+    };
+    for (size_t pos = 0; pos < buffers.size();) {
+        const size_t end = pos + 1 + buffers[pos];
+        for (++pos; pos < end;) {
+            const uint64_t cycle = extend(buffers[pos]);
+            const uint32_t count = buffers[pos + 1];
+            pos += 2;
+            for (uint32_t ix = 0; ix < count; ++ix) {
+                const uint32_t code = buffers[pos];
+                if (code >= m_signals.size() || !m_signals[code].m_handle) {
+                    std::cerr << "Invalid trace record " << code << std::endl;
+                    std::exit(EXIT_FAILURE);
+                }
+                changes.push_back(Change{cycle, code, &buffers[pos + 1]});
+                pos += 1 + m_signals[code].m_words;
+            }
+        }
+    }
+    std::stable_sort(changes.begin(), changes.end(), [](const Change& a, const Change& b) {
+        return a.m_cycle < b.m_cycle;
+    });
+    for (const Change& change : changes) {
+        if (change.m_cycle != m_lastCycle) fstWriterEmitTimeChange(m_fstp, change.m_cycle);
+        m_lastCycle = change.m_cycle;
+        const Signal& sig = m_signals[change.m_code];
+        fstWriterEmitValueChangeVec32(m_fstp, sig.m_handle, sig.m_width, change.m_valuep);
+    }
+}
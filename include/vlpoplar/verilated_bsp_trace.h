@@ -0,0 +1,72 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// Code available from: https://verilator.org
+//
+// Copyright 2001-2023 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//=============================================================================
+///
+/// \file  verilated_bsp_trace.h
+/// \brief Writes the change buffers of the BSP classes to an FST file
+///
+//=============================================================================
+
+#ifndef VERILATOR_VERILATED_BSP_TRACE_H_
+#define VERILATOR_VERILATED_BSP_TRACE_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+///
+/// VlBspTraceWriter turns the change buffers of the BSP classes (see
+/// V3BspTrace) into an FST file. Every buffer starts with the number of used
+/// words, followed by one record per cycle with a change:
+///
+///     cycle, count, count x { code, value words (LSB first) }
+///
+/// drain() only copies the used words and returns, the records are decoded,
+/// merged by cycle and written by a background thread, so the device can go
+/// on while the host writes. One cycle is one time unit, time 0 holds the
+/// reset values (zero) of all signals.
+///
+class VlBspTraceWriter final {
+    struct Signal {
+        uint32_t m_handle = 0;  // FST handle
+        uint32_t m_width = 0;
+        uint32_t m_words = 0;
+    };
+
+    std::vector<Signal> m_signals;  // Indexed by code
+    void* m_fstp = nullptr;
+    uint64_t m_lastCycle = 0;  // Cycles are 32-bit on the device
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::vector<uint32_t>> m_queue;  // Drained buffers, one after another
+    bool m_done = false;
+    std::thread m_thread;
+
+    void writerLoop();
+    void write(const std::vector<uint32_t>& buffers);
+
+public:
+    // Read the signals from tablePath (<prefix>_trace.txt) and create fstPath
+    VlBspTraceWriter(const std::string& tablePath, const std::string& fstPath);
+    ~VlBspTraceWriter();
+    // Queue the records of the given buffers, the buffers can be cleared on return
+    void drain(const std::vector<const uint32_t*>& buffersp);
+    // Write everything queued so far and close the file
+    void close();
+};
+
+#endif  // Guard
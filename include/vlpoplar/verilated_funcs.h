@@ -31,10 +31,20 @@
 /// Print a debug message from internals with standard prefix, with printf style format
 #define VL_DBG_MSGF(fmt, args...) printf("[DBG]" fmt, ##args)
 
+#ifdef VL_BSP_CPU
+VL_ATTR_ALWINLINE uint64_t vl_rand64() {
+    uint64_t& x = VlBspCpuRandom::state();
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return x;
+}
+#else
 VL_ATTR_ALWINLINE uint64_t vl_rand64() {
     return static_cast<uint64_t>(__builtin_ipu_urand32()) |
         (static_cast<uint64_t>(__builtin_ipu_urand32()) << 32);
 }
+#endif
 // EMIT_RULE: VL_RANDOM:  oclean=dirty
 VL_ATTR_ALWINLINE IData VL_RANDOM_I() { return vl_rand64(); }
 VL_ATTR_ALWINLINE QData VL_RANDOM_Q() { return vl_rand64(); }
@@ -43,6 +53,7 @@ VL_ATTR_ALWINLINE WDataOutP VL_RANDOM_W(int obits, WDataOutP outwp) {
     return outwp;
 }
 
+#ifndef VL_BSP_CPU
 template <unsigned int Index>
 VL_ATTR_ALWINLINE void ipu_csr_write(IData value) {
     // 0 <= lower CSR space <= 255
@@ -58,6 +69,18 @@ VL_ATTR_ALWINLINE void ipu_set_prng_seed(IData seed) {
     constexpr auto PRNG_SEED_INDEX = 0x107;
     ipu_csr_write<PRNG_SEED_INDEX>(seed);
 }
+#else
+VL_ATTR_ALWINLINE void ipu_set_prng_seed(IData seed) {
+    VlBspCpuRandom::state() = (static_cast<uint64_t>(seed) << 32) | 0x2545f491ULL;
+}
+#endif
+
+// A gated class skipped its nbaTop, see V3BspActivity. Only counted on the host.
+#ifdef VL_BSP_CPU
+VL_ATTR_ALWINLINE void VL_BSP_ACTIVITY_SKIP() { ++VlBspCpuActivity::skips(); }
+#else
+VL_ATTR_ALWINLINE void VL_BSP_ACTIVITY_SKIP() {}
+#endif
 
 VL_ATTR_ALWINLINE IData VL_RANDOM_SEEDED_II(IData& seedr) {
     // $random - seed is a new seed to apply, then we return new seed
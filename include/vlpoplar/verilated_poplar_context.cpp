@@ -4,12 +4,16 @@
 #include "verilated_poplar_context.h"
 
 #include "verilated.h"
+#ifdef VL_BSP_TRACE
+#include "verilated_bsp_trace.h"
+#endif
 
 #include <chrono>
 #include <fstream>
 #include <iomanip>
 
 #include <poplar/CycleCount.hpp>
+#include <poplar/RandomSeed.hpp>
 #ifndef VL_NUM_TILES_USED
 #error "VL_NUM_TILES_USED is no defined!"
 #endif
@@ -93,6 +97,7 @@ void VlPoplarContext::init(int argc, char* argv[]) {
     vprog->exchange();
     vprog->dpiExchange();
     vprog->dpiBroadcast();
+    addBroadcastCopies();
 }
 
 void VlPoplarContext::buildReEntrant() {
@@ -110,13 +115,55 @@ void VlPoplarContext::buildReEntrant() {
     resetProg.add(Copy(zeroValue, interruptCond[0]));  // need to clear the lo
     for (auto hreq : hostRequest) { resetProg.add(Copy(zeroValue, hreq[0])); }
 
+    // every host read tensor goes to the host in a single transfer at the end of each
+    // program, see getHostData
+    Sequence hostReadCopy;
+    if (!hostReadTensors.empty()) {
+        const std::size_t numWords = hostReadBatch.size();
+        auto stream = graph->addDeviceToHostFIFO(HOST_READ_BATCH, UNSIGNED_INT, numWords);
+        hostReadCopy.add(Copy(concat(hostReadTensors), stream));
+    }
+
+    // --trace, the change buffers go to the host when one of them may fill up before
+    // the next check of hasDpi, and at the end of every nba program
+    Sequence traceDrain, traceCheck;
+    if (!traceBuffers.empty()) {
+        std::vector<Tensor> buffers;
+        for (const TensorId id : traceBuffers) buffers.push_back(getTensor(id));
+        Tensor all = concat(buffers);
+        auto hfunc = graph->addHostFunction("cb_trace", {{UNSIGNED_INT, all.numElements()}}, {});
+        traceDrain.add(Call(hfunc, {all}, {}));
+        for (Tensor& buffer : buffers) traceDrain.add(Copy(zeroValue, buffer[0]));
+        if (traceRequest.valid()) traceCheck.add(If{traceRequest[0], traceDrain, Sequence{}});
+    }
+
+    // every tensor in a single transfer, see saveCheckpoint
+    Sequence saveProg, restoreProg;
+    {
+        std::vector<Tensor> state;
+        for (size_t ix = 0; ix < checkpoint.size(); ++ix) {
+            state.push_back(getTensor(checkpoint.id(ix)).flatten());
+        }
+        Tensor all = concat(state);
+        auto saveStream
+            = graph->addDeviceToHostFIFO(CHECKPOINT_SAVE, UNSIGNED_INT, all.numElements());
+        auto restoreStream
+            = graph->addHostToDeviceFIFO(CHECKPOINT_RESTORE, UNSIGNED_INT, all.numElements());
+        saveProg.add(Copy(all, saveStream));
+        restoreProg.add(Copy(restoreStream, all));
+    }
+
     Sequence initProg;
+#if VL_FUSED_COND && VL_CYCLE_BATCH > 1
+    initProg.add(Copy(zeroValue, interruptCond[0]));  // hasDpi is sticky
+#endif
     if (hasInit) {
         initProg.add(Execute(*initializer));
         initProg.add(dpiCopies);
         initProg.add(Execute{*condeval});
         initProg.add(dpiBroadcastCopies);
     }
+    initProg.add(hostReadCopy);
 
 #ifdef VL_INSTRUMENT
     struct TsHandles {
@@ -212,6 +259,110 @@ void VlPoplarContext::buildReEntrant() {
 #endif
 
     // clang-format off
+#if VL_FUSED_COND
+    // the condeval twin in the workload evaluates the condition of the previous cycle,
+    // so the first cycle is computed right after the initial exchange
+    initCopies.add(dpiCopies);
+    initCopies.add(Execute{*workload});
+    Sequence simCycle {
+#ifdef VL_INSTRUMENT
+        tsPreExchange->program,
+#endif
+        exchangeCopies
+        , dpiCopies
+#ifdef VL_INSTRUMENT
+        , tsPreWorkload->program
+#endif
+        , Execute{*workload}
+#ifdef VL_INSTRUMENT
+        , tsPostWorkload->program
+#endif
+    };
+    Sequence afterCheck {
+#ifdef VL_INSTRUMENT
+        If {
+            tsPostWorkload->ovf[0],
+            Sequence{
+                tsPreExchange->callback(),
+                tsPreWorkload->callback(),
+                tsPostWorkload->callback()
+            },
+            Sequence{}
+        },
+#endif
+        traceCheck
+    };
+#if VL_CYCLE_BATCH > 1
+    // hasDpi is sticky (see V3BspDpi), so it is only checked once every
+    // VL_CYCLE_BATCH cycles. A batch that raised a request is rolled back to the
+    // state it started from and replayed checking every cycle, which stops at the
+    // cycle that raised it. Tensors that every cycle overwrites before reading them
+    // need no snapshot, and the records of a trace buffer past its head word are
+    // simply written again. The PRNG seeds of the tiles are saved as well, so the
+    // replay draws the same $random values.
+    Sequence saveState, restoreState;
+    Tensor hwSeeds = getHwSeeds(*graph, saveState, "SnapshotHwSeeds");
+    setHwSeeds(*graph, hwSeeds, restoreState, "RestoreHwSeeds");
+    const std::unordered_set<TensorId> traceSet{traceBuffers.begin(), traceBuffers.end()};
+    for (const auto& pair : tensors) {
+        if (overwritten.count(pair.first)) continue;
+        Tensor state = traceSet.count(pair.first) ? pair.second.slice(0, 1) : pair.second;
+        Tensor snapshot = graph->clone(state, "Snapshot_" + std::to_string(pair.first));
+        saveState.add(Copy(state, snapshot));
+        restoreState.add(Copy(snapshot, state));
+    }
+#if VL_LOOKAHEAD > 1
+    // the replicas of remote state keep the tiles exact for VL_LOOKAHEAD cycles
+    // after an exchange, see V3BspLookahead
+    Sequence localCycle {
+#ifdef VL_INSTRUMENT
+        tsPreExchange->program,
+#endif
+        dpiCopies
+#ifdef VL_INSTRUMENT
+        , tsPreWorkload->program
+#endif
+        , Execute{*workload}
+#ifdef VL_INSTRUMENT
+        , tsPostWorkload->program
+#endif
+    };
+    static_assert(VL_CYCLE_BATCH % VL_LOOKAHEAD == 0, "batch should hold whole windows");
+    Repeat batchCycles {
+        VL_CYCLE_BATCH / VL_LOOKAHEAD,
+        Sequence{simCycle, Repeat{VL_LOOKAHEAD - 1, localCycle}}
+    };
+#else
+    Repeat batchCycles {VL_CYCLE_BATCH, simCycle};
+#endif
+    Sequence nbaProg {
+        Copy(zeroValue, interruptCond[0]),
+        RepeatWhileFalse{
+            Sequence{
+                saveState,
+                batchCycles
+            },
+            interruptCond[0],
+            afterCheck
+        },
+        // hasDpi was clear when the state was saved
+        restoreState,
+        RepeatWhileFalse{simCycle, interruptCond[0], afterCheck}
+#else
+    Sequence nbaProg {
+        RepeatWhileFalse{simCycle, interruptCond[0], afterCheck}
+#endif
+#ifdef VL_INSTRUMENT
+        , Sequence{
+            tsPreExchange->callback(),
+            tsPreWorkload->callback(),
+            tsPostWorkload->callback()
+        }
+#endif
+        , traceDrain
+        , hostReadCopy
+    };
+#else
     Sequence simLoop {
         dpiBroadcastCopies
         , Execute{*workload}
@@ -222,6 +373,7 @@ void VlPoplarContext::buildReEntrant() {
             },
             interruptCond[0],
             Sequence{
+                traceCheck,
 #ifdef VL_INSTRUMENT
                 // timestamp
                 tsPreExchange->program,
@@ -275,14 +427,19 @@ void VlPoplarContext::buildReEntrant() {
             interruptCond[0],
             Sequence{},
             simLoop
-        }
+        },
+        traceDrain,
+        hostReadCopy
     };
+#endif
 
     std::vector<Program> programs {
         resetProg,
         initProg,
         initCopies,
-        nbaProg
+        nbaProg,
+        saveProg,
+        restoreProg
     };
     // clang-format on
     OptionFlags flags{};
@@ -345,6 +502,9 @@ void VlPoplarContext::runReEntrant() {
             }
 #endif
             engine = std::make_unique<poplar::Engine>(*exec, flags);
+            if (!hostReadBatch.empty()) {
+                engine->connectStream(HOST_READ_BATCH, hostReadBatch.data());
+            }
             engine->load(*device);
             vprog->plusArgs();
             vprog->plusArgsCopy();
@@ -363,10 +523,20 @@ void VlPoplarContext::runReEntrant() {
         std::ofstream ofs;
         const std::string name;
         std::mutex m_mutex;
+        // per tile, the first time stamp and the sum of all others relative to it
+        std::vector<uint64_t> base;
+        std::vector<unsigned __int128> sum;
         TimeTraceDump(const std::string& name)
-            : name{name} {
+            : name{name}
+            , base(VL_NUM_TILES_USED, 0)
+            , sum(VL_NUM_TILES_USED, 0) {
             ofs = std::ofstream{std::string{OBJ_DIR} + "/" + name + ".txt", std::ios::out};
         }
+        double mean(int tid) const {
+            if (!lastCount) return 0.0;
+            return static_cast<double>(base[tid])
+                   + static_cast<double>(sum[tid] / lastCount);
+        }
     };
     std::vector<uint64_t> initTimeStamps;
 
@@ -394,6 +564,10 @@ void VlPoplarContext::runReEntrant() {
                                       << j << std::endl;
                         }
                         // uint64_t its = initTimeStamps[i];
+                        if (dump.lastCount == 0) dump.base[i] = vl;
+                        // A stamp below the base (e.g., a missing zero stamp) counts as the
+                        // base, the unsigned difference would wrap to a huge mean
+                        if (vl > dump.base[i]) dump.sum[i] += vl - dump.base[i];
 
                         dump.ofs << vl << "    ";
                     }
@@ -416,15 +590,44 @@ void VlPoplarContext::runReEntrant() {
             initTsDump.ofs << std::endl;
         });
 #endif
-    do {
-        profile << "init " << invIndex << std::endl;
-        measure([this]() {
-            engine->run(E_INIT);
-            vprog->hostHandle();
-        }, "\twall");
-        interrupt = getHostData<uint32_t>("interrupt");
-    } while (interrupt && !Verilated::gotFinish());
-    engine->run(E_INITCOPY);
+#ifdef VL_BSP_TRACE
+    std::unique_ptr<VlBspTraceWriter> traceWriterp;
+    if (!traceBuffers.empty()) {
+        const std::string fstPath = Verilated::commandArgsPlusMatch("trace+file+")[0]
+                                        ? Verilated::commandArgsPlusMatch("trace+file+") + 12
+                                        : OBJ_DIR "/" ROOT_NAME ".fst";
+        traceWriterp = std::make_unique<VlBspTraceWriter>(OBJ_DIR "/" ROOT_NAME "_trace.txt",
+                                                          fstPath);
+        engine->connectHostFunction(
+            "cb_trace", 0,
+            [this, &traceWriterp](poplar::ArrayRef<const void*> ins,
+                                  poplar::ArrayRef<void*> /*unused*/) -> void {
+                const uint32_t* argp = reinterpret_cast<const uint32_t*>(ins[0]);
+                std::vector<const uint32_t*> buffersp;
+                for (const uint32_t size : traceBufferSizes) {
+                    buffersp.push_back(argp);
+                    argp += size;
+                }
+                traceWriterp->drain(buffersp);
+            });
+    }
+#endif
+    const std::string restorePath = Verilated::commandArgsPlusMatch("checkpoint+restore+");
+    if (!restorePath.empty()) {
+        // the checkpoint already holds the plusargs, memories and the initial state
+        measure([this, &restorePath]() { restoreCheckpoint(restorePath.substr(20)); },
+                "restore");
+    } else {
+        do {
+            profile << "init " << invIndex << std::endl;
+            measure([this]() {
+                engine->run(E_INIT);
+                vprog->hostHandle();
+            }, "\twall");
+            interrupt = getHostData<uint32_t>("interrupt");
+        } while (interrupt && !Verilated::gotFinish());
+        engine->run(E_INITCOPY);
+    }
 
     // starting the main simulation loop
     auto simLoopStart = std::chrono::high_resolution_clock::now();
@@ -434,6 +637,14 @@ void VlPoplarContext::runReEntrant() {
         vprog->hostHandle();
     }
 
+#ifdef VL_BSP_TRACE
+    if (traceWriterp) traceWriterp->close();
+#endif
+    const std::string savePath = Verilated::commandArgsPlusMatch("checkpoint+save+");
+    if (!savePath.empty()) {
+        measure([this, &savePath]() { saveCheckpoint(savePath.substr(17)); }, "save");
+    }
+
     auto simEnd = std::chrono::high_resolution_clock::now();
     profile << "sim: " << std::chrono::duration<double>(simEnd - simLoopStart).count() << "s"
             << std::endl;
@@ -446,10 +657,38 @@ void VlPoplarContext::runReEntrant() {
     preWorkload.ofs.close();
     postWorkload.ofs.close();
     initTsDump.ofs.close();
+    {
+        // mean compute cycles of every tile, can be fed back with --bsp-profile-use
+        std::ofstream tileProfile{OBJ_DIR "/" ROOT_NAME "_tileProfile.txt", std::ios::out};
+        tileProfile << "# tile cycles" << std::endl;
+        for (int tid = 0; tid < VL_NUM_TILES_USED; tid++) {
+            tileProfile << tid << " "
+                        << std::max(0.0, postWorkload.mean(tid) - preWorkload.mean(tid))
+                        << std::endl;
+        }
+    }
 
 #endif
 }
 
+void VlPoplarContext::saveCheckpoint(const std::string& path) {
+    std::vector<uint32_t> words(checkpoint.words());
+    engine->connectStream(CHECKPOINT_SAVE, words.data());
+    engine->run(E_SAVE);
+    std::vector<const uint32_t*> datap;
+    for (size_t ix = 0; ix < checkpoint.size(); ++ix) {
+        datap.push_back(words.data() + checkpoint.offset(ix));
+    }
+    checkpoint.save(path, datap);
+}
+
+void VlPoplarContext::restoreCheckpoint(const std::string& path) {
+    // stream straight from the mapped file
+    const uint32_t* const datap = checkpoint.restore(path);
+    engine->connectStream(CHECKPOINT_RESTORE, const_cast<uint32_t*>(datap));
+    engine->run(E_RESTORE);
+}
+
 void VlPoplarContext::addNextCurrentPair(const TensorId& next, const TensorId& current,
                                          uint32_t size) {
     if (tensors.count(next) == 0) {
@@ -458,14 +697,59 @@ void VlPoplarContext::addNextCurrentPair(const TensorId& next, const TensorId& c
         poplar::Tensor tCurrent = addTensor(size, current);
         nextToCurrent.emplace(next, current);
         exchangeCopies.add(poplar::program::Copy{tNext, tCurrent, true});
+        overwritten.insert(current);
     }
     if (tensors.count(current) == 0) {
+        overwritten.insert(current);
         // currentToNext.emplace(current, next);
         poplar::Tensor currentTensor = getTensor(nextToCurrent[next]);
         tensors.emplace(current, currentTensor);
     }
 }
 
+void VlPoplarContext::addRelay(const TensorId& source, const TensorId& relay, uint32_t size,
+                               uint32_t tileId) {
+    if (tensors.count(source) == 0) addTensor(size, source);
+    poplar::Tensor relayTensor = addTensor(size, relay);
+    setTileMapping(relayTensor, tileId);
+    relays.emplace_back(source, relay);
+    overwritten.insert(relay);
+}
+
+void VlPoplarContext::addBroadcastTarget(const TensorId& source, const TensorId& target,
+                                         uint32_t size) {
+    if (tensors.count(source) == 0) addTensor(size, source);
+    if (tensors.count(target) == 0) addTensor(size, target);
+    std::vector<TensorId>& targets = broadcastTargets[source];
+    if (targets.empty()) broadcastSources.push_back(source);
+    targets.push_back(target);
+    overwritten.insert(target);
+}
+
+void VlPoplarContext::addBroadcastCopies() {
+    using namespace poplar;
+    // One copy sends every relayed source to the other IPUs, then one more copy
+    // broadcasts every source to all of its targets. The exchange sends a broadcast
+    // source once to all the tiles that receive it.
+    if (!relays.empty()) {
+        std::vector<Tensor> sources, targets;
+        for (const auto& pair : relays) {
+            sources.push_back(getTensor(pair.first));
+            targets.push_back(getTensor(pair.second));
+        }
+        exchangeCopies.add(program::Copy{concat(sources), concat(targets), true});
+    }
+    if (!broadcastSources.empty()) {
+        std::vector<Tensor> sources, targets;
+        for (const TensorId source : broadcastSources) {
+            const std::vector<TensorId>& ids = broadcastTargets[source];
+            sources.push_back(getTensor(source).broadcast(ids.size(), 0));
+            for (const TensorId id : ids) targets.push_back(getTensor(id));
+        }
+        exchangeCopies.add(program::Copy{concat(sources), concat(targets), true});
+    }
+}
+
 void VlPoplarContext::addCopy(const TensorId& from, const TensorId& to, uint32_t size,
                               const std::string& kind) {
 #ifdef GRAPH_COMPILE
@@ -477,6 +761,7 @@ void VlPoplarContext::addCopy(const TensorId& from, const TensorId& to, uint32_t
         initCopies.add(cp);
     } else if (kind == "dpiExchange") {
         dpiCopies.add(cp);
+        overwritten.insert(to);
     } else if (kind == "dpiBroadcast") {
         dpiBroadcastCopies.add(cp);
     } else {
@@ -498,6 +783,7 @@ poplar::Tensor VlPoplarContext::addTensor(uint32_t size, const TensorId& name) {
         graph->setInitialValue(t, 0u);
     }
     tensors.emplace(name, t);
+    checkpoint.add(name, std::max(size, 2u));
     return t;
 }
 poplar::Tensor VlPoplarContext::getOrAddTensor(uint32_t size, const TensorId& name) {
@@ -508,6 +794,8 @@ poplar::Tensor VlPoplarContext::getOrAddTensor(uint32_t size, const TensorId& na
         return getTensor(name);
     }
 #else
+    // only remember the layout of the state, see saveCheckpoint
+    if (tensors.emplace(name, poplar::Tensor{}).second) checkpoint.add(name, std::max(size, 2u));
     return poplar::Tensor{};
 #endif
 }
@@ -526,6 +814,9 @@ poplar::VertexRef VlPoplarContext::getOrAddVertex(const std::string& name,
         } else if (where == "condeval") {
             hasCond = true;
             vertices.emplace(name, graph->addVertex(*condeval, name));
+#if VL_FUSED_COND
+            condevalTwins.emplace(vertices[name].getId(), graph->addVertex(*workload, name));
+#endif
         } else {
             std::cerr << "invalid computeset \"" << where << "\"" << std::endl;
             std::exit(EXIT_FAILURE);
@@ -539,6 +830,8 @@ poplar::VertexRef VlPoplarContext::getOrAddVertex(const std::string& name,
 void VlPoplarContext::setTileMapping(poplar::VertexRef& vtxRef, uint32_t tileId) {
 #ifdef GRAPH_COMPILE
     graph->setTileMapping(vtxRef, tileId);
+    const auto twinIt = condevalTwins.find(vtxRef.getId());
+    if (twinIt != condevalTwins.end()) graph->setTileMapping(twinIt->second, tileId);
 #endif
 }
 void VlPoplarContext::setTileMapping(poplar::Tensor& tensor, uint32_t tileId) {
@@ -550,14 +843,23 @@ void VlPoplarContext::connect(poplar::VertexRef& vtx, const std::string& field,
                               poplar::Tensor& tensor) {
 #ifdef GRAPH_COMPILE
     graph->connect(vtx[field], tensor);
+    const auto twinIt = condevalTwins.find(vtx.getId());
+    if (twinIt != condevalTwins.end()) graph->connect(twinIt->second[field], tensor);
 #endif
 }
 void VlPoplarContext::createHostRead(const std::string& handle, poplar::Tensor& tensor,
                                      uint32_t numElems) {
+    if (hostReadSlots.count(handle)) return;
 #ifdef GRAPH_COMPILE
     graph->createHostRead(handle, tensor);
+    hostReadTensors.push_back(tensor.flatten());
 #endif
     hbuffers.emplace(handle, std::make_unique<HostBuffer>(numElems));
+    // the layout has to be the same when compiling and running the graph, so it only
+    // depends on the sizes (tensors are padded to 2 words, see addTensor)
+    const uint32_t offset = hostReadBatch.size();
+    hostReadSlots.emplace(handle, HostReadSlot{offset, numElems});
+    hostReadBatch.resize(offset + std::max(numElems, 2u));
 }
 void VlPoplarContext::createHostWrite(const std::string& handle, poplar::Tensor& tensor,
                                       uint32_t numElems) {
@@ -566,6 +868,14 @@ void VlPoplarContext::createHostWrite(const std::string& handle, poplar::Tensor&
 #endif
     hbuffers.emplace(handle, std::make_unique<HostBuffer>(numElems));
 }
+void VlPoplarContext::pairHostReadWrite(const std::string& readHandle,
+                                        const std::string& writeHandle) {
+    if (!hostReadSlots.count(readHandle)) {
+        std::cerr << "Can not find host read handle " << readHandle << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    hostWriteToRead[writeHandle] = readHandle;
+}
 
 void VlPoplarContext::isHostRequest(poplar::Tensor& tensor, bool isInterruptCond) {
 #ifdef GRAPH_COMPILE
@@ -579,6 +889,18 @@ void VlPoplarContext::isHostRequest(poplar::Tensor& tensor, bool isInterruptCond
 #endif
 }
 
+void VlPoplarContext::addTraceBuffer(const TensorId& name, uint32_t size) {
+    // the sizes are also needed to split the buffers when running the graph
+    traceBuffers.push_back(name);
+    traceBufferSizes.push_back(size);
+}
+
+void VlPoplarContext::isTraceRequest(poplar::Tensor& tensor) {
+#ifdef GRAPH_COMPILE
+    traceRequest = tensor;
+#endif
+}
+
 int main(int argc, char* argv[]) {
     VlPoplarContext ctx;
     ctx.init(argc, argv);
@@ -21,11 +21,24 @@
 
 // #include "VProgram.h"
 #include "verilated.h"
+#include "verilated_bsp_checkpoint.h"
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
+
+#ifndef VL_FUSED_COND
+#define VL_FUSED_COND 0
+#endif
+#ifndef VL_CYCLE_BATCH
+#define VL_CYCLE_BATCH 1
+#endif
+#ifndef VL_LOOKAHEAD
+#define VL_LOOKAHEAD 1
+#endif
 
 #include <boost/filesystem.hpp>
 #include <poplar/DeviceManager.hpp>
@@ -108,7 +121,68 @@ class VPROGRAM;
 ///             IPU|        nbaExchange
 ///             IPU| if !hasDpi:
 ///             IPU|        simLoop
+///             IPU| hostReadBatch
+///             hostHandle();
+///
+/// With VL_FUSED_COND (set when no DPI call of the nba phase has strict
+/// semantics, see V3BspDpi) dpiEval runs in the same compute phase as the nba
+/// workload through a twin of the condeval vertex, so every cycle is a single
+/// exchange and a single compute phase:
+///
+///         initExchange also runs dpiExchange and the first Execute(nba)
+///         while !finished:
+///             IPU| do:
+///             IPU|    nbaExchange
+///             IPU|    dpiExchange
+///             IPU|    Execute(nba + dpiEval)
+///             IPU| while !hasDpi
+///             IPU| hostReadBatch
 ///             hostHandle();
+///
+/// hasDpi then describes the cycle before the one just computed, and
+/// hostHandle() reads that cycle's DPI arguments from copies kept in the
+/// condeval vertex. The cycle computed after a $finish is never observed.
+///
+/// With VL_CYCLE_BATCH = N > 1 (--bsp-cycle-batch, fused condition only)
+/// hasDpi is sticky and checked once every N cycles:
+///
+///             IPU| hasDpi = 0
+///             IPU| do:
+///             IPU|    save the state
+///             IPU|    repeat N: one cycle as above
+///             IPU| while !hasDpi
+///             IPU| restore the state
+///             IPU| do: one cycle as above while !hasDpi
+///
+/// The replay stops at the same cycle as checking every cycle would, so the
+/// batch size only trades snapshot memory and replayed cycles for fewer
+/// checks of the condition.
+///
+/// With VL_LOOKAHEAD = K > 1 (--bsp-lookahead) every tile recomputes the
+/// remote state it reads for K cycles, so only the first cycle of every K
+/// cycles of a batch exchanges. The replay still exchanges every cycle.
+///
+/// Both the initial and the nba programs end with hostReadBatch, a single
+/// device-to-host copy of every host read tensor. All the pending DPI and
+/// $display records of all tiles thus reach the host in one transfer, and
+/// hostHandle() services them from that buffer without further device reads.
+///
+/// With --trace every BSP class appends its changes to a trace buffer (see
+/// V3BspTrace). The condeval class raises traceFull when a buffer may not hold
+/// the cycles until the next check of hasDpi, on which the buffers are passed
+/// to the host function cb_trace and cleared:
+///
+///             IPU| if traceFull: cb_trace(traceBuffers); clear traceBuffers
+///
+/// This runs after every check of hasDpi, and unconditionally before
+/// hostReadBatch. Only the head word of a trace buffer is part of the state
+/// saved for VL_CYCLE_BATCH.
+///
+/// Two more programs stream every tensor to or from the host, which
+/// saveCheckpoint and restoreCheckpoint use. A run with
+/// +checkpoint+restore+<file> restores after loading the engine instead of
+/// running the initial phase, and +checkpoint+save+<file> saves once the
+/// simulation finishes, so many tests can start from a common post-boot state.
 
 
 class VlPoplarContext final {
@@ -123,7 +197,22 @@ private:
         HostBuffer(uint32_t elems)
             : buff(elems){};
     };
-    enum EProgramId : uint32_t { E_RESET = 0, E_INIT = 1, E_INITCOPY = 2, E_NBA = 3, _E_NUM_PROG };
+    enum EProgramId : uint32_t {
+        E_RESET = 0,
+        E_INIT = 1,
+        E_INITCOPY = 2,
+        E_NBA = 3,
+        E_SAVE = 4,
+        E_RESTORE = 5,
+        _E_NUM_PROG
+    };
+    struct HostReadSlot {
+        uint32_t offset;  // in hostReadBatch
+        uint32_t size;
+    };
+    static constexpr const char* HOST_READ_BATCH = "hostReadBatch";
+    static constexpr const char* CHECKPOINT_SAVE = "checkpointSave";
+    static constexpr const char* CHECKPOINT_RESTORE = "checkpointRestore";
     static constexpr int INIT_PROGRAM = 0;
     static constexpr int EVAL_PROGRAM = 1;
     RuntimeConfig cfg;
@@ -137,15 +226,36 @@ private:
     std::unique_ptr<poplar::ComputeSet> initializer;
 
     std::unordered_map<TensorId, poplar::Tensor> tensors;
+    VlBspCheckpoint checkpoint;  // Every allocated tensor, also when only running the graph
     std::unordered_map<std::string, std::unique_ptr<HostBuffer>> hbuffers;
+    // host read tensors, in the order of createHostRead, and their place in the batch
+    std::vector<poplar::Tensor> hostReadTensors;
+    std::unordered_map<std::string, HostReadSlot> hostReadSlots;
+    std::vector<uint32_t> hostReadBatch;  // filled by the hostReadBatch copy of every run
+    // host write handle -> host read handle of the same tensor, see pairHostReadWrite
+    std::unordered_map<std::string, std::string> hostWriteToRead;
     std::unordered_map<TensorId, TensorId> nextToCurrent;
+    // high-fanout exchange sources, see addBroadcastTarget, and the relays that carry
+    // them to other IPUs
+    std::vector<TensorId> broadcastSources;
+    std::unordered_map<TensorId, std::vector<TensorId>> broadcastTargets;
+    std::vector<std::pair<TensorId, TensorId>> relays;  // (source, relay)
+    // exchange and dpiExchange destinations, not part of the state of a cycle
+    std::unordered_set<TensorId> overwritten;
 
     std::unordered_map<std::string, poplar::VertexRef> vertices;
+    // condeval vertex id -> its twin in the workload, see VL_FUSED_COND
+    std::unordered_map<unsigned, poplar::VertexRef> condevalTwins;
 
     // std::unordered_map<std::string, std::string> currentToNext;
 
     std::vector<poplar::Tensor> hostRequest;
     poplar::Tensor interruptCond;
+    // --trace, change buffers of the BSP classes and their sizes, in the order of
+    // addTraceBuffer, and the condition to drain them
+    std::vector<TensorId> traceBuffers;
+    std::vector<uint32_t> traceBufferSizes;
+    poplar::Tensor traceRequest;
     poplar::program::Sequence initCopies;
     poplar::program::Sequence constInitCopies;
     poplar::program::Sequence exchangeCopies;
@@ -163,6 +273,7 @@ private:
         return tensors[tid];
     }
     poplar::Tensor addTensor(uint32_t size, const TensorId& name);
+    void addBroadcastCopies();
     void dumpCycleTrace(std::ostream& os);
 public:
     void init(int argc, char* argv[]);
@@ -170,16 +281,23 @@ public:
     void buildReEntrant();
     void run();
     void runReEntrant();
+    void saveCheckpoint(const std::string& path);
+    void restoreCheckpoint(const std::string& path);
     void addCopy(const TensorId& from, const TensorId& to, uint32_t size, const std::string& kind);
     void addNextCurrentPair(const TensorId& next, const TensorId& current, uint32_t size);
+    void addRelay(const TensorId& source, const TensorId& relay, uint32_t size, uint32_t tileId);
+    void addBroadcastTarget(const TensorId& source, const TensorId& target, uint32_t size);
 
 
     void setTileMapping(poplar::VertexRef& vtxRef, uint32_t tileId);
     void setTileMapping(poplar::Tensor& tensor, uint32_t tileId);
     void connect(poplar::VertexRef& vtxRef, const std::string& vtxField, poplar::Tensor& tensor);
     void isHostRequest(poplar::Tensor& tensor, bool isInterruptCond);
+    void addTraceBuffer(const TensorId& name, uint32_t size);
+    void isTraceRequest(poplar::Tensor& tensor);
     void createHostRead(const std::string& handleName, poplar::Tensor& tensor, uint32_t numElems);
     void createHostWrite(const std::string& handleName, poplar::Tensor& tensor, uint32_t numElems);
+    void pairHostReadWrite(const std::string& readHandle, const std::string& writeHandle);
     void setPerfEstimate(poplar::VertexRef&, int) {}
     poplar::VertexRef getOrAddVertex(const std::string& name, const std::string& where);
 
@@ -195,7 +313,12 @@ public:
             std::cerr << "Can not find host handle " << handle << std::endl;
             std::exit(EXIT_FAILURE);
         }
-        if (it->second->buff.size() == 1) {
+        auto slotIt = hostReadSlots.find(handle);
+        if (slotIt != hostReadSlots.end()) {
+            // already on the host, see hostReadBatch
+            std::copy_n(hostReadBatch.data() + slotIt->second.offset, slotIt->second.size,
+                        it->second->buff.data());
+        } else if (it->second->buff.size() == 1) {
             // hacky stuff to handle padded uint32_t values
             std::array<uint32_t, 2> v;
             engine->readTensor(handle, v.data(), v.data() + 2);
@@ -225,6 +348,12 @@ public:
         } else {
             engine->writeTensor(handle, datap, datap + it->second->buff.size());
         }
+        // keep the batched copy of the same tensor coherent for later reads
+        const auto pairIt = hostWriteToRead.find(handle);
+        if (pairIt != hostWriteToRead.end()) {
+            const HostReadSlot& slot = hostReadSlots.at(pairIt->second);
+            std::copy_n(datap, slot.size, hostReadBatch.data() + slot.offset);
+        }
     }
 };
 
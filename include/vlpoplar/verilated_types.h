@@ -29,11 +29,17 @@
 #endif
 
 #include <array>
+#ifndef VL_BSP_CPU
 #include <ipu_intrinsics>
+#endif
 
 // extra types
 #include "vlpoplar/verilated_ipu_types.h"
+#ifdef VL_BSP_CPU
+#include "vlpoplar/verilated_bsp_cpu.h"
+#else
 #include <poplar/Vertex.hpp>
+#endif
 
 using Vec   = poplar::InOut<poplar::Vector<IData, poplar::VectorLayout::COMPACT_PTR, alignof(QData)>>;
 using VecIn = poplar::Input<poplar::Vector<IData, poplar::VectorLayout::COMPACT_PTR, alignof(QData)>>;
@@ -179,6 +185,9 @@ public:
     bool empty() const { return !any(); }
 
     void set(uint32_t index, bool value) { m_flags[index] = value; }
+    void thisOr(const VlTriggerVec<T_size>& other) {
+        for (size_t i = 0; i < T_size; ++i) m_flags[i] = m_flags[i] | other.m_flags[i];
+    }
 };
 
 
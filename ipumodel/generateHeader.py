@@ -52,6 +52,8 @@ class CostFit:
         self.df['RWords'] = [int(np.ceil(x / 32)) for x in self.df['RBits']]
         self.codeGen = {}
         self.anyCode = {}
+        self.anyCost = {}
+        self.table = []
         # print(self.df)
 
     def saveResult(self, node: str, text: str):
@@ -71,6 +73,7 @@ class CostFit:
         if widthInfo == "" or widthInfo == "___":
             code = CostFit.mkFormula(widthInfo, [], np.mean(ys))
             self.saveResult(node, code)
+            self.saveRow(node, "___", "lin", [0.0, 0.0, 0.0, mean], 0.0)
             return
 
         assert len(widthInfo) == 3, f"invalid width pattern {widthInfo}"
@@ -84,6 +87,9 @@ class CostFit:
         reg = LinearRegression().fit(xs, ys)
         code = CostFit.mkFormula(widthInfo, reg.coef_, reg.intercept_, mean)
         self.saveResult(node, code)
+        coefs = iter(reg.coef_)
+        slopes = [next(coefs) if c != "_" else 0.0 for c in widthInfo]
+        self.saveRow(node, widthInfo, "lin", slopes + [reg.intercept_], mean)
 
     def cubeWide(self, node: str, name: str):
         data = self.df.loc[self.df["Func"] == name]
@@ -93,10 +99,26 @@ class CostFit:
         c3, c2, c1, c0 = np.polyfit(xs, ys, deg=3)
         text = f"if(nodep->isWide()) return set({c3:0.2f} * nodep->widthWords() * nodep->widthWords() * nodep->widthWords() + {c2:0.2f} * nodep->widthWords() * nodep->widthWords() + {c1: 0.2f} * nodep->widthWords() + {c0:0.2f});"
         self.saveResult(node, text)
+        self.saveRow(node, "W__", "cube", [c3, c2, c1, c0], 0.0)
+
+    def saveRow(self, node: str, widthInfo: str, kind: str, coefs, mean: float):
+        self.table.append((node.upper(), widthInfo, kind, coefs, mean))
+
+    def emitTable(self):
+        # see V3BspCostModel.h for the format
+        text = "# node pattern kind coefficients mean\n"
+        for (node, widthInfo, kind, coefs, mean) in self.table:
+            coefText = " ".join([f"{c:0.4f}" for c in coefs])
+            text += f"{node} {widthInfo} {kind} {coefText} {mean:0.4f}\n"
+        # the anyCode fallbacks come last, so they only apply when no fitted row matches
+        for (node, cost) in self.anyCost.items():
+            text += f"{node.upper()} ___ lin 0.0000 0.0000 0.0000 {cost:0.4f} 0.0000\n"
+        return text
 
     def fallback(self, node: str, cost: int):
         if not node in self.anyCode:
             self.anyCode[node] = f"return set({cost});"
+            self.anyCost[node] = cost
     def emit(self):
 
         text = ""
@@ -116,9 +138,12 @@ class CostFit:
 
 if __name__ == "__main__":
 
-    dfFileName = "profile.txt"
-
+    argParser = argparse.ArgumentParser("Fit a cost model to the profiled operations")
+    argParser.add_argument("--profile", "-p", type=str, default="profile.txt", help="profile data from generateProfile.py")
+    argParser.add_argument("--table", "-t", type=str, default=None, help="write a coefficient table for --bsp-cost-model instead of the header")
+    args = argParser.parse_args()
 
+    dfFileName = args.profile
 
     fitter = CostFit(pd.read_table(dfFileName, delim_whitespace=True))
 
@@ -247,6 +272,11 @@ if __name__ == "__main__":
 
 
     # fitter.line("A")
+    if args.table:
+        with open(args.table, 'w') as fp:
+            fp.write(fitter.emitTable())
+        exit(0)
+
     COST_MODEL_NAME = "IpuCostModelLinReg"
     with open(f"../src/V3Bsp{COST_MODEL_NAME}.h", 'w') as fp:
         fp.write(f"""
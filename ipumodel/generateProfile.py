@@ -5,6 +5,7 @@ import argparse
 from pathlib import Path
 import subprocess
 import multiprocessing
+import os
 import typing
 import pandas as pd
 
@@ -12,6 +13,9 @@ REPEATS = 64
 MUL_W_REPEATS = 16
 SUPERVISOR = False
 BUILD_TIMEOUT = 30 # 30 second
+# Time the kernels on the host CPU instead of the IPU (--host). This is passed through
+# the environment so that the spawned build jobs see it as well.
+HOST = os.environ.get("VL_PROFILE_HOST", "0") == "1"
 
 class VlFunc:
     def __init__(self, name: str, func: str = None):
@@ -52,6 +56,65 @@ class VertexGenerator:
     def name(self):
         return "VTX_" + self.vlOp.name
 
+    def emitHost(self):
+
+        # The --bsp-cpu codelets are built from the vlpoplar runtime with VL_BSP_CPU, so
+        # time that implementation rather than the one of the standard runtime
+        text = f"""
+#include "vlpoplar/verilated.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#ifdef __x86_64__
+#include <x86intrin.h>
+#endif
+
+static inline uint64_t timeNow() {{
+#ifdef __x86_64__
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}}
+
+static uint32_t in1[{self.repeats * 32}], in2[{self.repeats * 32}], out[{self.repeats * 32}];
+
+__attribute__((noinline)) static uint64_t compute() {{
+    constexpr int obits = {self.obits};
+    constexpr int lbits = {self.lbits};
+    constexpr int rbits = {self.rbits};
+    constexpr int words = VL_WORDS_I(obits);
+    const uint64_t start = timeNow();
+    for (int i = 0; i < {self.repeats}; i++) {{
+        const {self.ltype}& lp = reinterpret_cast<const {self.ltype}*>(in1)[i];
+        const {self.rtype}& rp = reinterpret_cast<const {self.rtype}*>(in2)[i];
+        {self.otype}& op = reinterpret_cast<{self.otype}*>(out)[i];
+        {self.vlOp.func};
+        asm volatile("" : : "r"(&op) : "memory");
+    }}
+    const uint64_t end = timeNow();
+    return (end - start) / {self.repeats};
+}}
+
+int main() {{
+    std::mt19937 gen{{7182931}};
+    for (int i = 0; i < {self.repeats * 32}; i++) {{
+        in1[i] = gen();
+        in2[i] = gen();
+    }}
+    // keep the fastest of many trials, the others are polluted by cold caches and interrupts
+    uint64_t best = compute();
+    for (int t = 0; t < 256; t++) {{
+        const uint64_t d = compute();
+        if (d < best) best = d;
+    }}
+    std::printf("{self.name()}.cycles: %lu\\n", static_cast<unsigned long>(best));
+    return 0;
+}}
+"""
+        return text
+
     def emit(self):
 
         vertexType = "SupervisorVertex" if self.supervisor else "Vertex"
@@ -101,13 +164,16 @@ struct {self.name()} : public {vertexType} {{
 
     def build(self) -> Path:
 
-        cppFile = Path("funcs") / f"{self.vlOp.name}.cpp"
+        ext = ".host" if HOST else ""
+        cppFile = Path("funcs") / f"{self.vlOp.name}{ext}.cpp"
         if not cppFile.exists():
             with open(cppFile, 'w') as fp:
                     print(f"Generating code {self.name()}")
-                    text = self.emit()
+                    text = self.emitHost() if HOST else self.emit()
                     fp.write(text)
         mkCmd = ["make", f"funcs/{self.vlOp.name}.gp", f"funcs/{self.vlOp.name}.s"]
+        if HOST:
+            mkCmd = ["make", f"funcs/{self.vlOp.name}.host"]
         print(f"Compiling {self.name()}")
         self.path = None
         try:
@@ -118,7 +184,7 @@ struct {self.name()} : public {vertexType} {{
             else:
                 print(f"Finished compiling {self.name()}")
             proc = subprocess.run(mkCmd, check=False, capture_output=True, text=True, timeout=BUILD_TIMEOUT)
-            self.path = Path("funcs") / f"{self.vlOp.name}.gp"
+            self.path = Path("funcs") / (f"{self.vlOp.name}.host" if HOST else f"{self.vlOp.name}.gp")
         except subprocess.TimeoutExpired as e:
                 print(str(e))
                 print(f"Build time out for {self.name()}!")
@@ -143,8 +209,13 @@ if __name__ == "__main__":
     argParser.add_argument("--output", "-o", type=Path, default=Path("profile.txt"), help="output file")
     argParser.add_argument("--num", "-n", type=int, default=50, help="Number of random cases")
     argParser.add_argument("--append", "-a", action="store_true", default=False, help="Append to the output")
+    argParser.add_argument("--host", action="store_true", default=False, help="Profile the host CPU instead of the IPU")
     args = argParser.parse_args()
 
+    if args.host:
+        HOST = True
+        os.environ["VL_PROFILE_HOST"] = "1"
+
     Jobs = args.jobs
     Outfile = args.output
     NumRand = args.num
@@ -223,7 +294,9 @@ if __name__ == "__main__":
 
     print("Done")
     def saveData(name: str, obits: int, lbits: int, rbits: int, cycles: int):
-        df.loc[len(df)] = [name, obits, lbits, rbits, cycles, SUPERVISOR]
+        # host cycles are not interleaved with other worker contexts, record them as
+        # supervisor cycles so that generateHeader.py does not rescale them
+        df.loc[len(df)] = [name, obits, lbits, rbits, cycles, SUPERVISOR or HOST]
         df.to_string(Outfile)
 
     def runCases(fn, widthCases, funcName: str):
@@ -260,16 +333,27 @@ if __name__ == "__main__":
 
 
         print(f"Profiling {funcName}")
-        cmd = ["./runner", "-r", str(REPEATS), "-v"] + \
-                       [g.name() for g in ls] + \
-                        ["-f"] +  [str(g.path) for g in ls]
-        print(" ".join(cmd))
-        proc = subprocess.run(cmd,
-                        text=True, capture_output=True, check=False)
-        if (proc.returncode != 0):
-            print(proc.stderr)
-            exit(-1)
-        lines = proc.stdout.strip().split('\n')
+        if HOST:
+            # every host kernel is its own executable, run them one by one so that they
+            # do not compete for the same core
+            lines = []
+            for g in ls:
+                proc = subprocess.run([f"./{g.path}"], text=True, capture_output=True, check=False)
+                if (proc.returncode != 0):
+                    print(proc.stderr)
+                    exit(-1)
+                lines.append(proc.stdout.strip())
+        else:
+            cmd = ["./runner", "-r", str(REPEATS), "-v"] + \
+                           [g.name() for g in ls] + \
+                            ["-f"] +  [str(g.path) for g in ls]
+            print(" ".join(cmd))
+            proc = subprocess.run(cmd,
+                            text=True, capture_output=True, check=False)
+            if (proc.returncode != 0):
+                print(proc.stderr)
+                exit(-1)
+            lines = proc.stdout.strip().split('\n')
         print('\n'.join(lines))
         res = [int(ln.strip().split(":")[1]) for ln in lines]
 
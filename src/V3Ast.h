@@ -1280,7 +1280,9 @@ public:
         MEMBER_HOSTREQ = 32,  // is a host request
         MEMBER_HOSTANYREQ = 64,  // is any host request
         MEMBER_OPAQUE = 128,  // an opaque storage for multiple variables
-        __MEMBER_MASK_EN = (128 - 1)
+        MEMBER_TRACEBUF = 256,  // waveform change buffer, see V3BspTrace
+        MEMBER_TRACEREQ = 512,  // requests draining the change buffers
+        __MEMBER_MASK_EN = (1024 - 1)
     };
 
 private:
@@ -1309,6 +1311,8 @@ public:
     bool hasHostReq() const { return (m_flag & MEMBER_HOSTREQ); }
     bool hasAnyHostReq() const { return (m_flag & MEMBER_HOSTANYREQ); }
     bool hasOpaque() const { return (m_flag & MEMBER_OPAQUE); }
+    bool hasTraceBuf() const { return (m_flag & MEMBER_TRACEBUF); }
+    bool hasTraceReq() const { return (m_flag & MEMBER_TRACEREQ); }
 
     bool valid() const { return m_flag; }
     string ascii() const {
@@ -1321,6 +1325,8 @@ public:
         if (hasHostReq()) str += "H";
         if (hasOpaque()) str += "P";
         if (hasAnyHostReq()) str += "*";
+        if (hasTraceBuf()) str += "T";
+        if (hasTraceReq()) str += "Q";
         return str;
     }
 };
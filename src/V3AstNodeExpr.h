@@ -1902,19 +1902,24 @@ public:
 class AstTestPlusArgs final : public AstNodeExpr {
     // Search expression. If nullptr then this is a $test$plusargs instead of $value$plusargs.
     // @astgen op1 := searchp : Optional[AstNode]
+    int m_instance = -1;  // Instance of --instances whose "+<instance>:" arguments apply, or -1
 public:
     AstTestPlusArgs(FileLine* fl, AstNode* searchp)
         : ASTGEN_SUPER_TestPlusArgs(fl) {
         this->searchp(searchp);
     }
     ASTGEN_MEMBERS_AstTestPlusArgs;
+    int instance() const { return m_instance; }
+    void instance(int instance) { m_instance = instance; }
     string verilogKwd() const override { return "$test$plusargs"; }
     string emitVerilog() override { return verilogKwd(); }
     string emitC() override { return "VL_VALUEPLUSARGS_%nq(%lw, %P, nullptr)"; }
     bool isGateOptimizable() const override { return false; }
     bool isPredictOptimizable() const override { return false; }
     bool cleanOut() const override { return true; }
-    bool same(const AstNode* /*samep*/) const override { return true; }
+    bool same(const AstNode* samep) const override {
+        return instance() == static_cast<const AstTestPlusArgs*>(samep)->instance();
+    }
 };
 class AstThisRef final : public AstNodeExpr {
     // Reference to 'this'.
@@ -2021,6 +2026,7 @@ class AstValuePlusArgs final : public AstNodeExpr {
     // Search expression. If nullptr then this is a $test$plusargs instead of $value$plusargs.
     // @astgen op1 := searchp : Optional[AstNode]
     // @astgen op2 := outp : AstNode // VarRef for result
+    int m_instance = -1;  // Instance of --instances whose "+<instance>:" arguments apply, or -1
 public:
     AstValuePlusArgs(FileLine* fl, AstNode* searchp, AstNode* outp)
         : ASTGEN_SUPER_ValuePlusArgs(fl) {
@@ -2028,6 +2034,8 @@ public:
         this->outp(outp);
     }
     ASTGEN_MEMBERS_AstValuePlusArgs;
+    int instance() const { return m_instance; }
+    void instance(int instance) { m_instance = instance; }
     string verilogKwd() const override { return "$value$plusargs"; }
     string emitVerilog() override { return "%f$value$plusargs(%l, %k%r)"; }
     string emitC() override { V3ERROR_NA_RETURN(""); }
@@ -2035,7 +2043,9 @@ public:
     bool isPredictOptimizable() const override { return false; }
     bool isPure() const override { return !outp(); }
     bool cleanOut() const override { return true; }
-    bool same(const AstNode* /*samep*/) const override { return true; }
+    bool same(const AstNode* samep) const override {
+        return instance() == static_cast<const AstValuePlusArgs*>(samep)->instance();
+    }
 };
 class AstValuePlusArgsProxy final : public AstNodeExpr {
     // A proxy for an already evaluated AstValuePlusArgs. Used on an accelerartor like the IPU
@@ -1606,6 +1606,7 @@ class AstVar final : public AstNode {
     MTaskIdSet m_mtaskIds;  // MTaskID's that read or write this var
     VBspFlag m_bspFlags; // A set of flags for poplar code generation
     int m_pinNum = 0;  // For XML, if non-zero the connection pin number
+    int m_writerThread = -1;  // Thread mostly writing this var, -1 if none, see V3Partition
     bool m_ansi : 1;  // ANSI port list variable (for dedup check)
     bool m_declTyped : 1;  // Declared as type (for dedup check)
     bool m_tristate : 1;  // Inout or triwire or trireg
@@ -1647,6 +1648,7 @@ class AstVar final : public AstNode {
     bool m_isForceable : 1;  // May be forced/released externally from user C code
     bool m_isWrittenByDpi : 1;  // This variable can be written by a DPI Export
     bool m_isWrittenBySuspendable : 1;  // This variable can be written by a suspendable process
+    bool m_alignCacheLine : 1;  // Starts a cache line, see V3VariableOrder
 
     void init() {
         m_ansi = false;
@@ -1690,6 +1692,7 @@ class AstVar final : public AstNode {
         m_isForceable = false;
         m_isWrittenByDpi = false;
         m_isWrittenBySuspendable = false;
+        m_alignCacheLine = false;
         m_attrClocker = VVarAttrClocker::CLOCKER_UNKNOWN;
         m_bspFlags = VBspFlag{};
     }
@@ -1852,6 +1855,8 @@ public:
     void setWrittenByDpi() { m_isWrittenByDpi = true; }
     bool isWrittenBySuspendable() const { return m_isWrittenBySuspendable; }
     void setWrittenBySuspendable() { m_isWrittenBySuspendable = true; }
+    bool alignCacheLine() const { return m_alignCacheLine; }
+    void alignCacheLine(bool flag) { m_alignCacheLine = flag; }
 
     // METHODS
     void name(const string& name) override { m_name = name; }
@@ -1958,6 +1963,8 @@ public:
     const MTaskIdSet& mtaskIds() const { return m_mtaskIds; }
     void pinNum(int id) { m_pinNum = id; }
     int pinNum() const { return m_pinNum; }
+    void writerThread(int thread) { m_writerThread = thread; }
+    int writerThread() const { return m_writerThread; }
     VBspFlag bspFlag() const { return m_bspFlags; }
     void bspFlag(VBspFlag flag) { m_bspFlags = flag; }
 };
@@ -2809,17 +2816,23 @@ public:
     bool same(const AstNode* /*samep*/) const override { return true; }
 };
 class AstFinish final : public AstNodeStmt {
+    int m_instance = -1;  // Instance of --instances that finishes, or -1 for all
 public:
     explicit AstFinish(FileLine* fl)
         : ASTGEN_SUPER_Finish(fl) {}
     ASTGEN_MEMBERS_AstFinish;
+    int instance() const { return m_instance; }
+    void instance(int instance) { m_instance = instance; }
     bool isGateOptimizable() const override { return false; }
     bool isPredictOptimizable() const override { return false; }
     bool isPure() const override { return false; }  // SPECIAL: $display has 'visual' ordering
     bool isOutputter() const override { return true; }  // SPECIAL: $display makes output
     bool isUnlikely() const override { return true; }
     int instrCount() const override { return 0; }  // Rarely executes
-    bool same(const AstNode* samep) const override { return fileline() == samep->fileline(); }
+    bool same(const AstNode* samep) const override {
+        return fileline() == samep->fileline()
+               && instance() == static_cast<const AstFinish*>(samep)->instance();
+    }
 };
 class AstFireEvent final : public AstNodeStmt {
     // '-> _' and '->> _' event trigger statements
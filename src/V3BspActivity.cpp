@@ -0,0 +1,500 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator BSP: Skip the computation of idle partitions
+//
+// Code available from: https://verilator.org
+//
+//*************************************************************************
+//
+// Copyright 2005-2023 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+
+#include "V3BspActivity.h"
+
+#include "V3Ast.h"
+#include "V3Global.h"
+#include "V3Stats.h"
+#include "V3UniqueNames.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <unordered_map>
+
+VL_DEFINE_DEBUG_FUNCTIONS;
+
+namespace {
+
+// The seen patterns of a class are kept in a 32-bit member
+constexpr size_t MAX_PATTERN_TRIGGERS = 5;
+
+class ActivityGateVisitor final : public VNVisitor {
+private:
+    // NODE STATE
+    // AstVar::user1()      -> VarUse flags of a class member
+    // AstVar::user2p()     -> AstVarScope, change flag of the member in nbaTop
+    const VNUser1InUse m_user1InUse;
+    const VNUser2InUse m_user2InUse;
+
+    enum VarUse : int {
+        VU_MEMBER = 1,
+        VU_READ = 2,  // read by nbaTop
+        VU_BODY_WRITE = 4,  // written by nbaTop
+        VU_TRIG_WRITE = 8,  // written by triggerEval
+        VU_NEEDED = 16,  // someone needs to know when the member changes
+    };
+
+    struct ClassInfo final {
+        AstClass* classp = nullptr;
+        AstScope* scopep = nullptr;
+        AstVarScope* instVscp = nullptr;  // the instance in the top scope
+        AstCFunc* nbaTopp = nullptr;
+        AstCFunc* trigEvalp = nullptr;
+        std::unordered_map<const AstVar*, AstVarScope*> memberVscps;
+        std::vector<AstVar*> membersp;  // in declaration order
+        std::vector<AstNodeAssign*> arrayWritesp;  // element writes of unpacked members
+        std::map<uint32_t, AstCMethodHard*> trigAtsp;  // trigger index -> trig.at(index)
+        bool tracked = false;
+        bool gatable = true;  // every input of nbaTop comes from a tracked class
+        bool gated = false;
+        // filled in by instrument()
+        std::vector<AstNode*> declsp;  // new locals of nbaTop
+        AstNode* headp = nullptr;  // statements before the gated body
+    };
+
+    // A source class telling a reader class whether the members it receives changed
+    struct ActivityPair final {
+        ClassInfo* sourcep = nullptr;
+        ClassInfo* targetp = nullptr;
+        std::vector<AstVar*> sourceVarsp;  // members of the source used by the target
+        AstVarScope* outVscp = nullptr;  // activity flag in the source
+        AstVarScope* inVscp = nullptr;  // activity flag in the target
+    };
+
+    // STATE
+    V3UniqueNames m_newNames{"__Vbspact"};
+    AstCFunc* m_exchangep = nullptr;
+    std::vector<std::unique_ptr<ClassInfo>> m_infosp;
+    std::unordered_map<const AstClass*, ClassInfo*> m_classInfo;
+    std::vector<ActivityPair> m_pairs;
+
+    VDouble0 m_statsTracked;
+    VDouble0 m_statsGated;
+    VDouble0 m_statsFlags;
+
+    // METHODS
+    static bool comparable(const AstNodeDType* dtypep) {
+        return dtypep->skipRefp()->isIntegralOrPacked();
+    }
+    static bool comparableArray(const AstNodeDType* dtypep) {
+        const AstNodeDType* elemp = dtypep->skipRefp();
+        if (!VN_IS(elemp, UnpackArrayDType)) return false;
+        while (const AstUnpackArrayDType* const arrayp = VN_CAST(elemp, UnpackArrayDType)) {
+            elemp = arrayp->subDTypep()->skipRefp();
+        }
+        return elemp->isIntegralOrPacked();
+    }
+    static AstClass* getClass(AstMemberSel* mselp) {
+        return VN_AS(VN_AS(mselp->fromp(), VarRef)->varp()->dtypep(), ClassRefDType)->classp();
+    }
+
+    AstNodeExpr* mkOr(FileLine* flp, const std::vector<AstNodeExpr*>& termsp) {
+        if (termsp.empty()) return new AstConst{flp, AstConst::BitFalse{}};
+        AstNodeExpr* orp = termsp.front();
+        for (size_t ix = 1; ix < termsp.size(); ++ix) orp = new AstOr{flp, orp, termsp[ix]};
+        return orp;
+    }
+    AstVarRef* mkRef(AstVarScope* vscp, VAccess access) {
+        return new AstVarRef{vscp->fileline(), vscp, access};
+    }
+    AstMemberSel* mkMemberSel(AstVarScope* vscp, AstVarScope* instp, VAccess access) {
+        AstMemberSel* const selp
+            = new AstMemberSel{vscp->fileline(), new AstVarRef{vscp->fileline(), instp, access},
+                               VFlagChildDType{}, vscp->varp()->name()};
+        selp->varp(vscp->varp());
+        selp->dtypeFrom(vscp->varp());
+        return selp;
+    }
+    AstVarScope* newLocal(ClassInfo& info, const string& name, AstNodeDType* dtypep) {
+        FileLine* const flp = info.nbaTopp->fileline();
+        AstVar* const varp = new AstVar{flp, VVarType::MEMBER, m_newNames.get(name), dtypep};
+        varp->funcLocal(true);
+        varp->lifetime(VLifetime::AUTOMATIC);
+        info.declsp.push_back(varp);
+        AstVarScope* const vscp = new AstVarScope{flp, info.scopep, varp};
+        info.scopep->addVarsp(vscp);
+        return vscp;
+    }
+    AstVarScope* newMember(ClassInfo& info, const string& name, AstNodeDType* dtypep,
+                           VBspFlag flag) {
+        FileLine* const flp = info.classp->fileline();
+        AstVar* const varp = new AstVar{flp, VVarType::MEMBER, m_newNames.get(name), dtypep};
+        varp->lifetime(VLifetime::STATIC);
+        varp->bspFlag(flag);
+        info.classp->addStmtsp(varp);
+        AstVarScope* const vscp = new AstVarScope{flp, info.scopep, varp};
+        info.scopep->addVarsp(vscp);
+        return vscp;
+    }
+    static void addStmt(AstNode*& listp, AstNode* stmtp) {
+        listp = AstNode::addNext(listp, stmtp);
+    }
+
+    // Find the functions and members of a class and decide whether it can be tracked
+    void analyze(ClassInfo& info) {
+        AstClass* const classp = info.classp;
+        for (AstNode* nodep = classp->stmtsp(); nodep; nodep = nodep->nextp()) {
+            if (AstVar* const varp = VN_CAST(nodep, Var)) {
+                varp->user1(VU_MEMBER);
+                info.membersp.push_back(varp);
+            } else if (AstScope* const scopep = VN_CAST(nodep, Scope)) {
+                info.scopep = scopep;
+            }
+        }
+        UASSERT_OBJ(info.scopep, classp, "class without scope");
+        for (AstVarScope* vscp = info.scopep->varsp(); vscp;
+             vscp = VN_AS(vscp->nextp(), VarScope)) {
+            info.memberVscps.emplace(vscp->varp(), vscp);
+        }
+        for (AstNode* nodep = info.scopep->blocksp(); nodep; nodep = nodep->nextp()) {
+            AstCFunc* const funcp = VN_CAST(nodep, CFunc);
+            if (!funcp) continue;
+            if (funcp->name() == "nbaTop") info.nbaTopp = funcp;
+            if (funcp->name() == "triggerEval") info.trigEvalp = funcp;
+        }
+        if (!info.nbaTopp || !info.trigEvalp || !info.nbaTopp->argsp()) {
+            UINFO(4, "Not tracking " << classp->prettyNameQ() << ", no nbaTop" << endl);
+            return;
+        }
+        // DPI calls, $display, $finish and friends have to run every time
+        if (info.nbaTopp->exists([](const AstNode* nodep) {
+                return !nodep->isPure() || nodep->isOutputter() || VN_IS(nodep, NodeCCall);
+            })) {
+            UINFO(4, "Not tracking " << classp->prettyNameQ() << ", impure nbaTop" << endl);
+            return;
+        }
+        bool ok = true;
+        size_t arrayRefs = 0;
+        const AstVar* const trigArgp = VN_AS(info.nbaTopp->argsp(), Var);
+        info.nbaTopp->foreach([&](AstNodeVarRef* refp) {
+            AstVar* const varp = refp->varp();
+            if (!(varp->user1() & VU_MEMBER)) return;
+            if (refp->access().isReadOrRW()) varp->user1(varp->user1() | VU_READ);
+            if (!refp->access().isWriteOrRW()) return;
+            varp->user1(varp->user1() | VU_BODY_WRITE);
+            if (comparableArray(varp->dtypep())) {
+                ++arrayRefs;
+            } else if (!comparable(varp->dtypep())) {
+                UINFO(4, "Not tracking " << classp->prettyNameQ() << ", writes "
+                                         << varp->prettyNameQ() << endl);
+                ok = false;
+            }
+        });
+        // Every write to an unpacked member should be an element assignment, so we can
+        // compare the element before and after
+        info.nbaTopp->foreach([&](AstNodeAssign* assignp) {
+            const AstNodeVarRef* const vrefp = VN_CAST(
+                AstArraySel::baseFromp(assignp->lhsp(), false), NodeVarRef);
+            if (!vrefp || !(vrefp->varp()->user1() & VU_MEMBER)
+                || !comparableArray(vrefp->varp()->dtypep())) {
+                return;
+            }
+            AstNodeExpr* elemp = assignp->lhsp();
+            while (AstSel* const selp = VN_CAST(elemp, Sel)) elemp = selp->fromp();
+            if (VN_IS(elemp, ArraySel) && comparable(elemp->dtypep())) {
+                info.arrayWritesp.push_back(assignp);
+            }
+        });
+        if (arrayRefs != info.arrayWritesp.size()) {
+            UINFO(4, "Not tracking " << classp->prettyNameQ()
+                                     << ", unpacked member written as a whole" << endl);
+            ok = false;
+        }
+        info.trigEvalp->foreach([&](AstNodeVarRef* refp) {
+            AstVar* const varp = refp->varp();
+            if (!(varp->user1() & VU_MEMBER) || !refp->access().isWriteOrRW()) return;
+            varp->user1(varp->user1() | VU_TRIG_WRITE);
+            if (!comparable(varp->dtypep())) {
+                UINFO(4, "Not tracking " << classp->prettyNameQ() << ", triggerEval writes "
+                                         << varp->prettyNameQ() << endl);
+                ok = false;
+            }
+        });
+        info.nbaTopp->foreach([&](AstCMethodHard* callp) {
+            const AstVarRef* const fromp = VN_CAST(callp->fromp(), VarRef);
+            const AstConst* const indexp = VN_CAST(callp->pinsp(), Const);
+            if (callp->name() == "at" && fromp && fromp->varp() == trigArgp && indexp) {
+                info.trigAtsp.emplace(indexp->toUInt(), callp);
+            }
+        });
+        info.tracked = ok;
+    }
+
+    // The bit of the current trigger pattern in the seen mask
+    AstNodeExpr* mkPatternBit(ClassInfo& info) {
+        FileLine* const flp = info.nbaTopp->fileline();
+        AstNodeExpr* patternp = nullptr;
+        for (const auto& pair : info.trigAtsp) {
+            AstNodeExpr* const atp = pair.second->cloneTree(false);
+            patternp = patternp ? new AstConcat{flp, atp, patternp} : atp;
+        }
+        AstConst* const onep = new AstConst{flp, AstConst::WidthedValue{}, 32, 1};
+        if (!patternp) return onep;
+        return new AstShiftL{flp, onep, patternp, 32};
+    }
+
+    // Compare the members of the class before and after they are written, and skip
+    // the body of nbaTop if possible
+    void instrument(ClassInfo& info) {
+        AstCFunc* const nbaTopp = info.nbaTopp;
+        FileLine* const flp = nbaTopp->fileline();
+        AstNode* preBodyp = nullptr;  // snapshots
+        AstNode* postBodyp = nullptr;  // comparisons
+        std::vector<AstNodeExpr*> bodyChangesp;
+        std::vector<AstNodeExpr*> inputChangesp;
+        for (AstVar* const varp : info.membersp) {
+            const int flags = varp->user1();
+            const bool needed = (flags & VU_NEEDED) || info.gated;
+            if (!needed || !(flags & (VU_BODY_WRITE | VU_TRIG_WRITE))) continue;
+            if (!(flags & VU_NEEDED) && !(flags & VU_BODY_WRITE) && !(flags & VU_READ)) {
+                continue;  // only triggerEval writes it and nobody cares
+            }
+            AstVarScope* const vscp = info.memberVscps.at(varp);
+            AstVarScope* const chgVscp
+                = newLocal(info, varp->name() + "__chg", nbaTopp->findBitDType());
+            varp->user2p(chgVscp);
+            addStmt(info.headp, new AstAssign{flp, mkRef(chgVscp, VAccess::WRITE),
+                                              new AstConst{flp, AstConst::BitFalse{}}});
+            if (flags & VU_TRIG_WRITE) {
+                // triggerEval ran right before nbaTop, compare against the value we
+                // saw last time
+                AstVarScope* const prevVscp
+                    = newMember(info, varp->name() + "__prev", varp->dtypep(),
+                                {VBspFlag::MEMBER_LOCAL});
+                addStmt(info.headp,
+                        new AstAssign{flp, mkRef(chgVscp, VAccess::WRITE),
+                                      new AstNeq{flp, mkRef(vscp, VAccess::READ),
+                                                 mkRef(prevVscp, VAccess::READ)}});
+                addStmt(info.headp, new AstAssign{flp, mkRef(prevVscp, VAccess::WRITE),
+                                                  mkRef(vscp, VAccess::READ)});
+                if (flags & VU_READ) inputChangesp.push_back(mkRef(chgVscp, VAccess::READ));
+            }
+            if (!(flags & VU_BODY_WRITE)) continue;
+            bodyChangesp.push_back(mkRef(chgVscp, VAccess::READ));
+            if (comparableArray(varp->dtypep())) continue;  // see below
+            AstVarScope* const snapVscp = newLocal(info, varp->name() + "__snap", varp->dtypep());
+            addStmt(preBodyp, new AstAssign{flp, mkRef(snapVscp, VAccess::WRITE),
+                                            mkRef(vscp, VAccess::READ)});
+            addStmt(postBodyp,
+                    new AstAssign{flp, mkRef(chgVscp, VAccess::WRITE),
+                                  new AstOr{flp, mkRef(chgVscp, VAccess::READ),
+                                            new AstNeq{flp, mkRef(vscp, VAccess::READ),
+                                                       mkRef(snapVscp, VAccess::READ)}}});
+        }
+        // unpacked members, compare the written element:
+        //      old = arr[i]; arr[i] = v; chg = chg | (arr[i] != old);
+        for (AstNodeAssign* const assignp : info.arrayWritesp) {
+            const AstNodeVarRef* const vrefp = VN_AS(
+                AstArraySel::baseFromp(assignp->lhsp(), false), NodeVarRef);
+            AstVarScope* const chgVscp = VN_CAST(vrefp->varp()->user2p(), VarScope);
+            if (!chgVscp) continue;  // not needed
+            AstNodeExpr* elemp = assignp->lhsp();
+            while (AstSel* const selp = VN_CAST(elemp, Sel)) elemp = selp->fromp();
+            AstNodeExpr* const readp = elemp->cloneTree(false);
+            readp->foreach([](AstNodeVarRef* refp) { refp->access(VAccess::READ); });
+            AstVarScope* const oldVscp = newLocal(info, "elem", elemp->dtypep());
+            assignp->addHereThisAsNext(
+                new AstAssign{flp, mkRef(oldVscp, VAccess::WRITE), readp->cloneTree(false)});
+            assignp->addNextHere(new AstAssign{
+                flp, mkRef(chgVscp, VAccess::WRITE),
+                new AstOr{flp, mkRef(chgVscp, VAccess::READ),
+                          new AstNeq{flp, readp, mkRef(oldVscp, VAccess::READ)}}});
+        }
+
+        // everything but the declarations is the body
+        AstNode* bodyp = nullptr;
+        for (AstNode *nodep = nbaTopp->stmtsp(), *nextp; nodep; nodep = nextp) {
+            nextp = nodep->nextp();
+            if (VN_IS(nodep, Var)) continue;
+            addStmt(bodyp, nodep->unlinkFrBack());
+        }
+        if (preBodyp && bodyp) bodyp = preBodyp->addNext(bodyp);
+        if (postBodyp) addStmt(bodyp, postBodyp);
+
+        if (info.gated) {
+            for (ActivityPair& pair : m_pairs) {
+                if (pair.targetp != &info) continue;
+                pair.inVscp = newMember(info, "activityIn", nbaTopp->findBitDType(),
+                                        {VBspFlag::MEMBER_INPUT});
+                inputChangesp.push_back(mkRef(pair.inVscp, VAccess::READ));
+            }
+            // Members start zeroed, but initialize may have changed the inputs, so forget
+            // the seen patterns on the first evaluation
+            AstVarScope* const ranVscp
+                = newMember(info, "ran", nbaTopp->findBitDType(), {VBspFlag::MEMBER_LOCAL});
+            inputChangesp.push_back(new AstNot{flp, mkRef(ranVscp, VAccess::READ)});
+            AstNodeDType* const seenDTypep
+                = nbaTopp->findLogicDType(32, 32, VSigning::UNSIGNED);
+            AstVarScope* const seenVscp
+                = newMember(info, "seen", seenDTypep, {VBspFlag::MEMBER_LOCAL});
+            addStmt(info.headp,
+                    new AstIf{flp, mkOr(flp, inputChangesp),
+                              new AstAssign{flp, mkRef(seenVscp, VAccess::WRITE),
+                                            new AstConst{flp, AstConst::WidthedValue{}, 32, 0}},
+                              nullptr});
+            addStmt(info.headp, new AstAssign{flp, mkRef(ranVscp, VAccess::WRITE),
+                                              new AstConst{flp, AstConst::BitTrue{}}});
+            AstNode* const updatep = new AstIf{
+                flp, mkOr(flp, bodyChangesp),
+                new AstAssign{flp, mkRef(seenVscp, VAccess::WRITE),
+                              new AstConst{flp, AstConst::WidthedValue{}, 32, 0}},
+                new AstAssign{flp, mkRef(seenVscp, VAccess::WRITE),
+                              new AstOr{flp, mkRef(seenVscp, VAccess::READ),
+                                        mkPatternBit(info)}}};
+            addStmt(bodyp, updatep);
+            AstNodeExpr* const seenBitp
+                = new AstAnd{flp, mkRef(seenVscp, VAccess::READ), mkPatternBit(info)};
+            bodyp = new AstIf{
+                flp,
+                new AstEq{flp, seenBitp, new AstConst{flp, AstConst::WidthedValue{}, 32, 0}},
+                bodyp, new AstCStmt{flp, "VL_BSP_ACTIVITY_SKIP();\n"}};
+            ++m_statsGated;
+        }
+        ++m_statsTracked;
+
+        AstNode* const declsp = nbaTopp->stmtsp() ? nbaTopp->stmtsp()->unlinkFrBackWithNext()
+                                                  : nullptr;
+        for (AstNode* const declp : info.declsp) nbaTopp->addStmtsp(declp);
+        if (declsp) nbaTopp->addStmtsp(declsp);
+        if (info.headp) nbaTopp->addStmtsp(info.headp);
+        if (bodyp) nbaTopp->addStmtsp(bodyp);
+    }
+
+    // Tell each gated reader whether the members it receives from this class changed
+    void addActivityOutputs(ClassInfo& info) {
+        FileLine* const flp = info.nbaTopp->fileline();
+        for (ActivityPair& pair : m_pairs) {
+            if (pair.sourcep != &info) continue;
+            std::vector<AstNodeExpr*> changesp;
+            for (AstVar* const varp : pair.sourceVarsp) {
+                if (AstVarScope* const chgVscp = VN_CAST(varp->user2p(), VarScope)) {
+                    changesp.push_back(mkRef(chgVscp, VAccess::READ));
+                }
+            }
+            AstVarScope* const outVscp
+                = newMember(info, "activityOut", info.nbaTopp->findBitDType(),
+                            {VBspFlag::MEMBER_OUTPUT});
+            info.nbaTopp->addStmtsp(
+                new AstAssign{flp, mkRef(outVscp, VAccess::WRITE), mkOr(flp, changesp)});
+            pair.outVscp = outVscp;
+        }
+    }
+
+    void visit(AstNode* nodep) override {}
+
+public:
+    explicit ActivityGateVisitor(AstNetlist* netlistp) {
+        AstNode::user1ClearTree();
+        AstNode::user2ClearTree();
+        AstScope* const topScopep = netlistp->topScopep()->scopep();
+        for (AstVarScope* vscp = topScopep->varsp(); vscp; vscp = VN_AS(vscp->nextp(), VarScope)) {
+            AstClassRefDType* const dtypep = VN_CAST(vscp->varp()->dtypep(), ClassRefDType);
+            if (!dtypep) continue;
+            AstClass* const classp = dtypep->classp();
+            if (!classp->flag().isBsp() || classp->flag().isBspInit()
+                || classp->flag().isBspCond()) {
+                continue;
+            }
+            m_infosp.emplace_back(new ClassInfo);
+            ClassInfo& info = *m_infosp.back();
+            info.classp = classp;
+            info.instVscp = vscp;
+            m_classInfo.emplace(classp, &info);
+        }
+        for (AstNode* nodep = topScopep->blocksp(); nodep; nodep = nodep->nextp()) {
+            AstCFunc* const funcp = VN_CAST(nodep, CFunc);
+            if (funcp && funcp->name() == "exchange") m_exchangep = funcp;
+        }
+        UASSERT(m_exchangep, "could not find exchange");
+
+        for (const auto& infop : m_infosp) analyze(*infop);
+
+        // Group the copies of exchange by source and target
+        std::map<std::pair<size_t, size_t>, size_t> pairIndex;
+        std::unordered_map<const ClassInfo*, size_t> infoIndex;
+        for (size_t ix = 0; ix < m_infosp.size(); ++ix) infoIndex.emplace(m_infosp[ix].get(), ix);
+        for (AstNode* nodep = m_exchangep->stmtsp(); nodep; nodep = nodep->nextp()) {
+            AstAssign* const copyp = VN_AS(nodep, Assign);
+            AstMemberSel* const sourcep = VN_AS(copyp->rhsp(), MemberSel);
+            AstMemberSel* const targetp = VN_AS(copyp->lhsp(), MemberSel);
+            const auto targetIt = m_classInfo.find(getClass(targetp));
+            if (targetIt == m_classInfo.end()) continue;
+            ClassInfo* const targetInfop = targetIt->second;
+            if (!(targetp->varp()->user1() & VU_READ)) continue;  // only used by triggerEval
+            const auto sourceIt = m_classInfo.find(getClass(sourcep));
+            if (sourceIt == m_classInfo.end() || !sourceIt->second->tracked) {
+                targetInfop->gatable = false;
+                continue;
+            }
+            const auto key = std::make_pair(infoIndex.at(sourceIt->second),
+                                            infoIndex.at(targetInfop));
+            const auto pair = pairIndex.emplace(key, m_pairs.size());
+            if (pair.second) m_pairs.push_back({sourceIt->second, targetInfop, {}});
+            m_pairs[pair.first->second].sourceVarsp.push_back(sourcep->varp());
+        }
+        for (const auto& infop : m_infosp) {
+            infop->gated = infop->tracked && infop->gatable
+                           && infop->trigAtsp.size() <= MAX_PATTERN_TRIGGERS;
+        }
+        // Only gated readers need activity flags
+        m_pairs.erase(std::remove_if(m_pairs.begin(), m_pairs.end(),
+                                     [](const ActivityPair& pair) {
+                                         return !pair.targetp->gated;
+                                     }),
+                      m_pairs.end());
+        for (const ActivityPair& pair : m_pairs) {
+            for (AstVar* const varp : pair.sourceVarsp) {
+                varp->user1(varp->user1() | VU_NEEDED);
+            }
+        }
+        for (const auto& infop : m_infosp) {
+            if (!infop->tracked) continue;
+            const bool sends = std::any_of(m_pairs.begin(), m_pairs.end(),
+                                           [&infop](const ActivityPair& pair) {
+                                               return pair.sourcep == infop.get();
+                                           });
+            if (infop->gated || sends) instrument(*infop);
+        }
+        for (const auto& infop : m_infosp) {
+            if (infop->tracked) addActivityOutputs(*infop);
+        }
+        for (const ActivityPair& pair : m_pairs) {
+            m_exchangep->addStmtsp(new AstAssign{
+                pair.outVscp->fileline(),
+                mkMemberSel(pair.inVscp, pair.targetp->instVscp, VAccess::WRITE),
+                mkMemberSel(pair.outVscp, pair.sourcep->instVscp, VAccess::READ)});
+            ++m_statsFlags;
+        }
+    }
+    ~ActivityGateVisitor() override {
+        V3Stats::addStat("Optimizations, ipu activity tracked classes", m_statsTracked);
+        V3Stats::addStat("Optimizations, ipu activity gated classes", m_statsGated);
+        V3Stats::addStat("Optimizations, ipu activity flags exchanged", m_statsFlags);
+    }
+};
+
+}  // namespace
+
+void V3BspActivity::gateAll(AstNetlist* netlistp) {
+    UINFO(2, __FUNCTION__ << ": " << endl);
+    { ActivityGateVisitor{netlistp}; }
+    v3Global.dumpCheckGlobalTree("bspactivity", 0, dumpTree() >= 3);
+}
@@ -0,0 +1,63 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator BSP: Skip the computation of idle partitions
+//
+// Code available from: https://verilator.org
+//
+//*************************************************************************
+//
+// Copyright 2005-2023 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+//
+// With -fipu-activity-gate, the nbaTop function of a BSP class is skipped
+// when running it can not change anything. A class is "tracked" if its
+// nbaTop is pure (no DPI, no display, no calls) and every member it writes
+// can be compared. A tracked class computes, for every reader class, a
+// single bit telling whether any of the members that reader uses changed
+// in this superstep. The bit is sent along with the members in exchange.
+//
+// A tracked class whose nbaTop inputs all come from tracked classes is also
+// "gated". It remembers the trigger patterns with which nbaTop ran without
+// changing any member since the last time one of its inputs changed. Since
+// nbaTop only depends on its members and the trigger pattern, running it
+// again with one of these patterns is a no-op and is skipped:
+//
+//     CFUNC nbaTop(trig):
+//         changed = activityIn_0 | ... | (trigWritten != prevTrigWritten)
+//         if (changed) seen = 0;
+//         if (!(seen & (1 << pattern(trig)))) {
+//              snapshot = written
+//              original nbaTop body
+//              if (written != snapshot) seen = 0;
+//              else seen |= 1 << pattern(trig);
+//         }
+//         activityOut_0 = written_0 != snapshot_0 | ...
+//
+// The triggerEval function still runs every superstep, so local clocks keep
+// toggling. The trigger pattern only contains the triggers used by nbaTop,
+// classes that use more than MAX_PATTERN_TRIGGERS of them are not gated.
+//
+//*************************************************************************
+
+#ifndef VERILATOR_V3BSPACTIVITY_H_
+#define VERILATOR_V3BSPACTIVITY_H_
+
+#include "config_build.h"
+#include "verilatedos.h"
+
+#include "V3Ast.h"
+#include "V3Error.h"
+
+//============================================================================
+
+class V3BspActivity final {
+public:
+    static void gateAll(AstNetlist* nodep);
+};
+
+#endif  // Guard
@@ -0,0 +1,143 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Data-driven cost model for BSP partitioning
+//
+// Code available from: https://verilator.org
+//
+//*************************************************************************
+//
+// Copyright 2003-2023 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+
+#include "V3BspCostModel.h"
+
+#include "V3Ast.h"
+#include "V3BspIpuCostModelLinReg.h"
+#include "V3File.h"
+#include "V3Global.h"
+#include "V3Os.h"
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+VL_DEFINE_DEBUG_FUNCTIONS;
+
+namespace {
+
+class CostTable final {
+    struct Row {
+        std::array<char, 3> m_pattern;  // I, Q, W or _ for output, lhs and rhs
+        bool m_cube;  // cubic in output words, otherwise linear in all words
+        std::array<float, 4> m_coefs;
+        float m_mean;
+    };
+    std::unordered_map<string, std::vector<Row>> m_rows;  // rows of each node type name
+
+    static bool matches(char c, const AstNode* nodep) {
+        switch (c) {
+        case '_': return true;
+        case 'I': return nodep && nodep->widthWords() == 1;
+        case 'Q': return nodep && nodep->isQuad();
+        case 'W': return nodep && nodep->isWide();
+        default: return false;
+        }
+    }
+    static float words(const AstNode* nodep) { return nodep ? nodep->widthWords() : 0; }
+    // Same as IpuCostModelGen::defaultLatency
+    static int defaultLatency(const AstNode* nodep) { return nodep->widthWords(); }
+
+public:
+    void load(const string& filename) {
+        UINFO(3, "Loading BSP cost model " << filename << endl);
+        const std::unique_ptr<std::ifstream> ifp{V3File::new_ifstream(filename)};
+        if (ifp->fail()) {
+            v3fatal("Cannot open --bsp-cost-model file: " << filename);
+            return;
+        }
+        int lineno = 0;
+        while (!ifp->eof()) {
+            const string line = V3Os::getline(*ifp);
+            ++lineno;
+            std::istringstream is{line};
+            string node;
+            if (!(is >> node) || node[0] == '#') continue;
+            string pattern;
+            string kind;
+            Row row;
+            is >> pattern >> kind >> row.m_coefs[0] >> row.m_coefs[1] >> row.m_coefs[2]
+                >> row.m_coefs[3] >> row.m_mean;
+            if (is.fail() || pattern.size() != 3 || (kind != "lin" && kind != "cube")) {
+                v3fatal("Malformed --bsp-cost-model entry at " << filename << ":" << lineno
+                                                               << ": " << line);
+                return;
+            }
+            std::copy(pattern.begin(), pattern.end(), row.m_pattern.begin());
+            row.m_cube = kind == "cube";
+            m_rows[node].push_back(row);
+        }
+        UINFO(3, "Loaded cost model entries for " << m_rows.size() << " node types" << endl);
+    }
+
+    // Returns the latency of nodep, or false if the node type is not in the table
+    std::pair<int, bool> tryEstimate(const AstNode* nodep, bool useMean) const {
+        const auto it = m_rows.find(nodep->typeName());
+        if (it == m_rows.end()) return {0, false};
+        const AstNode* const lhsp = VN_CAST(nodep->op1p(), NodeExpr);
+        const AstNode* const rhsp = VN_CAST(nodep->op2p(), NodeExpr);
+        for (const Row& row : it->second) {
+            if (!matches(row.m_pattern[0], nodep) || !matches(row.m_pattern[1], lhsp)
+                || !matches(row.m_pattern[2], rhsp)) {
+                continue;
+            }
+            float cost = 0;
+            if (useMean && row.m_mean != 0.0f) {
+                cost = row.m_mean;
+            } else if (row.m_cube) {
+                const float n = words(nodep);
+                cost = ((row.m_coefs[0] * n + row.m_coefs[1]) * n + row.m_coefs[2]) * n
+                       + row.m_coefs[3];
+            } else {
+                cost = row.m_coefs[0] * words(nodep) + row.m_coefs[1] * words(lhsp)
+                       + row.m_coefs[2] * words(rhsp) + row.m_coefs[3];
+            }
+            return {std::max(0, static_cast<int>(std::round(cost))), true};
+        }
+        // No pattern matched and the table has no "___" fallback row for the node, which
+        // the generated model would emit from its anyCode. Use its defaultLatency, rather
+        // than the IPU rows of the built-in model.
+        return {defaultLatency(nodep), true};
+    }
+};
+
+const CostTable* costTable() {
+    static std::once_flag s_loaded;
+    static std::unique_ptr<CostTable> s_tablep;
+    std::call_once(s_loaded, []() {
+        if (v3Global.opt.bspCostModel().empty()) return;
+        s_tablep = std::make_unique<CostTable>();
+        s_tablep->load(v3Global.opt.bspCostModel());
+    });
+    return s_tablep.get();
+}
+
+}  // namespace
+
+int V3BspCostModel::estimate(AstNode* nodep, bool useMean) {
+    if (const CostTable* const tablep = costTable()) {
+        const std::pair<int, bool> res = tablep->tryEstimate(nodep, useMean);
+        if (res.second) return res.first;
+    }
+    return IpuCostModelLinReg::estimate(nodep, useMean);
+}
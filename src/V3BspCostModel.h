@@ -0,0 +1,54 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Data-driven cost model for BSP partitioning
+//
+// Code available from: https://verilator.org
+//
+//*************************************************************************
+//
+// Copyright 2003-2023 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+//
+// The per-node latencies used to balance BSP partitions. By default these
+// come from the IPU coefficients compiled into V3BspIpuCostModelLinReg.h.
+// With --bsp-cost-model <file>, a coefficient table produced by the
+// calibration scripts in ipumodel/ is loaded instead, so the model can match
+// the target the code actually runs on (e.g., the host for --bsp-cpu).
+//
+// Each non-comment line of the table reads:
+//
+//      <NODE> <pattern> lin  <cOut> <cLhs> <cRhs> <intercept> <mean>
+//      <NODE> <pattern> cube <c3> <c2> <c1> <c0> <mean>
+//
+// NODE is an AstNode type name (e.g., ADD, EXTENDS). The pattern has three
+// characters for the output, lhs and rhs widths respectively: I (up to 32
+// bits), Q (up to 64 bits), W (wide) or _ (any). The rows of a node are tried
+// in order and the first match gives the latency in cycles, either linear in
+// the number of words of the output and operands, or cubic in the number of
+// output words. A trailing "___" row gives the fallback latency of the node,
+// like the anyCode of the generated model. Without one, a node that matches no
+// row costs its width in words, the defaultLatency of the generated model.
+// Nodes that do not appear in the table use the built-in model.
+//
+//*************************************************************************
+
+#ifndef VERILATOR_V3BSPCOSTMODEL_H_
+#define VERILATOR_V3BSPCOSTMODEL_H_
+
+#include "config_build.h"
+#include "verilatedos.h"
+
+class AstNode;
+
+class V3BspCostModel final {
+public:
+    // Estimated latency of nodep alone (i.e., not including its children)
+    static int estimate(AstNode* nodep, bool useMean = false);
+};
+
+#endif  // Guard
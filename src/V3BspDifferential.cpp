@@ -35,7 +35,7 @@ namespace {
 // A scratchpad data structure to keep the state of the transformation
 struct UnpackUpdate {
     uint32_t numUpdates = 0;
-    uint32_t diffCost = 0;
+    uint32_t diffCost = 0;  // words sent by the differential exchange, packed variables only
     struct {
         std::vector<AstNode*> recipesp;
         std::vector<AstVarScope*> rvsp;  // ensure unique elements
@@ -43,9 +43,9 @@ struct UnpackUpdate {
     } subst;
     AstVarScope* origVscp = nullptr;
     AstClass* const classp = nullptr;
-    AstUnpackArrayDType* const dtypep = nullptr;
+    AstNodeDType* const dtypep = nullptr;  // unpack array or wide packed type
 
-    UnpackUpdate(AstClass* const clsp, AstUnpackArrayDType* const tp)
+    UnpackUpdate(AstClass* const clsp, AstNodeDType* const tp)
         : classp{clsp}
         , dtypep{tp}
         , numUpdates{0}
@@ -53,20 +53,23 @@ struct UnpackUpdate {
     operator bool() const { return (classp != nullptr && dtypep != nullptr); }
 };
 
-// We have a scratchpad for each written Unpack variable (AstVar* is the var in the producer)
+// We have a scratchpad for each written Unpack or wide packed variable (AstVar* is the var in
+// the producer)
 using UnpackUpdateMap = std::unordered_map<AstVar*, UnpackUpdate>;
 
 class DifferentialUnpackVisitor;
 
 /// Simple visitor to check whether it makes sense to turn a blind exchange into
 /// one in which only "changes" are propagated.
-/// TODO: Estimate the cost of sending the diffs versus sending the whole variable
+/// TODO: Estimate the cost of sending the diffs versus sending the whole unpack
+/// variable, as done for packed variables through UnpackUpdate::diffCost
 ///
 class UnpackWriteAnalysisVisitor final : public VNVisitor {
 private:
     UnpackUpdateMap& m_updates;
     bool m_inDynamicBlock = false;
     bool m_inAssign = false;
+    const AstNodeAssign* m_assignp = nullptr;  // Enclosing assignment
 
     // enum {
     //     E_COUNT_WRITES = 0,
@@ -81,6 +84,26 @@ private:
             iterateChildren(nodep);
         }
     }
+    void countUpdate(const AstNodeVarRef* vrefp, uint32_t words) {
+        AstVar* const varp = vrefp->varp();
+        if (m_inDynamicBlock) {
+            // we can not accurately count the number of times the variable
+            // is updated (e.g., inside a while loop). So we don't consider it for optimization
+            UINFO(4, "Will not be optimized: "
+                         << varp->prettyNameQ()
+                         << ", cannot determine number of updates statically" << endl);
+            m_updates.erase(varp);
+        } else if (m_inAssign) {
+            UnpackUpdate& update = m_updates.find(varp)->second;
+            update.numUpdates += 1;
+            update.diffCost += words;
+        } else {
+            // not in an assignment, perhaps LV but as function argument
+            UINFO(4, "Will not be optimized: " << varp->prettyNameQ()
+                                               << ", not in an assignment" << endl);
+            m_updates.erase(varp);
+        }
+    }
     void visit(AstArraySel* aselp) override {
         // get the base VarRef for this ArraySel
         AstNode* const baseFromp = AstArraySel::baseFromp(aselp, false);
@@ -88,23 +111,28 @@ private:
         const AstNodeVarRef* const vrefp = VN_CAST(baseFromp, NodeVarRef);
         UASSERT_OBJ(vrefp, aselp, "No VarRef under ArraySel");
         const bool lvalue = vrefp->access().isWriteOrRW();
-        AstVar* const varp = vrefp->varp();
-        if (lvalue && m_updates.count(vrefp->varp())) {
-            if (m_inDynamicBlock) {
-                // we can not accurately count the number of times the variable
-                // is updated (e.g., inside a while loop). So we don't consider it for optimization
-                UINFO(4, "Will not be optimized: "
-                             << varp->prettyNameQ()
-                             << ", cannot determine number of updates statically" << endl);
-                m_updates.erase(varp);
-            } else if (m_inAssign) {
-                m_updates.find(varp)->second.numUpdates += 1;
-            } else {
-                // not in an assignment, perhaps LV but as function argument
-                UINFO(4, "Will not be optimized: " << varp->prettyNameQ()
-                                                   << ", not in an assignment" << endl);
-                m_updates.erase(varp);
-            }
+        if (lvalue && m_updates.count(vrefp->varp())) countUpdate(vrefp, 0);
+    }
+    // Words sent for a partial write. makeDifferential captures the rhs in a member of
+    // its width, and every variable read by the lsb is sent whole (an enable bit is
+    // counted separately)
+    uint32_t capturedWords(const AstSel* selp) const {
+        uint32_t words = m_assignp ? m_assignp->rhsp()->widthWords() : selp->widthWords();
+        selp->lsbp()->foreach([&words](const AstNodeVarRef* refp) {
+            AstNodeDType* const dtypep = refp->varp()->dtypep();
+            words += dtypep->arrayUnpackedElements() * dtypep->widthWords();
+        });
+        return words;
+    }
+    void visit(AstSel* selp) override {
+        // partial write of a wide packed variable, the receiver needs the value, the
+        // variables of the lsb and an enable bit
+        const AstNodeVarRef* const vrefp = VN_CAST(selp->fromp(), NodeVarRef);
+        if (vrefp && vrefp->access().isWriteOrRW() && m_updates.count(vrefp->varp())) {
+            countUpdate(vrefp, capturedWords(selp));
+            iterate(selp->lsbp());
+        } else {
+            iterateChildren(selp);
         }
     }
     void visit(AstNodeVarRef* vrefp) {
@@ -119,8 +147,10 @@ private:
 
     void visit(AstNodeAssign* assignp) override {
         VL_RESTORER(m_inAssign);
+        VL_RESTORER(m_assignp);
         {
             m_inAssign = true;
+            m_assignp = assignp;
             iterateChildren(assignp);
         }
     }
@@ -183,6 +213,11 @@ private:
 ///         add target.enCond = enCondInit
 /// Obviously this could back-fire if unpack < sizeof({x, y, z, u, v})
 /// So only do it for larger unpacks (e.g. more than 64 words)
+///
+/// Wide packed variables that are only written through constant width
+/// selections (packed[u+:b] = v) are handled the same way, with u and v sent
+/// instead of the whole variable. Since the written words are known statically,
+/// this is only done if they add up to fewer words than the variable itself.
 
 class DifferentialUnpackVisitor final : public VNVisitor {
 private:
@@ -203,6 +238,8 @@ private:
 
     VDouble0 m_statsNumOpt;
     VDouble0 m_statsNumCandidates;
+    VDouble0 m_statsNumPackedOpt;
+    VDouble0 m_statsNumPackedCandidates;
     // stack of ArraySel nodes above
     std::vector<AstArraySel*> m_aselp;
 
@@ -509,9 +546,35 @@ private:
             m_updates.erase(vrefp->varp());
             return;
         }
+        makeDifferential(aselp, vrefp);
+    }
+    void visit(AstSel* selp) override {
+        const AstNodeVarRef* const vrefp = VN_CAST(selp->fromp(), NodeVarRef);
+        if (!vrefp || !vrefp->access().isWriteOrRW() || !marked(vrefp->varp())) {
+            iterateChildren(selp);
+            return;
+        }
+        UnpackUpdate& scratchpad = getScratchpad(vrefp->varp());
+        UASSERT_OBJ(scratchpad.numUpdates, vrefp, "no write observed!");
+        // one enable bit per update, rounded up to words
+        const uint32_t diffWords = scratchpad.diffCost + (scratchpad.numUpdates + 31) / 32;
+        if (diffWords >= static_cast<uint32_t>(scratchpad.dtypep->widthWords())) {
+            UINFO(4, "Will not make differential update because it is not cheaper: "
+                         << vrefp->varp()->prettyNameQ() << " would send " << diffWords
+                         << " words instead of " << scratchpad.dtypep->widthWords() << endl);
+            m_updates.erase(vrefp->varp());
+            return;
+        }
+        makeDifferential(selp, vrefp);
+    }
+    // Record the assignment to selp (an lvalue ArraySel or Sel of vrefp) so that the
+    // readers can replay it
+    void makeDifferential(AstNodeExpr* selp, const AstNodeVarRef* vrefp) {
+        UnpackUpdate& scratchpad = getScratchpad(vrefp->varp());
         // create the write condition
         if (!scratchpad.subst.condp) {
             m_statsNumOpt += 1;
+            if (VN_IS(selp, Sel)) m_statsNumPackedOpt += 1;
             AstNodeDType* condDTypep = m_netlistp->findBitDType(
                 static_cast<int>(scratchpad.numUpdates), static_cast<int>(scratchpad.numUpdates),
                 VSigning::UNSIGNED);
@@ -528,7 +591,7 @@ private:
             scratchpad.subst.condp = condVscp;
 
             // set it to zero before anything else runs
-            UASSERT_OBJ(m_nbaFuncp, aselp, "not under nbaTop");
+            UASSERT_OBJ(m_nbaFuncp, selp, "not under nbaTop");
             AstAssign* const assignClearp = new AstAssign{
                 vrefp->fileline(), new AstVarRef{vrefp->fileline(), condVscp, VAccess::WRITE},
                 new AstConst{vrefp->fileline(), AstConst::WidthedValue{}, condDTypep->width(), 0}};
@@ -540,11 +603,11 @@ private:
 
 
         }
-        AstNodeAssign* const parentAssignp = [aselp]() {
+        AstNodeAssign* const parentAssignp = [selp]() {
             // find the parent statement (should be NodeAssign)
-            AstNode* parentp = aselp;
+            AstNode* parentp = selp;
             while (!VN_IS(parentp, NodeStmt) && parentp) { parentp = parentp->backp(); }
-            UASSERT_OBJ(parentp, aselp, "no parent stmt");
+            UASSERT_OBJ(parentp, selp, "no parent stmt");
             return VN_AS(parentp, NodeAssign);
         }();
         if (parentAssignp->user1()) {
@@ -651,15 +714,19 @@ public:
         foreachCopyp([&](AstAssign* copyp) {
             // targetClassp.targetVarp  = sourceClassp.sourceVarp
             AstMemberSel* const sourcep = VN_AS(copyp->rhsp(), MemberSel);
-            AstUnpackArrayDType* const unpackDTypep = VN_CAST(sourcep->dtypep(), UnpackArrayDType);
-            if (!unpackDTypep) {
+            AstNodeDType* const dtypep = sourcep->dtypep()->skipRefp();
+            AstUnpackArrayDType* const unpackDTypep = VN_CAST(dtypep, UnpackArrayDType);
+            const bool widePacked = VN_IS(dtypep, BasicDType) && dtypep->isWide();
+            if (!unpackDTypep && !widePacked) {
                 // not our concern
                 return;
             }
-            auto numWords = unpackDTypep->arrayUnpackedElements() * unpackDTypep->widthWords();
+            auto numWords = unpackDTypep
+                                ? unpackDTypep->arrayUnpackedElements() * unpackDTypep->widthWords()
+                                : dtypep->widthWords();
             if (numWords < v3Global.opt.diffExchangeThreshold()) {
-                UINFO(4, "Will not optimize unpack array "
-                             << unpackDTypep << " with " << numWords
+                UINFO(4, "Will not optimize "
+                             << dtypep << " with " << numWords
                              << " words which is smaller than --diff-exchange-threshold "
                              << v3Global.opt.diffExchangeThreshold() << endl);
                 return;
@@ -669,8 +736,9 @@ public:
             AstVar* const unpackVarp = sourcep->varp();
             if (!marked(unpackVarp)) {
                 // emplace it in the scratchpad to be transformed
-                m_updates.emplace(unpackVarp, UnpackUpdate{classp, unpackDTypep});
+                m_updates.emplace(unpackVarp, UnpackUpdate{classp, dtypep});
                 m_statsNumCandidates += 1;
+                if (widePacked) m_statsNumPackedCandidates += 1;
                 classp->user1(VU_WRITER);  // mark this class as being a writer
             }
         });
@@ -708,6 +776,10 @@ public:
         V3Stats::addStat("Optimizations, ipu differential exchanges applied", m_statsNumOpt);
         V3Stats::addStat("Optimizations, ipu differential exchange candidates",
                          m_statsNumCandidates);
+        V3Stats::addStat("Optimizations, ipu differential exchanges applied to packed",
+                         m_statsNumPackedOpt);
+        V3Stats::addStat("Optimizations, ipu differential exchange candidates packed",
+                         m_statsNumPackedCandidates);
     }
 };
 }  // namespace
@@ -304,19 +304,26 @@ private:
     V3UniqueNames& m_dpiNames;
     DpiRecord& m_records;
 
+    // With a fused condition (see BspDpiCondVisitor) the workload never runs twice for the
+    // same cycle, so only the init classes need a re-entry point
+    bool reEnters() const { return !v3Global.bspFusedCond() || m_classp->flag().isBspInit(); }
+
     void initKit() {
         if (m_dpiKit) return;
         UASSERT(m_scopep && m_classp, "expected scope and class");
         const DpiInfo info = m_records.getInfo(m_classp);
-        AstVar* const reEntryVarp = new AstVar{m_classp->fileline(), VVarType::MEMBER,
-                                               m_dpiNames.get("reEntry"), VFlagBitPacked{}, 1};
-        reEntryVarp->bspFlag({VBspFlag::MEMBER_INPUT});
-        m_classp->stmtsp()->addHereThisAsNext(reEntryVarp);
-        AstVarScope* const reEntryVscp
-            = new AstVarScope{m_classp->fileline(), m_scopep, reEntryVarp};
-        m_scopep->addVarsp(reEntryVscp);
-        m_dpiKit.reEntryp = reEntryVscp;
-        m_records.setReEntry(m_classp, reEntryVscp);  // used by the  BspDpiCondVisitor
+        if (reEnters()) {
+            AstVar* const reEntryVarp
+                = new AstVar{m_classp->fileline(), VVarType::MEMBER, m_dpiNames.get("reEntry"),
+                             VFlagBitPacked{}, 1};
+            reEntryVarp->bspFlag({VBspFlag::MEMBER_INPUT});
+            m_classp->stmtsp()->addHereThisAsNext(reEntryVarp);
+            AstVarScope* const reEntryVscp
+                = new AstVarScope{m_classp->fileline(), m_scopep, reEntryVarp};
+            m_scopep->addVarsp(reEntryVscp);
+            m_dpiKit.reEntryp = reEntryVscp;
+            m_records.setReEntry(m_classp, reEntryVscp);  // used by the  BspDpiCondVisitor
+        }
         if (info.numCalls > 0) {
             AstVar* const dpiPointVarp
                 = new AstVar{m_classp->fileline(), VVarType::MEMBER, m_dpiNames.get("dpiPoint"),
@@ -538,12 +545,15 @@ private:
                           new AstAnd{stmtp->fileline(), mkHostBitSel(0), mkHostBitSel(dpiIndex)},
                           stmtp, nullptr});
         }
-        AstIf* const guardp = new AstIf{
-            m_classp->fileline(),
-            new AstLogNot{m_classp->fileline(),
-                          new AstVarRef{m_classp->fileline(), m_dpiKit.reEntryp, VAccess::READ}},
-            cfuncp->stmtsp()->unlinkFrBackWithNext(), nullptr};
-        cfuncp->addStmtsp(guardp);
+        if (m_dpiKit.reEntryp) {
+            AstIf* const guardp = new AstIf{
+                m_classp->fileline(),
+                new AstLogNot{m_classp->fileline(), new AstVarRef{m_classp->fileline(),
+                                                                  m_dpiKit.reEntryp,
+                                                                  VAccess::READ}},
+                cfuncp->stmtsp()->unlinkFrBackWithNext(), nullptr};
+            cfuncp->addStmtsp(guardp);
+        }
         // clear DpiPoint on entry
         AstAssign* const dpiClearp = new AstAssign{
             m_dpiKit.dpiPoint->fileline(),
@@ -559,6 +569,7 @@ private:
         const DpiInfo info = m_records.getInfo(m_classp);
         if (!cfuncp->stmtsp()) { return; }
         if (info.noDpi()) {
+            if (!m_dpiKit.reEntryp) return;  // never re-entered
             // simple case, guard the whole function body with the reEntry variable
             AstIf* const guardp
                 = new AstIf{m_classp->fileline(),
@@ -572,6 +583,7 @@ private:
             injectReEntryBuffered(cfuncp);
             return;
         }
+        UASSERT_OBJ(m_dpiKit.reEntryp, cfuncp, "strict DPI needs a re-entry point");
         // else need to create GOTO statments
         AstJumpBlock* const jblockExitp = new AstJumpBlock{m_classp->fileline(), nullptr};
         AstJumpLabel* const exitLabelp = new AstJumpLabel{m_classp->fileline(), jblockExitp};
@@ -599,8 +611,11 @@ private:
             UASSERT(stmtp, "expected statement");
 
             UINFO(3, "Replacing call " << callp->name() << endl);
-            // they don't need reentry since they terminate execution.
-            const bool needReEntry = !(VN_IS(stmtp, Stop) || VN_IS(stmtp, Finish));
+            // they don't need reentry since they terminate execution. The $finish
+            // of one of --instances does not, the other instances keep running.
+            const AstFinish* const finishp = VN_CAST(stmtp, Finish);
+            const bool needReEntry
+                = !(VN_IS(stmtp, Stop) || (finishp && finishp->instance() < 0));
 
             AstDelegate* const delegatep = mkDelegate(callp, stmtp);
 
@@ -736,7 +751,7 @@ private:
         {
             cfuncp->user1(true);
             if (cfuncp->name() == "triggerEval") {
-                guardTrigger(cfuncp);
+                if (m_dpiKit.reEntryp) guardTrigger(cfuncp);
             } else if (cfuncp->name() == "nbaTop"
                        || (m_classp->flag().isBspInit() && cfuncp->name() == "compute")) {
                 m_cfuncp = cfuncp;
@@ -849,9 +864,14 @@ private:
         //      tmp = 0;
         //      for (p : dpiPoints) tmp |= (p[0:0]);
         //      hasDpi = tmp;
-        compFuncp->addStmtsp(
-            new AstAssign{flp, new AstVarRef{flp, tmpVscp, VAccess::WRITE},
-                          new AstConst{flp, AstConst::WidthedValue{}, tmpVscp->width(), 0}});
+        // When several cycles run between two checks (--bsp-cycle-batch), hasDpi has to
+        // remember a request of any of them, so tmp starts from hasDpi instead and the
+        // runtime clears hasDpi before each check period
+        compFuncp->addStmtsp(new AstAssign{
+            flp, new AstVarRef{flp, tmpVscp, VAccess::WRITE},
+            v3Global.bspCycleBatch() > 1
+                ? static_cast<AstNodeExpr*>(new AstVarRef{flp, dpiCondVscp, VAccess::READ})
+                : new AstConst{flp, AstConst::WidthedValue{}, tmpVscp->width(), 0}});
 
         // create an exchange which should come before the compute in the execution
         auto mkModFunc = [this](const string& name) -> AstCFunc* {
@@ -878,22 +898,31 @@ private:
             "dpiExchange");  // incast all the vertex dpi vectors to the condeval vertex
         AstCFunc* const broadcastFuncp
             = mkModFunc("dpiBroadcast");  // broadcast the result back to "reEntry" variables
+        const bool fused = v3Global.bspFusedCond();
+        // dpiPoint or DPI argument of a non-init class -> its copy in the condeval class
+        std::unordered_map<const AstVar*, AstVarScope*> mirrors;
         for (const auto& pair : m_records.getClasses()) {
             AstClass* const classp = pair.first;
             UASSERT(classp, "classp should be non-null" << endl);
             AstVarScope* const dpiPointp = pair.second.dpiPointp;
             AstVarScope* const reEntryp = pair.second.reEntryp;
-            UASSERT_OBJ(reEntryp, classp, "expected re-entry variable");
+            const bool mirrored = fused && !classp->flag().isBspInit();
+            UASSERT_OBJ(reEntryp || mirrored, classp, "expected re-entry variable");
             AstVarScope* const sourceInstVscp = m_records.getInst(classp);
             UASSERT_OBJ(instVscp, classp, "not instance found for class: " << classp << endl);
 
-            broadcastFuncp->addStmtsp(
-                new AstAssign{flp, mkMemSel(sourceInstVscp, reEntryp, VAccess::WRITE),
-                              mkMemSel(instVscp, dpiCondVscp, VAccess::READ)});
+            if (reEntryp) {
+                broadcastFuncp->addStmtsp(
+                    new AstAssign{flp, mkMemSel(sourceInstVscp, reEntryp, VAccess::WRITE),
+                                  mkMemSel(instVscp, dpiCondVscp, VAccess::READ)});
+            }
 
             if (!dpiPointp) continue;  // not participating
-            AstVarScope* dpiPartVscp = makeVar(m_freshNames.get("vec"), dpiPointp->dtypep(), false,
-                                               {VBspFlag::MEMBER_INPUT});
+            VBspFlag vecFlag{VBspFlag::MEMBER_INPUT};
+            if (mirrored) vecFlag.append(VBspFlag::MEMBER_HOSTREAD);
+            AstVarScope* dpiPartVscp
+                = makeVar(m_freshNames.get("vec"), dpiPointp->dtypep(), false, vecFlag);
+            if (mirrored) mirrors.emplace(dpiPointp->varp(), dpiPartVscp);
             AstSel* const bitSelp = new AstSel{flp, new AstVarRef{flp, dpiPartVscp, VAccess::READ},
                                                new AstConst{flp, 0}, new AstConst{flp, 1}};
             AstOr* const orp = new AstOr{flp, bitSelp, new AstVarRef{flp, tmpVscp, VAccess::READ}};
@@ -920,6 +949,53 @@ private:
         compFuncp->addStmtsp(new AstAssign{flp, new AstVarRef{flp, dpiCondVscp, VAccess::WRITE},
                                            new AstVarRef{flp, tmpVscp, VAccess::WRITE}});
 
+        if (fused) {
+            // The condition of cycle k is computed in the same superstep as cycle k + 1,
+            // so by the time the host sees it the workload has overwritten the DPI
+            // arguments of cycle k. Let the host read them from copies in the condeval
+            // class instead, which dpiExchange only updates right before the next
+            // superstep.
+            AstCFunc* hostHandlep = nullptr;
+            for (AstNode* nodep = m_netlistp->topScopep()->scopep()->blocksp(); nodep;
+                 nodep = nodep->nextp()) {
+                AstCFunc* const cfuncp = VN_CAST(nodep, CFunc);
+                if (cfuncp && cfuncp->name() == "hostHandle") hostHandlep = cfuncp;
+            }
+            UASSERT(hostHandlep, "expected hostHandle function");
+            std::vector<AstMemberSel*> hostSelsp;
+            hostHandlep->foreach([&hostSelsp](AstMemberSel* memselp) {
+                const AstClassRefDType* const refp
+                    = VN_CAST(VN_AS(memselp->fromp(), VarRef)->varp()->dtypep(), ClassRefDType);
+                if (refp && !refp->classp()->flag().isBspInit()) hostSelsp.push_back(memselp);
+            });
+            for (AstMemberSel* const memselp : hostSelsp) {
+                AstVarRef* const fromp = VN_AS(memselp->fromp(), VarRef);
+                UASSERT_OBJ(fromp->access().isReadOnly(), memselp,
+                            "buffered DPI should not write back");
+                AstVar* const sourceVarp = memselp->varp();
+                AstVarScope*& mirrorVscp = mirrors[sourceVarp];
+                if (!mirrorVscp) {
+                    mirrorVscp
+                        = makeVar(m_freshNames.get("mirror"), sourceVarp->dtypep(), false,
+                                  {VBspFlag::MEMBER_INPUT, VBspFlag::MEMBER_HOSTREAD});
+                    AstMemberSel* const sourceSelp
+                        = new AstMemberSel{flp, new AstVarRef{flp, fromp->varScopep(),
+                                                              VAccess::READ},
+                                           VFlagChildDType{}, sourceVarp->name()};
+                    sourceSelp->varp(sourceVarp);
+                    sourceSelp->dtypeFrom(sourceVarp);
+                    exchangeFuncp->addStmtsp(new AstAssign{
+                        flp, mkMemSel(instVscp, mirrorVscp, VAccess::WRITE), sourceSelp});
+                    // only the mirror is read by the host now
+                    sourceVarp->bspFlag(
+                        VBspFlag{sourceVarp->bspFlag()}.clear(VBspFlag::MEMBER_HOSTREAD));
+                }
+                memselp->replaceWith(mkMemSel(instVscp, mirrorVscp, VAccess::READ));
+                VL_DO_DANGLING(pushDeletep(memselp), memselp);
+            }
+            V3Stats::addStat("BspDpi, host read mirrors", mirrors.size());
+        }
+
         scopep->addBlocksp(compFuncp);
         newClsp->addStmtsp(scopep);
 
@@ -937,6 +1013,30 @@ private:
     }
     friend class V3BspDpi;
 };
+bool V3BspDpi::isStrict(const AstNode* nodep) {
+    // mirrors BspDpiAnalysisVisitor
+    return nodep->exists([](const AstNode* np) {
+        if (const AstCCall* const callp = VN_CAST(np, CCall)) {
+            return callp->funcp()->dpiImportWrapper();
+        }
+        return VN_IS(np, NodeReadWriteMem);
+    });
+}
+
+void V3BspDpi::settleHostCondition(bool strict) {
+    const bool fusable = v3Global.opt.fIpuFusedCond() && !strict;
+    v3Global.bspFusedCond(fusable);
+    if (v3Global.opt.bspCycleBatch() > 1) {
+        if (fusable) {
+            v3Global.bspCycleBatch(v3Global.opt.bspCycleBatch());
+        } else {
+            v3warn(E_UNSUPPORTED, "--bsp-cycle-batch needs a host request condition "
+                                  "fused with the workload (no strict DPI calls and no "
+                                  "-fno-ipu-fused-cond), checking every cycle instead");
+        }
+    }
+}
+
 void V3BspDpi::delegateAll(AstNetlist* nodep) {
 
     V3UniqueNames m_newNames = VL_UNIQUENAMES("closure");
@@ -944,6 +1044,28 @@ void V3BspDpi::delegateAll(AstNetlist* nodep) {
     UINFO(3, "Analyzing DPI calls" << endl);
     auto records = BspDpiAnalysisVisitor::analyze(nodep);
 
+    // Evaluating the condition along with the workload makes the host see a DPI call one
+    // cycle late, which is only fine if the call does not talk back to the design
+    bool fusable = v3Global.bspFusedCond();
+    for (const auto& pair : records.getClasses()) {
+        if (!pair.first->flag().isBspInit() && pair.second.strictDpi()) fusable = false;
+    }
+    // settleHostCondition saw the logic before it was moved into classes, it should
+    // have found the same calls
+    if (!fusable && v3Global.bspFusedCond()) {
+        v3Global.bspFusedCond(false);
+        if (v3Global.bspCycleBatch() > 1) {
+            v3Global.bspCycleBatch(1);
+            nodep->v3warn(E_UNSUPPORTED, "--bsp-cycle-batch needs a host request condition "
+                                         "fused with the workload (no strict DPI calls and no "
+                                         "-fno-ipu-fused-cond), checking every cycle instead");
+        }
+    }
+    UINFO(3, "Host request condition " << (fusable ? "fused with" : "separate from")
+                                       << " the workload" << endl);
+    V3Stats::addStat("BspDpi, host condition fused with the workload", fusable);
+    V3Stats::addStat("BspDpi, cycles per host condition check", v3Global.bspCycleBatch());
+
     UINFO(3, "Making DPI closures" << endl);
     { BspDpiClosureVisitor{nodep, records, m_newNames}; }
     V3Global::dumpCheckGlobalTree("bspDpiClosure", 0, dumpTree() >= 1);
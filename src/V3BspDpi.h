@@ -27,6 +27,13 @@
 
 class V3BspDpi final {
 public:
+    // Whether nodep calls into the host in a way that has to be served in the cycle of
+    // the call: DPI imports and $readmem/$writemem
+    static bool isStrict(const AstNode* nodep);
+    // Decide whether the host request condition is evaluated with the workload, and so
+    // the effective --bsp-cycle-batch. Runs before scheduling (see V3BspLookahead),
+    // delegateAll may only turn batching off afterwards.
+    static void settleHostCondition(bool strict);
     static void delegateAll(AstNetlist* nodep);
 };
 
@@ -22,6 +22,7 @@
 #include "V3AstUserAllocator.h"
 #include "V3File.h"
 #include "V3Hasher.h"
+#include "V3InstrCount.h"
 #include "V3Os.h"
 #include "V3Stats.h"
 VL_DEFINE_DEBUG_FUNCTIONS;
@@ -47,19 +48,19 @@ public:
         ConstrVertex* res = nullptr;
         switch (tpe) {
         case Type::INIT:
-            if (!m_initp) m_initp = new ConstrInitVertex{graphp, vscp};
+            if (!m_initp) m_initp = new (graphp) ConstrInitVertex{graphp, vscp};
             res = m_initp;
             break;
         case Type::DEF:
-            if (!m_defp) m_defp = new ConstrDefVertex{graphp, vscp};
+            if (!m_defp) m_defp = new (graphp) ConstrDefVertex{graphp, vscp};
             res = m_defp;
             break;
         case Type::COMMIT:
-            if (!m_commitp) m_commitp = new ConstrCommitVertex{graphp, vscp};
+            if (!m_commitp) m_commitp = new (graphp) ConstrCommitVertex{graphp, vscp};
             res = m_commitp;
             break;
         case Type::POST:
-            if (!m_postp) m_postp = new ConstrPostVertex{graphp, vscp};
+            if (!m_postp) m_postp = new (graphp) ConstrPostVertex{graphp, vscp};
             res = m_postp;
             break;
         default: vscp->v3fatal("Internal: bad vertex type request!"); break;
@@ -99,7 +100,7 @@ private:
         UASSERT_OBJ(!m_logicVtx, nodep, "Nesting logic?");
         // Reset the usage
         AstNode::user2ClearTree();
-        m_logicVtx = new CompVertex{m_graphp, m_scopep, nodep, m_domainp, m_active};
+        m_logicVtx = new (m_graphp) CompVertex{m_graphp, m_scopep, nodep, m_domainp, m_active};
         V3Stats::addStatSum("BspGraph, Computation nodes", 1);
         iterateChildren(nodep);
         m_logicVtx = nullptr;
@@ -333,6 +334,11 @@ std::unique_ptr<DepGraph> backwardTraverseAndCollect(const std::unique_ptr<DepGr
         origIsVisited.insert(vp);
         // vp->user(1);
         toVisit.push(vp);
+        if (CompVertex* const compp = vp->cast<CompVertex>()) {
+            builderp->addRootp(compp->nodep());
+        } else if (ConstrCommitVertex* const commitp = vp->cast<ConstrCommitVertex>()) {
+            builderp->addRootp(commitp->vscp());
+        }
     }
     // bfs-like, collect all reachable vertices from the postp collection
     std::vector<AnyVertex*> visited;
@@ -340,8 +346,7 @@ std::unique_ptr<DepGraph> backwardTraverseAndCollect(const std::unique_ptr<DepGr
         AnyVertex* const headp = toVisit.front();
         toVisit.pop();
         visited.push_back(headp);
-        if (dynamic_cast<ConstrPostVertex* const>(headp)
-            || dynamic_cast<ConstrInitVertex* const>(headp)) {
+        if (headp->is<ConstrPostVertex>() || headp->is<ConstrInitVertex>()) {
             continue;  // do not follow, not data dependence, only ordering constraints
         }
         for (auto itp = headp->inBeginp(); itp; itp = itp->inNextp()) {
@@ -365,6 +370,7 @@ std::unique_ptr<DepGraph> backwardTraverseAndCollect(const std::unique_ptr<DepGr
     auto makeClone = [&](AnyVertex* const vtxp) {
         UASSERT(!origToClonep.count(vtxp), "invalid state, double counting a vertex?");
         AnyVertex* const clonep = vtxp->clone(builderp.get());
+        clonep->hash(vtxp->hash());  // identifies the fiber across runs, see V3BspPartitionCache
         cloneToOrigp.emplace(clonep, vtxp);
         origToClonep.emplace(vtxp, clonep);
     };
@@ -373,7 +379,7 @@ std::unique_ptr<DepGraph> backwardTraverseAndCollect(const std::unique_ptr<DepGr
 
     // clone immediate successors of the collected vertices, in graphp
     for (AnyVertex* const vtxp : visited) {
-        CompVertex* const compp = dynamic_cast<CompVertex* const>(vtxp);
+        CompVertex* const compp = vtxp->cast<CompVertex>();
         if (!compp) { continue; /* not a CompVertex */ }
         // Special handling of the ComputeVertex: make sure all successors
         // (i.e., DefConstr, CommitConstr, or PostConstr) vertices are also added
@@ -389,8 +395,7 @@ std::unique_ptr<DepGraph> backwardTraverseAndCollect(const std::unique_ptr<DepGr
         // will result in a DefConstr(x) node that is a sink and hence maynot
         // be added to the partition (i.e., has not been cloned yet)
         for (V3GraphEdge* eitp = compp->outBeginp(); eitp; eitp = eitp->outNextp()) {
-            AnyVertex* top = dynamic_cast<AnyVertex*>(eitp->top());
-            UASSERT(top, "expected AnyVertex type");
+            AnyVertex* top = vtxCast<AnyVertex>(eitp->top());
             if (!origToClonep.count(top)) { makeClone(top); }
         }
     }
@@ -400,8 +405,7 @@ std::unique_ptr<DepGraph> backwardTraverseAndCollect(const std::unique_ptr<DepGr
     std::unordered_set<V3GraphEdge*> graphpEdgesCounted;  // V3GraphEdges of graphp
 
     auto findChecked = [&](V3GraphVertex* vp, const auto& collection) -> AnyVertex* {
-        AnyVertex* const anyp = dynamic_cast<AnyVertex*>(vp);
-        UASSERT(anyp, "should not be nullptr");
+        AnyVertex* const anyp = vtxCast<AnyVertex>(vp);
         auto it = collection.find(anyp);
         UASSERT(it != collection.end(), "could not find map entry");
         return it->second;
@@ -417,17 +421,16 @@ std::unique_ptr<DepGraph> backwardTraverseAndCollect(const std::unique_ptr<DepGr
             // eitp is in the original graph (i.e., graphp)
             // if (eitp->user()) { continue; /*already processed*/ }
             if (graphpEdgesCounted.count(eitp)) { continue; /*already processed*/ }
-            AnyVertex* const fromp = dynamic_cast<AnyVertex*>(eitp->fromp());
-            UASSERT(fromp, "bad vertex type");
+            AnyVertex* const fromp = vtxCast<AnyVertex>(eitp->fromp());
             if (!origToClonep.count(fromp)) {
                 // not part of the new graph
                 continue;
             }
             auto newFromp = getClonep(fromp);
-            auto fromCompp = dynamic_cast<CompVertex*>(newFromp);
-            auto fromConstrp = dynamic_cast<ConstrVertex*>(newFromp);
-            auto toCompp = dynamic_cast<CompVertex*>(itp);
-            auto toConstrp = dynamic_cast<ConstrVertex*>(itp);
+            auto fromCompp = newFromp->cast<CompVertex>();
+            auto fromConstrp = newFromp->cast<ConstrVertex>();
+            auto toCompp = vtxCast<CompVertex>(itp);
+            auto toConstrp = vtxCast<ConstrVertex>(itp);
             if (fromCompp && toConstrp) {
                 builderp->addEdge(fromCompp, toConstrp);
             } else if (fromConstrp && toCompp) {
@@ -524,7 +527,7 @@ std::vector<std::vector<AnyVertex*>> groupCommits(const std::unique_ptr<DepGraph
     // AstVarScope::user1p()  -> pointer to ConstrDefVertex
     VNUser1InUse m_user1InUse;
     for (V3GraphVertex* vtxp = graphp->verticesBeginp(); vtxp; vtxp = vtxp->verticesNextp()) {
-        if (auto defp = dynamic_cast<ConstrDefVertex*>(vtxp)) {
+        if (auto defp = vtxCast<ConstrDefVertex>(vtxp)) {
             if (VN_IS(defp->vscp()->varp()->dtypep(), UnpackArrayDType)) {
 
                 UINFO(3, "visited unpack variable " << defp->vscp()->name() << endl);
@@ -540,10 +543,8 @@ std::vector<std::vector<AnyVertex*>> groupCommits(const std::unique_ptr<DepGraph
         if (!VN_IS(compp->nodep(), Always) || !compp->domainp()) { return false; }
         bool hasNoDataDef = true;
         for (V3GraphEdge* outp = compp->outBeginp(); outp; outp = outp->outNextp()) {
-            auto initp = dynamic_cast<ConstrInitVertex*>(outp->top());
-            UASSERT(!initp, "INIT node not expected!");
-            if (dynamic_cast<ConstrCommitVertex*>(outp->top())
-                || dynamic_cast<ConstrDefVertex*>(outp->top())) {
+            UASSERT(!vtxIs<ConstrInitVertex>(outp->top()), "INIT node not expected!");
+            if (vtxIs<ConstrCommitVertex>(outp->top()) || vtxIs<ConstrDefVertex>(outp->top())) {
                 hasNoDataDef = false;
                 break;
             }
@@ -557,10 +558,10 @@ std::vector<std::vector<AnyVertex*>> groupCommits(const std::unique_ptr<DepGraph
     };
 
     for (auto* vtxp = graphp->verticesBeginp(); vtxp; vtxp = vtxp->verticesNextp()) {
-        if (auto commitp = dynamic_cast<ConstrCommitVertex*>(vtxp)) {
+        if (auto commitp = vtxCast<ConstrCommitVertex>(vtxp)) {
             sets.makeSet(commitp);
             allCommitsp.push_back(commitp);
-        } else if (auto compp = dynamic_cast<CompVertex*>(vtxp)) {
+        } else if (auto compp = vtxCast<CompVertex>(vtxp)) {
             if (isSinkComp(compp)) { sets.makeSet(compp); }
         }
     }
@@ -571,7 +572,7 @@ std::vector<std::vector<AnyVertex*>> groupCommits(const std::unique_ptr<DepGraph
     auto visitNeighbors = [&sets](ConstrCommitVertex* commitp, GraphWay way) {
         bool forward = way.forward();
         for (V3GraphEdge* edgep = commitp->beginp(way); edgep; edgep = edgep->nextp(way)) {
-            CompVertex* const compp = dynamic_cast<CompVertex*>(edgep->furtherp(way));
+            CompVertex* const compp = vtxCast<CompVertex>(edgep->furtherp(way));
             UASSERT(compp, "expected compute node");
             UASSERT(VN_IS(compp->nodep(), Always) || VN_IS(compp->nodep(), AlwaysPost)
                         || VN_IS(compp->nodep(), AssignPost),
@@ -580,7 +581,7 @@ std::vector<std::vector<AnyVertex*>> groupCommits(const std::unique_ptr<DepGraph
             for (V3GraphEdge* fEdgep = compp->beginp(way.invert()); fEdgep;
                  fEdgep = fEdgep->nextp(way.invert())) {
                 ConstrCommitVertex* otherp
-                    = dynamic_cast<ConstrCommitVertex*>(fEdgep->furtherp(way.invert()));
+                    = vtxCast<ConstrCommitVertex>(fEdgep->furtherp(way.invert()));
                 if (!otherp || otherp == commitp) continue;
                 sets.makeUnion(commitp, otherp);
             }
@@ -600,7 +601,7 @@ std::vector<std::vector<AnyVertex*>> groupCommits(const std::unique_ptr<DepGraph
             return;
         }
 
-        auto defp = dynamic_cast<ConstrDefVertex*>(commitp->vscp()->user1u().toGraphVertex());
+        auto defp = vtxCast<ConstrDefVertex>(commitp->vscp()->user1u().toGraphVertex());
         UASSERT_OBJ(defp, commitp->vscp(),
                     "not all unpack variables are visited?" << commitp->vscp()->user1p() << endl);
         UINFO(3, "grouping partitions using unpack variable "
@@ -615,20 +616,17 @@ std::vector<std::vector<AnyVertex*>> groupCommits(const std::unique_ptr<DepGraph
         while (!toVisit.empty()) {
             AnyVertex* const headp = toVisit.front();
             toVisit.pop();
-            if (ConstrCommitVertex* const otherp
-                = dynamic_cast<ConstrCommitVertex* const>(headp)) {
+            if (ConstrCommitVertex* const otherp = headp->cast<ConstrCommitVertex>()) {
                 sets.makeUnion(commitp, otherp);
-            } else if (CompVertex* const compp = dynamic_cast<CompVertex* const>(headp)) {
+            } else if (CompVertex* const compp = headp->cast<CompVertex>()) {
                 if (isSinkComp(compp)) { sets.makeUnion(commitp, compp); }
             }
             // follow forward
             for (V3GraphEdge* edgep = headp->outBeginp(); edgep; edgep = edgep->outNextp()) {
                 if (!edgep->top()->user()) {
-                    AnyVertex* const top = dynamic_cast<AnyVertex* const>(edgep->top());
-                    UASSERT(top, "invalid vertex type?");
+                    AnyVertex* const top = vtxCast<AnyVertex>(edgep->top());
                     top->user(1);
-                    if (!dynamic_cast<ConstrPostVertex* const>(top)
-                        && !dynamic_cast<ConstrInitVertex* const>(top)) {
+                    if (!top->is<ConstrPostVertex>() && !top->is<ConstrInitVertex>()) {
                         // only follow data deps
                         toVisit.push(top);
                     }
@@ -670,18 +668,40 @@ std::vector<std::vector<AnyVertex*>> groupCommits(const std::unique_ptr<DepGraph
 
 };  // namespace
 
+std::atomic<size_t> DepGraphArena::s_liveBytes{0};
+std::atomic<size_t> DepGraphArena::s_peakBytes{0};
+
+void DepGraphArena::reserve(size_t bytes) {
+    const size_t slabBytes = std::max(bytes, SLAB_BYTES);
+    m_slabsp.emplace_back(new uint8_t[slabBytes]);
+    m_nextp = m_slabsp.back().get();
+    m_left = slabBytes;
+    m_bytes += slabBytes;
+    const size_t live = (s_liveBytes += slabBytes);
+    size_t peak = s_peakBytes.load();
+    while (live > peak && !s_peakBytes.compare_exchange_weak(peak, live)) {}
+}
+
+size_t DepGraphArena::takePeakBytes() { return s_peakBytes.exchange(s_liveBytes.load()); }
+
+uint32_t CompVertex::cost(std::ostream* osp) const {
+    const uint32_t estimate = V3InstrCount::count(nodep(), false, osp);
+    if (m_costScale == 1.0f || estimate == 0) return estimate;
+    return std::max(1U, static_cast<uint32_t>(std::round(estimate * m_costScale)));
+}
+
 // set the a hash value for each vertex
 void DepGraph::rehash() {
 
     V3Hasher nodeHasher;
     for (V3GraphVertex* vtxp = this->verticesBeginp(); vtxp; vtxp = vtxp->verticesNextp()) {
         V3Hash hash;
-        if (auto compp = dynamic_cast<CompVertex* const>(vtxp)) {
+        if (auto compp = vtxCast<CompVertex>(vtxp)) {
             hash += "COMP";
             hash += nodeHasher(compp->nodep());
             if (compp->domainp()) { hash += nodeHasher(compp->domainp()); }
             compp->hash(hash);
-        } else if (auto constrp = dynamic_cast<ConstrVertex* const>(vtxp)) {
+        } else if (auto constrp = vtxCast<ConstrVertex>(vtxp)) {
             hash += constrp->nameSuffix();
             hash += nodeHasher(constrp->vscp());
             constrp->hash(hash);
@@ -24,47 +24,133 @@
 #include "V3Ast.h"
 #include "V3Graph.h"
 #include "V3Sched.h"
+
+#include <atomic>
+#include <unordered_set>
 namespace V3BspSched {
 
 //=============================================================================
 class CompVertex;
 class ConstrVertex;
 class AnyVertex;
+
+//=============================================================================
+// Bump allocator owning the vertices and edges of a single DepGraph. Nothing is
+// released before the whole arena is destroyed, deleting a vertex or an edge only
+// runs its destructor.
+
+class DepGraphArena final {
+private:
+    static constexpr size_t SLAB_BYTES = 64 * 1024;
+    static constexpr size_t ALIGN = alignof(std::max_align_t);
+    std::vector<std::unique_ptr<uint8_t[]>> m_slabsp;  // Owned memory
+    uint8_t* m_nextp = nullptr;  // Next free byte in the current slab
+    size_t m_left = 0;  // Bytes left in the current slab
+    size_t m_bytes = 0;  // Bytes reserved by this arena
+    // Bytes reserved by all live arenas and the high-water mark, for V3Stats
+    static std::atomic<size_t> s_liveBytes;
+    static std::atomic<size_t> s_peakBytes;
+    void reserve(size_t bytes);
+
+public:
+    DepGraphArena() = default;
+    ~DepGraphArena() { s_liveBytes -= m_bytes; }
+    VL_UNCOPYABLE(DepGraphArena);
+    inline void* alloc(size_t size) {
+        size = (size + ALIGN - 1) & ~(ALIGN - 1);
+        if (VL_UNLIKELY(size > m_left)) reserve(size);
+        void* const objp = m_nextp;
+        m_nextp += size;
+        m_left -= size;
+        return objp;
+    }
+    size_t bytes() const { return m_bytes; }
+    // Peak number of bytes held by all arenas since the last call, resets the peak
+    static size_t takePeakBytes();
+};
+
 //=============================================================================
 // Graph type
 
 class DepGraph final : public V3Graph {
 private:
     AstModule* m_modp = nullptr;
+    DepGraphArena m_arena;
+    // Variables recomputed here but owned by another partition, see V3BspLookahead
+    std::unordered_set<const AstVarScope*> m_replicas;
+    // Commits and sink logic this graph was collected from, see V3BspPartitionCache
+    std::vector<const AstNode*> m_rootps;
 
 public:
+    DepGraph() = default;
+    // Delete the vertices and edges while the arena backing them is still alive
+    ~DepGraph() override { clear(); }
+    DepGraphArena& arena() { return m_arena; }
     // METHODS
     // All edges are noncuttable, but there is never and edge between two compute vertices
     inline void addEdge(CompVertex* fromp, ConstrVertex* top);
     inline void addEdge(ConstrVertex* fromp, CompVertex* top);
+    // Number of vertices, O(V)
+    size_t vertexCount() const {
+        size_t n = 0;
+        for (const V3GraphVertex* vtxp = verticesBeginp(); vtxp; vtxp = vtxp->verticesNextp()) {
+            ++n;
+        }
+        return n;
+    }
     inline AstModule* modp() const { return m_modp; }
     inline void modp(AstModule* modp) { m_modp = modp; }
+    inline bool isReplica(const AstVarScope* vscp) const { return m_replicas.count(vscp); }
+    inline void addReplica(const AstVarScope* vscp) { m_replicas.insert(vscp); }
+    inline bool hasReplicas() const { return !m_replicas.empty(); }
+    inline void addRootp(const AstNode* nodep) { m_rootps.push_back(nodep); }
+    inline const std::vector<const AstNode*>& rootps() const { return m_rootps; }
     void rehash();
 };
 
 //=============================================================================
 // Vertex types
 
-// abstract vertex type, all other types are derived from BspDepVertex
+// Concrete vertex type, lets passes dispatch with a switch rather than dynamic_cast
+enum class DepVertexKind : uint8_t { COMP = 0, INIT, DEF, COMMIT, POST, NUM_KINDS };
+
+// abstract vertex type, all other types are derived from BspDepVertex.
+// Vertices are allocated in the arena of their graph: new (graphp) CompVertex{graphp, ...}
 class AnyVertex VL_NOT_FINAL : public V3GraphVertex {
 private:
     AstSenTree* m_domainp = nullptr;
     V3Hash m_hash;
+    const DepVertexKind m_kind;
 
 protected:
     // CONSTRUCTOR
-    AnyVertex(DepGraph* graphp, AstSenTree* domainp)
+    AnyVertex(DepGraph* graphp, AstSenTree* domainp, DepVertexKind kind)
         : V3GraphVertex{graphp}
         , m_domainp{domainp}
-        , m_hash{} {}
+        , m_hash{}
+        , m_kind{kind} {}
     ~AnyVertex() override = default;
 
 public:
+    static void* operator new(size_t size, DepGraph* graphp) {
+        return graphp->arena().alloc(size);
+    }
+    static void* operator new(size_t size) = delete;
+    // Memory is reclaimed with the arena
+    static void operator delete(void*, DepGraph*) {}
+    static void operator delete(void*, size_t) {}
+
+    static constexpr bool isKind(DepVertexKind) { return true; }
+    DepVertexKind kind() const { return m_kind; }
+    template <typename T>
+    bool is() const {
+        return T::isKind(m_kind);
+    }
+    template <typename T>
+    T* cast() {
+        return is<T>() ? static_cast<T*>(this) : nullptr;
+    }
+
     // METHODS
     V3Hash hash() const { return m_hash; }
     void hash(const V3Hash h) { m_hash = h; }
@@ -83,10 +169,11 @@ private:
     AstNode* const m_nodep;  // the logic represented by this vertex
     AstScope* const m_scopep;  // the scope that m_nodep belongs to
     AstActive* const m_activep;  // the active aroudn the logic
+    float m_costScale = 1.0f;  // measured over estimated cost, see --bsp-profile-use
 public:
     CompVertex(DepGraph* graphp, AstScope* scopep, AstNode* nodep, AstSenTree* domainp,
                AstActive* activep)
-        : AnyVertex{graphp, domainp}
+        : AnyVertex{graphp, domainp, DepVertexKind::COMP}
         , m_nodep{nodep}
         , m_scopep{scopep}
         , m_activep{activep} {
@@ -94,12 +181,20 @@ public:
         UASSERT(nodep, "Can not have null logic!");
     }
     ~CompVertex() override = default;
+    static constexpr bool isKind(DepVertexKind k) { return k == DepVertexKind::COMP; }
 
     AstNode* nodep() const { return m_nodep; }
     AstScope* scopep() const { return m_scopep; }
     AstActive* activep() const { return m_activep; }
+    float costScale() const { return m_costScale; }
+    void costScale(float s) { m_costScale = s; }
+    // Estimated cost of the logic, scaled by costScale()
+    uint32_t cost(std::ostream* osp = nullptr) const;
     CompVertex* clone(DepGraph* graphp) const override {
-        return new CompVertex{graphp, scopep(), nodep(), domainp(), activep()};
+        CompVertex* const clonep
+            = new (graphp) CompVertex{graphp, scopep(), nodep(), domainp(), activep()};
+        clonep->costScale(costScale());
+        return clonep;
     }
     // LCOV_EXCL_START // Debug code
     string name() const override {
@@ -114,10 +209,11 @@ class ConstrVertex VL_NOT_FINAL : public AnyVertex {
 private:
     AstVarScope* const m_vscp;  // the variable scope that this ordering constraint references
 public:
-    ConstrVertex(DepGraph* graphp, AstVarScope* vscp)
-        : AnyVertex{graphp, nullptr}
+    ConstrVertex(DepGraph* graphp, AstVarScope* vscp, DepVertexKind kind)
+        : AnyVertex{graphp, nullptr, kind}
         , m_vscp{vscp} {}
     ~ConstrVertex() override = default;
+    static constexpr bool isKind(DepVertexKind k) { return k != DepVertexKind::COMP; }
 
     // ACCESSOR
     AstVarScope* vscp() const { return m_vscp; }
@@ -135,10 +231,11 @@ class ConstrInitVertex final : public ConstrVertex {
 public:
     // CONSTRUCTOR
     ConstrInitVertex(DepGraph* graphp, AstVarScope* vscp)
-        : ConstrVertex{graphp, vscp} {}
+        : ConstrVertex{graphp, vscp, DepVertexKind::INIT} {}
     ~ConstrInitVertex() override = default;
+    static constexpr bool isKind(DepVertexKind k) { return k == DepVertexKind::INIT; }
     ConstrInitVertex* clone(DepGraph* graphp) const override {
-        return new ConstrInitVertex{graphp, vscp()};
+        return new (graphp) ConstrInitVertex{graphp, vscp()};
     }
     // LCOV_EXCL_START // Debug code
     string nameSuffix() const override { return "INIT"; }
@@ -150,10 +247,11 @@ class ConstrDefVertex final : public ConstrVertex {
 public:
     // CONSTRUCTOR
     ConstrDefVertex(DepGraph* graphp, AstVarScope* vscp)
-        : ConstrVertex{graphp, vscp} {}
+        : ConstrVertex{graphp, vscp, DepVertexKind::DEF} {}
     ~ConstrDefVertex() override = default;
+    static constexpr bool isKind(DepVertexKind k) { return k == DepVertexKind::DEF; }
     ConstrDefVertex* clone(DepGraph* graphp) const override {
-        return new ConstrDefVertex{graphp, vscp()};
+        return new (graphp) ConstrDefVertex{graphp, vscp()};
     }
     // LCOV_EXCL_START // Debug code
     string nameSuffix() const override { return "DEF"; }
@@ -165,10 +263,11 @@ class ConstrCommitVertex final : public ConstrVertex {
 public:
     // CONSTRUCTOR
     ConstrCommitVertex(DepGraph* graphp, AstVarScope* vscp)
-        : ConstrVertex{graphp, vscp} {}
+        : ConstrVertex{graphp, vscp, DepVertexKind::COMMIT} {}
     ~ConstrCommitVertex() override = default;
+    static constexpr bool isKind(DepVertexKind k) { return k == DepVertexKind::COMMIT; }
     ConstrCommitVertex* clone(DepGraph* graphp) const override {
-        return new ConstrCommitVertex{graphp, vscp()};
+        return new (graphp) ConstrCommitVertex{graphp, vscp()};
     }
     // LCOV_EXCL_START // Debug code
     string nameSuffix() const override { return "COMMIT"; }
@@ -180,10 +279,11 @@ class ConstrPostVertex final : public ConstrVertex {
 public:
     // CONSTRUCTOR
     ConstrPostVertex(DepGraph* graphp, AstVarScope* vscp)
-        : ConstrVertex{graphp, vscp} {}
+        : ConstrVertex{graphp, vscp, DepVertexKind::POST} {}
     ~ConstrPostVertex() override = default;
+    static constexpr bool isKind(DepVertexKind k) { return k == DepVertexKind::POST; }
     ConstrPostVertex* clone(DepGraph* graphp) const override {
-        return new ConstrPostVertex{graphp, vscp()};
+        return new (graphp) ConstrPostVertex{graphp, vscp()};
     }
     // LCOV_EXCL_START // Debug code
     string nameSuffix() const override { return "POST"; }
@@ -200,13 +300,34 @@ private:
     DepEdge(DepGraph* graphp, AnyVertex* fromp, AnyVertex* top)
         : V3GraphEdge{graphp, fromp, top, 1, false /*not cuttable*/} {}
     ~DepEdge() override = default;
+    static void* operator new(size_t size, DepGraph* graphp) {
+        return graphp->arena().alloc(size);
+    }
+    static void operator delete(void*, DepGraph*) {}
 
 public:
+    static void operator delete(void*, size_t) {}
     string dotColor() const override { return "red"; }
 };
 
-void DepGraph::addEdge(CompVertex* fromp, ConstrVertex* top) { new DepEdge{this, fromp, top}; }
-void DepGraph::addEdge(ConstrVertex* fromp, CompVertex* top) { new DepEdge{this, fromp, top}; }
+void DepGraph::addEdge(CompVertex* fromp, ConstrVertex* top) {
+    new (this) DepEdge{this, fromp, top};
+}
+void DepGraph::addEdge(ConstrVertex* fromp, CompVertex* top) {
+    new (this) DepEdge{this, fromp, top};
+}
+
+//==============================================================================
+// Kind checked casts for vertices of a DepGraph, like VN_IS/VN_CAST for AstNode
+
+template <typename T>
+inline bool vtxIs(V3GraphVertex* vtxp) {
+    return vtxp && static_cast<AnyVertex*>(vtxp)->is<T>();
+}
+template <typename T>
+inline T* vtxCast(V3GraphVertex* vtxp) {
+    return vtxp ? static_cast<AnyVertex*>(vtxp)->cast<T>() : nullptr;
+}
 
 //==============================================================================
 // builder class
@@ -21,8 +21,8 @@
 
 #include "V3Ast.h"
 #include "V3AstUserAllocator.h"
+#include "V3BspHyperPartitioner.h"
 #include "V3BspMerger.h"
-#include "V3InstrCount.h"
 #include "V3Stats.h"
 
 #include <V3File.h>
@@ -106,12 +106,12 @@ private:
             uint32_t totalMem = 0;
             for (V3GraphVertex* vtxp = graphp->verticesBeginp(); vtxp;
                  vtxp = vtxp->verticesNextp()) {
-                if (CompVertex* const compp = dynamic_cast<CompVertex*>(vtxp)) {
+                if (CompVertex* const compp = vtxCast<CompVertex>(vtxp)) {
                     auto& info = m_compInfo(compp->nodep());
                     info.users.push_back(gix);
                     if (info.users.size() == 1) {
                         // compute the cost
-                        info.cost = V3InstrCount::count(compp->nodep(), false);
+                        info.cost = compp->cost();
                         sequentialCost += info.cost;
                     }
                     UASSERT(info.cost != 0, "zero cost AstNode?");
@@ -126,12 +126,12 @@ private:
                         // be from another dependence graph (i.e., fiber).
                     }
                 }
-                ConstrDefVertex* const defp = dynamic_cast<ConstrDefVertex*>(vtxp);
+                ConstrDefVertex* const defp = vtxCast<ConstrDefVertex>(vtxp);
                 if (defp && defp->inEmpty() && !memoryUsageCounted(defp->vscp())) {
                     totalMem += memoryUsage(defp->vscp());
                     memoryUsageMark(defp->vscp());
                 }
-                ConstrCommitVertex* const commitp = dynamic_cast<ConstrCommitVertex*>(vtxp);
+                ConstrCommitVertex* const commitp = vtxCast<ConstrCommitVertex>(vtxp);
                 if (commitp && !memoryUsageCounted(commitp->vscp())) {
                     totalMem += memoryUsage(commitp->vscp());
                     memoryUsageMark(commitp->vscp());
@@ -176,12 +176,6 @@ private:
             }
         }
 
-        // Call KaHyPar
-        kahypar_context_t* kcontextp = kahypar_context_new();
-        kahypar_configure_context_from_file(
-            kcontextp,
-            (v3Global.opt.getenvPARENDI_ROOT() + "/include/vlpoplar/KaHyParConfigMerge.ini")
-                .c_str());
         const double imbalance = 0.03;
         const HyperNodeId numNodes = hyperNodeWeights.size();
         const HyperEdgeId numEdges = hyperEdgeWeights.size();
@@ -228,12 +222,38 @@ private:
             ofs->close();
         }
 
-        kahypar_hyperedge_weight_t objective;
-        UINFO(3, "Starting KaHyPar partitioner " << std::endl);
-        kahypar_partition(numNodes, numEdges, imbalance, ways(), hyperNodeWeights.data(),
-                          hyperEdgeWeights.data(), hyperEdgePtr.data(), hyperEdges.data(),
-                          &objective, kcontextp, partitions.data());
-        UINFO(3, "Objective: " << objective << endl);
+        if (v3Global.opt.ipuMergeStrategy().parallelHypergraph()) {
+            // Same balance constraint as KaHyPar: (1 + imbalance) * ceil(total / ways)
+            const int64_t totalWeight
+                = std::accumulate(hyperNodeWeights.begin(), hyperNodeWeights.end(), int64_t{0});
+            const int64_t maxBlockWeight
+                = (1.0 + imbalance) * ((totalWeight + ways() - 1) / ways());
+            Hypergraph graph;
+            graph.nodeWeights.assign(hyperNodeWeights.begin(), hyperNodeWeights.end());
+            graph.edgeWeights.assign(hyperEdgeWeights.begin(), hyperEdgeWeights.end());
+            graph.edgePtr.assign(hyperEdgePtr.begin(), hyperEdgePtr.end());
+            graph.pins.assign(hyperEdges.begin(), hyperEdges.end());
+            int64_t objective = 0;
+            UINFO(3, "Starting parallel hypergraph partitioner " << std::endl);
+            const std::vector<int32_t> blocks = V3BspHyperPartitioner::partition(
+                graph, std::vector<int64_t>(ways(), maxBlockWeight),
+                V3BspHyperPartitioner::Objective::KM1, &objective);
+            std::copy(blocks.begin(), blocks.end(), partitions.begin());
+            UINFO(3, "Objective: " << objective << endl);
+        } else {
+            // Call KaHyPar
+            kahypar_context_t* kcontextp = kahypar_context_new();
+            kahypar_configure_context_from_file(
+                kcontextp,
+                (v3Global.opt.getenvPARENDI_ROOT() + "/include/vlpoplar/KaHyParConfigMerge.ini")
+                    .c_str());
+            kahypar_hyperedge_weight_t objective;
+            UINFO(3, "Starting KaHyPar partitioner " << std::endl);
+            kahypar_partition(numNodes, numEdges, imbalance, ways(), hyperNodeWeights.data(),
+                              hyperEdgeWeights.data(), hyperEdgePtr.data(), hyperEdges.data(),
+                              &objective, kcontextp, partitions.data());
+            UINFO(3, "Objective: " << objective << endl);
+        }
 
         std::vector<std::vector<std::size_t>> indicesTmp;
         indicesTmp.resize(ways());
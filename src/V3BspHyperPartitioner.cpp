@@ -0,0 +1,540 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator BSP: Parallel multilevel hypergraph partitioner
+//
+// Code available from: https://verilator.org
+//
+//*************************************************************************
+//
+// Copyright 2003-2023 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+
+#include "V3BspHyperPartitioner.h"
+
+#include "V3Error.h"
+#include "V3Global.h"
+#include "V3ThreadPool.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <set>
+#include <unordered_map>
+
+VL_DEFINE_DEBUG_FUNCTIONS;
+
+namespace V3BspSched {
+namespace {
+
+using NodeId = uint32_t;
+using EdgeId = uint32_t;
+using PartId = int32_t;
+using Weight = int64_t;
+using Objective = V3BspHyperPartitioner::Objective;
+
+constexpr NodeId INVALID_NODE = std::numeric_limits<NodeId>::max();
+constexpr PartId INVALID_PART = -1;
+// Larger edges are not used to rate or grow, like cmaxnet of KaHyParConfig.ini
+constexpr std::size_t LARGE_EDGE = 1000;
+constexpr int INITIAL_RUNS = 8;
+constexpr int REFINE_ROUNDS = 8;
+// Coarsening stops once a level removes fewer nodes than this fraction
+constexpr double MIN_SHRINK = 0.025;
+
+// Call fn(begin, end) for chunks of [0, size), on the thread pool if parallel. Each call
+// should only write the slots of its own chunk.
+template <typename T_Fn>
+void parallelFor(bool parallel, std::size_t size, T_Fn&& fn) {
+    const std::size_t jobs = std::max(1, v3Global.opt.verilateJobs());
+    const std::size_t chunks = parallel ? std::min(size, jobs * 4) : 1;
+    if (chunks <= 1) {
+        fn(std::size_t{0}, size);
+        return;
+    }
+    std::vector<std::future<void>> futures;
+    for (std::size_t c = 0; c < chunks; ++c) {
+        const std::size_t begin = size * c / chunks;
+        const std::size_t end = size * (c + 1) / chunks;
+        futures.push_back(V3ThreadPool::s().enqueue(
+            std::function<void()>{[&fn, begin, end]() { fn(begin, end); }}));
+    }
+    for (auto& future : futures) V3ThreadPool::s().waitForFuture(future);
+}
+
+std::size_t edgeSize(const Hypergraph& g, EdgeId e) { return g.edgePtr[e + 1] - g.edgePtr[e]; }
+
+// The edges of every node, the inverse of the pin lists
+struct Incidence final {
+    std::vector<std::size_t> ptr;  // edges of u: edges[ptr[u]] ... edges[ptr[u + 1] - 1]
+    std::vector<EdgeId> edges;
+    explicit Incidence(const Hypergraph& g)
+        : ptr(g.numNodes() + 1, 0)
+        , edges(g.pins.size()) {
+        for (const NodeId pin : g.pins) ++ptr[pin + 1];
+        std::partial_sum(ptr.begin(), ptr.end(), ptr.begin());
+        std::vector<std::size_t> pos{ptr.begin(), ptr.end() - 1};
+        for (EdgeId e = 0; e < g.numEdges(); ++e) {
+            for (std::size_t i = g.edgePtr[e]; i < g.edgePtr[e + 1]; ++i) {
+                edges[pos[g.pins[i]]++] = e;
+            }
+        }
+    }
+};
+
+//######################################################################
+// Coarsening
+
+struct Level final {
+    Hypergraph graph;  // The contracted hypergraph
+    std::vector<NodeId> coarseOf;  // Node of graph for every node of the finer level
+};
+
+// The neighbor with the best heavy-edge rating of every node
+std::vector<NodeId> ratePartners(const Hypergraph& g, const Incidence& inc,
+                                 Weight maxNodeWeight) {
+    std::vector<NodeId> best(g.numNodes(), INVALID_NODE);
+    parallelFor(true, g.numNodes(), [&](std::size_t begin, std::size_t end) {
+        std::unordered_map<NodeId, double> ratings;
+        for (NodeId u = begin; u < end; ++u) {
+            ratings.clear();
+            for (std::size_t i = inc.ptr[u]; i < inc.ptr[u + 1]; ++i) {
+                const EdgeId e = inc.edges[i];
+                const std::size_t size = edgeSize(g, e);
+                if (size < 2 || size > LARGE_EDGE) continue;
+                const double score = static_cast<double>(g.edgeWeights[e]) / (size - 1);
+                for (std::size_t j = g.edgePtr[e]; j < g.edgePtr[e + 1]; ++j) {
+                    if (g.pins[j] != u) ratings[g.pins[j]] += score;
+                }
+            }
+            double bestRating = 0.0;
+            for (const auto& pair : ratings) {
+                const NodeId v = pair.first;
+                if (g.nodeWeights[u] + g.nodeWeights[v] > maxNodeWeight) continue;
+                // prefer light pairs, so that the coarse nodes stay similar in weight
+                const double rating
+                    = pair.second
+                      / (std::max<double>(1, g.nodeWeights[u]) * std::max<double>(1, g.nodeWeights[v]));
+                if (rating > bestRating || (rating == bestRating && rating > 0 && v < best[u])) {
+                    bestRating = rating;
+                    best[u] = v;
+                }
+            }
+        }
+    });
+    return best;
+}
+
+// Contract pairs of preferred partners, returns false if the hypergraph hardly shrinks
+bool coarsen(const Hypergraph& g, Weight maxNodeWeight, Level& level) {
+    const Incidence inc{g};
+    const std::vector<NodeId> best = ratePartners(g, inc, maxNodeWeight);
+    // match in node order, a node may still join an earlier partner left alone
+    std::vector<NodeId>& coarseOf = level.coarseOf;
+    coarseOf.assign(g.numNodes(), INVALID_NODE);
+    std::vector<bool> paired(g.numNodes(), false);
+    NodeId numCoarse = 0;
+    for (NodeId u = 0; u < g.numNodes(); ++u) {
+        if (coarseOf[u] != INVALID_NODE) continue;
+        const NodeId v = best[u];
+        if (v != INVALID_NODE && v < u && !paired[v]) {
+            coarseOf[u] = coarseOf[v];
+            paired[u] = paired[v] = true;
+            continue;
+        }
+        coarseOf[u] = numCoarse++;
+        if (v != INVALID_NODE && v > u && coarseOf[v] == INVALID_NODE) {
+            coarseOf[v] = coarseOf[u];
+            paired[u] = paired[v] = true;
+        }
+    }
+    if (numCoarse > g.numNodes() * (1.0 - MIN_SHRINK)) return false;
+
+    Hypergraph& c = level.graph;
+    c.nodeWeights.assign(numCoarse, 0);
+    for (NodeId u = 0; u < g.numNodes(); ++u) c.nodeWeights[coarseOf[u]] += g.nodeWeights[u];
+    // map the pins in parallel, single-pin edges disappear
+    std::vector<std::vector<NodeId>> edgePins(g.numEdges());
+    std::vector<uint64_t> edgeHash(g.numEdges());
+    parallelFor(true, g.numEdges(), [&](std::size_t begin, std::size_t end) {
+        for (EdgeId e = begin; e < end; ++e) {
+            std::vector<NodeId>& pins = edgePins[e];
+            for (std::size_t i = g.edgePtr[e]; i < g.edgePtr[e + 1]; ++i) {
+                pins.push_back(coarseOf[g.pins[i]]);
+            }
+            std::sort(pins.begin(), pins.end());
+            pins.erase(std::unique(pins.begin(), pins.end()), pins.end());
+            if (pins.size() < 2) pins.clear();
+            uint64_t hash = 14695981039346656037ULL;
+            for (const NodeId pin : pins) hash = (hash ^ pin) * 1099511628211ULL;
+            edgeHash[e] = hash;
+        }
+    });
+    // parallel edges become one, with the sum of the weights
+    std::unordered_multimap<uint64_t, EdgeId> coarseEdges;
+    c.edgePtr.push_back(0);
+    for (EdgeId e = 0; e < g.numEdges(); ++e) {
+        const std::vector<NodeId>& pins = edgePins[e];
+        if (pins.empty()) continue;
+        EdgeId same = INVALID_NODE;
+        const auto range = coarseEdges.equal_range(edgeHash[e]);
+        for (auto it = range.first; it != range.second; ++it) {
+            const EdgeId ce = it->second;
+            if (edgeSize(c, ce) == pins.size()
+                && std::equal(pins.begin(), pins.end(), c.pins.begin() + c.edgePtr[ce])) {
+                same = ce;
+                break;
+            }
+        }
+        if (same != INVALID_NODE) {
+            c.edgeWeights[same] += g.edgeWeights[e];
+            continue;
+        }
+        coarseEdges.emplace(edgeHash[e], c.numEdges());
+        c.edgeWeights.push_back(g.edgeWeights[e]);
+        c.pins.insert(c.pins.end(), pins.begin(), pins.end());
+        c.edgePtr.push_back(c.pins.size());
+    }
+    return true;
+}
+
+//######################################################################
+// Partition state and gains
+
+class PartitionState final {
+    const Hypergraph& m_g;
+    const Incidence m_inc;
+    const std::vector<Weight>& m_maxWeights;
+    const Objective m_objective;
+    std::vector<PartId> m_part;
+    std::vector<Weight> m_load;
+    // blocks with pins on every edge and their pin count, the connectivity is small
+    std::vector<std::vector<std::pair<PartId, uint32_t>>> m_pinCounts;
+
+    uint32_t pinCount(EdgeId e, PartId b) const {
+        for (const auto& pair : m_pinCounts[e]) {
+            if (pair.first == b) return pair.second;
+        }
+        return 0;
+    }
+    void addPin(EdgeId e, PartId b, int delta) {
+        auto& counts = m_pinCounts[e];
+        for (auto it = counts.begin(); it != counts.end(); ++it) {
+            if (it->first != b) continue;
+            it->second += delta;
+            if (!it->second) counts.erase(it);
+            return;
+        }
+        counts.emplace_back(b, 1);
+    }
+
+public:
+    PartitionState(const Hypergraph& g, const std::vector<Weight>& maxWeights,
+                   Objective objective, std::vector<PartId>&& part)
+        : m_g{g}
+        , m_inc{g}
+        , m_maxWeights{maxWeights}
+        , m_objective{objective}
+        , m_part{std::move(part)}
+        , m_load(maxWeights.size(), 0)
+        , m_pinCounts(g.numEdges()) {
+        for (NodeId u = 0; u < g.numNodes(); ++u) m_load[m_part[u]] += g.nodeWeights[u];
+        for (EdgeId e = 0; e < g.numEdges(); ++e) {
+            for (std::size_t i = g.edgePtr[e]; i < g.edgePtr[e + 1]; ++i) {
+                addPin(e, m_part[g.pins[i]], 1);
+            }
+        }
+    }
+    const Hypergraph& graph() const { return m_g; }
+    const std::vector<PartId>& part() const { return m_part; }
+    std::vector<PartId>& part() { return m_part; }
+    PartId numParts() const { return m_maxWeights.size(); }
+    Weight load(PartId b) const { return m_load[b]; }
+    Weight maxWeight(PartId b) const { return m_maxWeights[b]; }
+    bool fits(NodeId u, PartId b) const {
+        return m_load[b] + m_g.nodeWeights[u] <= m_maxWeights[b];
+    }
+    Weight overload() const {
+        Weight sum = 0;
+        for (PartId b = 0; b < numParts(); ++b) {
+            sum += std::max<Weight>(0, m_load[b] - m_maxWeights[b]);
+        }
+        return sum;
+    }
+    Weight objective() const {
+        Weight sum = 0;
+        for (EdgeId e = 0; e < m_g.numEdges(); ++e) {
+            const Weight lambda = m_pinCounts[e].size();
+            if (m_objective == Objective::KM1) {
+                sum += m_g.edgeWeights[e] * std::max<Weight>(0, lambda - 1);
+            } else if (lambda > 1) {
+                sum += m_g.edgeWeights[e];
+            }
+        }
+        return sum;
+    }
+    void move(NodeId u, PartId to) {
+        const PartId from = m_part[u];
+        for (std::size_t i = m_inc.ptr[u]; i < m_inc.ptr[u + 1]; ++i) {
+            addPin(m_inc.edges[i], from, -1);
+            addPin(m_inc.edges[i], to, 1);
+        }
+        m_load[from] -= m_g.nodeWeights[u];
+        m_load[to] += m_g.nodeWeights[u];
+        m_part[u] = to;
+    }
+    // Objective reduction of moving u to every block it shares an edge with, in gains.
+    // A block without pins on the edges of u can only make things worse.
+    void gains(NodeId u, std::unordered_map<PartId, Weight>& gains) const {
+        gains.clear();
+        const PartId from = m_part[u];
+        Weight base = 0;  // gain of leaving from
+        Weight all = 0;  // loss of joining a block without pins
+        for (std::size_t i = m_inc.ptr[u]; i < m_inc.ptr[u + 1]; ++i) {
+            const EdgeId e = m_inc.edges[i];
+            const Weight w = m_g.edgeWeights[e];
+            const uint32_t size = edgeSize(m_g, e);
+            all += w;
+            for (const auto& pair : m_pinCounts[e]) {
+                if (pair.first == from) {
+                    if (m_objective == Objective::KM1 ? pair.second == 1 : pair.second != size) {
+                        base += w;
+                    }
+                } else {
+                    Weight& gain = gains[pair.first];
+                    if (m_objective == Objective::KM1 || pair.second == size - 1) gain += w;
+                }
+            }
+        }
+        for (auto& pair : gains) pair.second += base - all;
+    }
+    Weight gain(NodeId u, PartId to, std::unordered_map<PartId, Weight>& scratch) const {
+        gains(u, scratch);
+        const auto it = scratch.find(to);
+        return it == scratch.end() ? std::numeric_limits<Weight>::min() : it->second;
+    }
+    // The feasible move of u with the highest positive gain, INVALID_PART if none
+    PartId bestMove(NodeId u, std::unordered_map<PartId, Weight>& scratch) const {
+        gains(u, scratch);
+        PartId best = INVALID_PART;
+        Weight bestGain = 0;
+        for (const auto& pair : scratch) {
+            if (pair.second <= 0 || !fits(u, pair.first)) continue;
+            if (pair.second > bestGain || (pair.second == bestGain && pair.first < best)) {
+                best = pair.first;
+                bestGain = pair.second;
+            }
+        }
+        return best;
+    }
+};
+
+// Label propagation: find the best move of every node in parallel against the current
+// state, then apply the moves in node order if they still improve and fit
+void refine(PartitionState& st, bool parallel) {
+    const NodeId numNodes = st.graph().numNodes();
+    std::vector<PartId> targets(numNodes);
+    for (int round = 0; round < REFINE_ROUNDS; ++round) {
+        const PartitionState& cst = st;
+        parallelFor(parallel, numNodes, [&](std::size_t begin, std::size_t end) {
+            std::unordered_map<PartId, Weight> scratch;
+            for (NodeId u = begin; u < end; ++u) targets[u] = cst.bestMove(u, scratch);
+        });
+        std::unordered_map<PartId, Weight> scratch;
+        std::size_t moves = 0;
+        for (NodeId u = 0; u < numNodes; ++u) {
+            const PartId to = targets[u];
+            if (to == INVALID_PART || !st.fits(u, to) || st.gain(u, to, scratch) <= 0) continue;
+            st.move(u, to);
+            ++moves;
+        }
+        UINFO(9, "BspHyperPartitioner refinement round " << round << ": " << moves << " moves"
+                                                         << endl);
+        if (!moves) break;
+    }
+}
+
+// Move the nodes of overloaded blocks to blocks with room, cheapest first
+void rebalance(PartitionState& st) {
+    const Hypergraph& g = st.graph();
+    std::vector<std::vector<NodeId>> nodesOf(st.numParts());
+    for (NodeId u = 0; u < g.numNodes(); ++u) nodesOf[st.part()[u]].push_back(u);
+    std::unordered_map<PartId, Weight> scratch;
+    for (PartId b = 0; b < st.numParts(); ++b) {
+        if (st.load(b) <= st.maxWeight(b)) continue;
+        std::vector<std::pair<Weight, NodeId>> candidates;
+        for (const NodeId u : nodesOf[b]) {
+            st.gains(u, scratch);
+            Weight best = std::numeric_limits<Weight>::min();
+            for (const auto& pair : scratch) best = std::max(best, pair.second);
+            candidates.emplace_back(-best, u);
+        }
+        std::sort(candidates.begin(), candidates.end());
+        for (const auto& pair : candidates) {
+            if (st.load(b) <= st.maxWeight(b)) break;
+            const NodeId u = pair.second;
+            PartId to = INVALID_PART;
+            Weight toGain = std::numeric_limits<Weight>::min();
+            st.gains(u, scratch);
+            for (const auto& gpair : scratch) {
+                if (st.fits(u, gpair.first)
+                    && (gpair.second > toGain || (gpair.second == toGain && gpair.first < to))) {
+                    to = gpair.first;
+                    toGain = gpair.second;
+                }
+            }
+            if (to == INVALID_PART) {
+                // no neighboring block has room, take the one with the most
+                for (PartId other = 0; other < st.numParts(); ++other) {
+                    if (other == b || !st.fits(u, other)) continue;
+                    if (to == INVALID_PART || st.load(other) < st.load(to)) to = other;
+                }
+            }
+            if (to != INVALID_PART) st.move(u, to);
+        }
+    }
+}
+
+//######################################################################
+// Initial partitioning
+
+// Greedy growing: heavy nodes first, each to the feasible block it is most connected to
+std::vector<PartId> growInitial(const Hypergraph& g, const Incidence& inc,
+                                const std::vector<Weight>& maxWeights, uint32_t seed) {
+    const PartId numParts = maxWeights.size();
+    std::vector<NodeId> order(g.numNodes());
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<uint32_t> keys(g.numNodes());
+    std::mt19937 rng{seed};
+    for (uint32_t& key : keys) key = rng();
+    std::sort(order.begin(), order.end(), [&](NodeId a, NodeId b) {
+        if (g.nodeWeights[a] != g.nodeWeights[b]) return g.nodeWeights[a] > g.nodeWeights[b];
+        return keys[a] < keys[b];
+    });
+    std::vector<PartId> part(g.numNodes(), INVALID_PART);
+    std::vector<Weight> load(numParts, 0);
+    // blocks by the room left, to find the emptiest one
+    std::set<std::pair<Weight, PartId>> byRoom;
+    for (PartId b = 0; b < numParts; ++b) byRoom.emplace(-maxWeights[b], b);
+    std::unordered_map<PartId, double> scores;
+    for (const NodeId u : order) {
+        scores.clear();
+        for (std::size_t i = inc.ptr[u]; i < inc.ptr[u + 1]; ++i) {
+            const EdgeId e = inc.edges[i];
+            const std::size_t size = edgeSize(g, e);
+            if (size < 2 || size > LARGE_EDGE) continue;
+            const double score = static_cast<double>(g.edgeWeights[e]) / (size - 1);
+            for (std::size_t j = g.edgePtr[e]; j < g.edgePtr[e + 1]; ++j) {
+                const PartId b = part[g.pins[j]];
+                if (b != INVALID_PART) scores[b] += score;
+            }
+        }
+        PartId to = INVALID_PART;
+        double toScore = 0.0;
+        for (const auto& pair : scores) {
+            if (load[pair.first] + g.nodeWeights[u] > maxWeights[pair.first]) continue;
+            if (pair.second > toScore || (pair.second == toScore && pair.first < to)) {
+                to = pair.first;
+                toScore = pair.second;
+            }
+        }
+        if (to == INVALID_PART) to = byRoom.begin()->second;
+        byRoom.erase({load[to] - maxWeights[to], to});
+        load[to] += g.nodeWeights[u];
+        byRoom.emplace(load[to] - maxWeights[to], to);
+        part[u] = to;
+    }
+    return part;
+}
+
+// Several growing runs with different orders, each rebalanced and refined, keep the best
+std::vector<PartId> initialPartition(const Hypergraph& g, const std::vector<Weight>& maxWeights,
+                                     Objective objective) {
+    struct Run {
+        Weight overload;
+        Weight objective;
+        std::vector<PartId> part;
+    };
+    const Incidence inc{g};
+    std::vector<std::future<Run>> futures;
+    for (int run = 0; run < INITIAL_RUNS; ++run) {
+        futures.push_back(V3ThreadPool::s().enqueue(std::function<Run()>{[&, run]() {
+            PartitionState st{g, maxWeights, objective, growInitial(g, inc, maxWeights, run)};
+            rebalance(st);
+            refine(st, false);  // already on a worker
+            return Run{st.overload(), st.objective(), std::move(st.part())};
+        }}));
+    }
+    Run best{std::numeric_limits<Weight>::max(), std::numeric_limits<Weight>::max(), {}};
+    for (int run = 0; run < INITIAL_RUNS; ++run) {
+        Run result = V3ThreadPool::s().waitForFuture(futures[run]);
+        UINFO(5, "BspHyperPartitioner initial run " << run << ": overload " << result.overload
+                                                    << " objective " << result.objective << endl);
+        if (std::make_pair(result.overload, result.objective)
+            < std::make_pair(best.overload, best.objective)) {
+            best = std::move(result);
+        }
+    }
+    return std::move(best.part);
+}
+
+}  // namespace
+
+std::vector<int32_t> V3BspHyperPartitioner::partition(const Hypergraph& graph,
+                                                      const std::vector<int64_t>& maxBlockWeights,
+                                                      Objective objective, int64_t* objectivep) {
+    UASSERT(!maxBlockWeights.empty(), "no blocks");
+    const std::size_t numParts = maxBlockWeights.size();
+    const Weight totalWeight
+        = std::accumulate(graph.nodeWeights.begin(), graph.nodeWeights.end(), Weight{0});
+    const Weight minBlockWeight = *std::min_element(maxBlockWeights.begin(), maxBlockWeights.end());
+    const std::size_t contractionLimit
+        = std::max<std::size_t>(2 * numParts, std::min<std::size_t>(160 * numParts, 4096));
+    const Weight maxNodeWeight = std::max<Weight>(
+        1, std::min<Weight>(minBlockWeight, (3 * totalWeight) / (2 * contractionLimit) + 1));
+
+    // coarsen
+    std::vector<std::unique_ptr<Level>> levels;
+    const Hypergraph* coarsestp = &graph;
+    while (coarsestp->numNodes() > contractionLimit) {
+        std::unique_ptr<Level> levelp{new Level};
+        if (!coarsen(*coarsestp, maxNodeWeight, *levelp)) break;
+        UINFO(5, "BspHyperPartitioner level " << levels.size() << ": "
+                                              << levelp->graph.numNodes() << " nodes "
+                                              << levelp->graph.numEdges() << " edges" << endl);
+        levels.emplace_back(std::move(levelp));
+        coarsestp = &levels.back()->graph;
+    }
+
+    std::vector<PartId> part = initialPartition(*coarsestp, maxBlockWeights, objective);
+
+    // uncoarsen and refine every level
+    for (std::size_t ix = levels.size(); ix-- > 0;) {
+        const Hypergraph& fine = ix ? levels[ix - 1]->graph : graph;
+        std::vector<PartId> finePart(fine.numNodes());
+        for (NodeId u = 0; u < fine.numNodes(); ++u) {
+            finePart[u] = part[levels[ix]->coarseOf[u]];
+        }
+        PartitionState st{fine, maxBlockWeights, objective, std::move(finePart)};
+        refine(st, true);
+        part = std::move(st.part());
+    }
+
+    const PartitionState st{graph, maxBlockWeights, objective, std::vector<PartId>{part}};
+    *objectivep = st.objective();
+    UINFO(3, "BspHyperPartitioner: " << graph.numNodes() << " nodes, " << levels.size()
+                                     << " levels, objective " << *objectivep << ", overload "
+                                     << st.overload() << endl);
+    return part;
+}
+
+}  // namespace V3BspSched
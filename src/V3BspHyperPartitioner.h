@@ -0,0 +1,75 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator BSP: Parallel multilevel hypergraph partitioner
+//
+// Code available from: https://verilator.org
+//
+//*************************************************************************
+//
+// Copyright 2003-2023 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+//
+// A native replacement for the kahypar_partition calls of V3BspHyperMerger
+// and V3BspIpuDevicePartitioning, used with
+// --ipu-merge-strategy ParallelHypergraph. It follows the usual multilevel
+// scheme:
+//
+//  - Coarsening: every node rates its neighbors by heavy edge,
+//    sum(w(e) / (|e| - 1)) / (c(u) * c(v)), in parallel on V3ThreadPool.
+//    The preferred pairs are then matched in node order and contracted,
+//    until the hypergraph is small or stops shrinking.
+//  - Initial partitioning: several greedy growing runs with different
+//    orders run in parallel on the coarsest hypergraph. The best balanced
+//    one is kept.
+//  - Uncoarsening: the partition is projected back level by level and
+//    refined by label propagation. Every node finds its best positive-gain
+//    move in parallel, then the moves are applied in node order after
+//    checking their exact gain and the block weight limits.
+//
+// The result does not depend on the number of threads.
+//
+//*************************************************************************
+
+#ifndef VERILATOR_V3BSPHYPERPARTITIONER_H_
+#define VERILATOR_V3BSPHYPERPARTITIONER_H_
+
+#include "config_build.h"
+#include "verilatedos.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace V3BspSched {
+
+// Hypergraph in the representation of kahypar_partition (eptr and eind of the hMetis
+// manual): the pins of edge e are pins[edgePtr[e]] ... pins[edgePtr[e + 1] - 1]
+struct Hypergraph final {
+    std::vector<int64_t> nodeWeights;
+    std::vector<int64_t> edgeWeights;
+    std::vector<std::size_t> edgePtr;  // size edgeWeights.size() + 1
+    std::vector<uint32_t> pins;
+    uint32_t numNodes() const { return nodeWeights.size(); }
+    uint32_t numEdges() const { return edgeWeights.size(); }
+};
+
+class V3BspHyperPartitioner final {
+public:
+    enum class Objective : uint8_t {
+        CUT,  // sum of the weights of edges with pins in more than one block
+        KM1  // sum of w(e) * (number of blocks of e - 1)
+    };
+    // Partition into maxBlockWeights.size() blocks that are no heavier than their limit
+    // whenever possible. Returns the block of every node and the objective in *objectivep.
+    static std::vector<int32_t> partition(const Hypergraph& graph,
+                                          const std::vector<int64_t>& maxBlockWeights,
+                                          Objective objective, int64_t* objectivep);
+};
+
+}  // namespace V3BspSched
+
+#endif  // Guard
@@ -21,12 +21,14 @@
 
 #include "V3Ast.h"
 #include "V3AstUserAllocator.h"
+#include "V3BspHyperPartitioner.h"
 #include "V3InstrCount.h"
 #include "V3Stats.h"
 #include <V3File.h>
 #include <algorithm>
 #include <libkahypar.h>
 #include <limits>
+#include <map>
 #include <numeric>
 #include <set>
 #include <unordered_map>
@@ -106,14 +108,14 @@ private:
 
     void findHyperEdges(const std::unique_ptr<DepGraph>& fiberp, kahypar_hypernode_id_t fiberId) {
         for (V3GraphVertex* vtxp = fiberp->verticesBeginp(); vtxp; vtxp = vtxp->verticesNextp()) {
-            if (ConstrCommitVertex* const commitp = dynamic_cast<ConstrCommitVertex*>(vtxp)) {
+            if (ConstrCommitVertex* const commitp = vtxCast<ConstrCommitVertex>(vtxp)) {
                 AstVarScope* const vscp = commitp->vscp();
                 UINFO(10, "Produced by fiber  " << fiberId << ": " << vscp->prettyNameQ() << endl);
                 auto& varInfo = m_scoreboard(vscp);
                 varInfo.setProducer(fiberId);
                 varInfo.addConnection(fiberId);
                 m_hyperEdgeVscp.push_back(vscp);
-            } else if (ConstrDefVertex* const defp = dynamic_cast<ConstrDefVertex*>(vtxp)) {
+            } else if (ConstrDefVertex* const defp = vtxCast<ConstrDefVertex>(vtxp)) {
                 UINFO(10, "Consumed by fiber  " << fiberId << ": " << defp->vscp()->prettyNameQ()
                                                 << endl);
                 m_scoreboard(defp->vscp()).addConnection(fiberId);
@@ -181,12 +183,6 @@ private:
         // partially used (i.e., if the user asks us to use only some of the second, third,... IPU,
         // e.g., --tiles 1475 should use only 3 tiles from the second IPU when a single IPU has
         // 1472 tiles)
-        std::unique_ptr<kahypar_context_t, std::function<void(kahypar_context_t*)>> kctxp{
-            kahypar_context_new(), [](kahypar_context_t* p) { kahypar_context_free(p); }};
-        kahypar_configure_context_from_file(kctxp.get(), (v3Global.opt.getenvPARENDI_ROOT()
-                                                          + "/include/vlpoplar/KaHyParConfig.ini")
-                                                             .c_str());
-
         const kahypar_hypernode_id_t numNodes = fibersp.size();
         const kahypar_hyperedge_id_t numEdges = hyperEdgeWeights.size();
         const double imbalance = v3Global.opt.kahyparImbalance();
@@ -202,21 +198,51 @@ private:
         std::fill(partitionIds.begin(), partitionIds.end(), -1);
 
         kahypar_hyperedge_weight_t objective = -1;
-        // instruct KaHyPar to come up with partitions of the given size
-        kahypar_set_custom_target_block_weights(numDevices, blockWeights.data(), kctxp.get());
-        UINFO(3, "Starting KaHyPar partitioner "
-                     << "\n\t# HN = " << numNodes << " # HE = " << numEdges
-                     << " ways = " << numDevices << endl);
-
         std::vector<kahypar_hypernode_weight_t> nodeWeights(numNodes);
         std::fill(nodeWeights.begin(), nodeWeights.end(), 1);  // unit weight
 
         if (debug() >= 3) {
             dumpHMetisGraphFile(nodeWeights, hyperEdgeWeights, hyperEdgeIndexer, hyperEdges);
         }
-        kahypar_partition(numNodes, numEdges, imbalance, numDevices, nodeWeights.data(),
-                          hyperEdgeWeights.data(), hyperEdgeIndexer.data(), hyperEdges.data(),
-                          &objective, kctxp.get(), partitionIds.data());
+        if (v3Global.opt.ipuMergeStrategy().parallelHypergraph()) {
+            // Every fiber weighs one. Like the merge, allow each device the --kahypar-imbalance
+            // slack above its target, otherwise no single fiber could move during refinement
+            // once every device is full.
+            std::vector<int64_t> maxBlockWeights;
+            for (const kahypar_hypernode_weight_t weight : blockWeights) {
+                maxBlockWeights.push_back(
+                    static_cast<int64_t>(std::ceil((1.0 + imbalance) * weight)));
+            }
+            Hypergraph graph;
+            graph.nodeWeights.assign(nodeWeights.begin(), nodeWeights.end());
+            graph.edgeWeights.assign(hyperEdgeWeights.begin(), hyperEdgeWeights.end());
+            graph.edgePtr.assign(hyperEdgeIndexer.begin(), hyperEdgeIndexer.end());
+            graph.pins.assign(hyperEdges.begin(), hyperEdges.end());
+            int64_t cut = 0;
+            UINFO(3, "Starting parallel hypergraph partitioner "
+                         << "\n\t# HN = " << numNodes << " # HE = " << numEdges
+                         << " ways = " << numDevices << endl);
+            const std::vector<int32_t> devices = V3BspHyperPartitioner::partition(
+                graph, maxBlockWeights, V3BspHyperPartitioner::Objective::CUT, &cut);
+            std::copy(devices.begin(), devices.end(), partitionIds.begin());
+            objective = cut;
+            V3Stats::addStat("IPU partitioning, parallel hypergraph cut", cut);
+        } else {
+            std::unique_ptr<kahypar_context_t, std::function<void(kahypar_context_t*)>> kctxp{
+                kahypar_context_new(), [](kahypar_context_t* p) { kahypar_context_free(p); }};
+            kahypar_configure_context_from_file(
+                kctxp.get(),
+                (v3Global.opt.getenvPARENDI_ROOT() + "/include/vlpoplar/KaHyParConfig.ini")
+                    .c_str());
+            // instruct KaHyPar to come up with partitions of the given size
+            kahypar_set_custom_target_block_weights(numDevices, blockWeights.data(), kctxp.get());
+            UINFO(3, "Starting KaHyPar partitioner "
+                         << "\n\t# HN = " << numNodes << " # HE = " << numEdges
+                         << " ways = " << numDevices << endl);
+            kahypar_partition(numNodes, numEdges, imbalance, numDevices, nodeWeights.data(),
+                              hyperEdgeWeights.data(), hyperEdgeIndexer.data(), hyperEdges.data(),
+                              &objective, kctxp.get(), partitionIds.data());
+        }
         UINFO(3, "Objective = " << objective << endl);
         V3Stats::addStat("IPU partitioning, cut size ", objective);
         V3Stats::addStat("IPU partitioning, hyperedges ", numEdges);
@@ -250,6 +276,166 @@ public:
         : m_devModel{devModel} {}
 };
 
+// Orders the compute classes such that mapping them linearly to IPUs keeps the classes
+// that exchange the most words on the same IPU. Starting from the linear mapping, pairs of
+// classes on different IPUs are swapped while that reduces the inter-IPU exchange volume
+// (Kernighan-Lin style), so the number of classes on each IPU does not change.
+class IpuExchangePlacement final {
+private:
+    using ClassId = uint32_t;
+    static constexpr int MAX_PASSES = 16;
+
+    std::vector<AstClass*> m_classesp;
+    // words exchanged with every neighbor, in both directions
+    std::vector<std::vector<std::pair<ClassId, uint64_t>>> m_adj;
+    std::vector<uint32_t> m_deviceId;  // current device of each class
+    uint32_t m_numDevices = 0;
+
+    // The exchange function of the top module (see V3BspModules) has an assignment
+    // target.var = source.var for every word that crosses partitions
+    void buildGraph(AstNetlist* netlistp) {
+        std::unordered_map<const AstClass*, ClassId> ids;
+        for (ClassId id = 0; id < m_classesp.size(); id++) ids.emplace(m_classesp[id], id);
+        auto classIdOf = [&ids](const AstNodeExpr* exprp) -> const ClassId* {
+            const AstMemberSel* const selp = VN_CAST(exprp, MemberSel);
+            if (!selp) return nullptr;
+            const AstVarRef* const refp = VN_CAST(selp->fromp(), VarRef);
+            if (!refp) return nullptr;
+            const AstClassRefDType* const clsDTypep
+                = VN_CAST(refp->varScopep()->dtypep(), ClassRefDType);
+            if (!clsDTypep) return nullptr;
+            const auto it = ids.find(clsDTypep->classp());
+            return it == ids.end() ? nullptr : &it->second;
+        };
+        std::map<std::pair<ClassId, ClassId>, uint64_t> volume;
+        for (AstNode* np = netlistp->topScopep()->scopep()->blocksp(); np; np = np->nextp()) {
+            const AstCFunc* const funcp = VN_CAST(np, CFunc);
+            if (!funcp || funcp->name() != "exchange") continue;
+            for (AstNode* stmtp = funcp->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
+                const AstAssign* const assignp = VN_CAST(stmtp, Assign);
+                if (!assignp) continue;
+                const ClassId* const targetp = classIdOf(assignp->lhsp());
+                const ClassId* const sourcep = classIdOf(assignp->rhsp());
+                if (!targetp || !sourcep || *targetp == *sourcep) continue;
+                AstNodeDType* const dtypep = VN_AS(assignp->lhsp(), MemberSel)->varp()->dtypep();
+                const uint64_t numWords = dtypep->arrayUnpackedElements() * dtypep->widthWords();
+                volume[std::minmax(*targetp, *sourcep)] += numWords;
+            }
+        }
+        m_adj.resize(m_classesp.size());
+        for (const auto& pair : volume) {
+            m_adj[pair.first.first].emplace_back(pair.first.second, pair.second);
+            m_adj[pair.first.second].emplace_back(pair.first.first, pair.second);
+        }
+    }
+    uint64_t wordsTo(ClassId id, uint32_t deviceId) const {
+        uint64_t words = 0;
+        for (const auto& pair : m_adj[id]) {
+            if (m_deviceId[pair.first] == deviceId) words += pair.second;
+        }
+        return words;
+    }
+    uint64_t wordsBetween(ClassId a, ClassId b) const {
+        for (const auto& pair : m_adj[a]) {
+            if (pair.first == b) return pair.second;
+        }
+        return 0;
+    }
+    int64_t moveGain(ClassId id, uint32_t deviceId) const {
+        return static_cast<int64_t>(wordsTo(id, deviceId))
+               - static_cast<int64_t>(wordsTo(id, m_deviceId[id]));
+    }
+    uint64_t cutWords() const {
+        uint64_t words = 0;
+        for (ClassId id = 0; id < m_adj.size(); id++) {
+            for (const auto& pair : m_adj[id]) {
+                if (pair.first > id && m_deviceId[pair.first] != m_deviceId[id]) {
+                    words += pair.second;
+                }
+            }
+        }
+        return words;
+    }
+    // Swap the best candidates of two devices, returns true if anything was swapped
+    bool refinePair(uint32_t devA, uint32_t devB) {
+        std::vector<std::pair<int64_t, ClassId>> candA;
+        std::vector<std::pair<int64_t, ClassId>> candB;
+        for (ClassId id = 0; id < m_classesp.size(); id++) {
+            if (m_deviceId[id] == devA) {
+                candA.emplace_back(moveGain(id, devB), id);
+            } else if (m_deviceId[id] == devB) {
+                candB.emplace_back(moveGain(id, devA), id);
+            }
+        }
+        // highest gain first, ties broken by id to stay deterministic
+        const auto byGain = [](const std::pair<int64_t, ClassId>& x,
+                               const std::pair<int64_t, ClassId>& y) {
+            return x.first > y.first || (x.first == y.first && x.second < y.second);
+        };
+        std::sort(candA.begin(), candA.end(), byGain);
+        std::sort(candB.begin(), candB.end(), byGain);
+        bool swapped = false;
+        for (size_t i = 0; i < std::min(candA.size(), candB.size()); i++) {
+            if (candA[i].first + candB[i].first <= 0) break;
+            const ClassId a = candA[i].second;
+            const ClassId b = candB[i].second;
+            // gains are stale once neighbors have moved, recompute them
+            const int64_t gain = moveGain(a, devB) + moveGain(b, devA)
+                                 - 2 * static_cast<int64_t>(wordsBetween(a, b));
+            if (gain <= 0) continue;
+            m_deviceId[a] = devB;
+            m_deviceId[b] = devA;
+            swapped = true;
+        }
+        return swapped;
+    }
+
+public:
+    IpuExchangePlacement(AstNetlist* netlistp, const IpuDevModel& devModel,
+                         const std::vector<AstClass*>& classesp)
+        : m_classesp{classesp} {
+        // same as the linear mapping of IpuLinearPlacement
+        const uint32_t numClasses = static_cast<uint32_t>(m_classesp.size());
+        uint32_t beginIndex = 0;
+        for (const uint32_t numTiles : devModel.usableTilesPerDevice()) {
+            if (beginIndex >= numClasses) break;
+            const uint32_t endIndex
+                = std::min(beginIndex + numTiles * devModel.numAvailWorkers, numClasses);
+            for (uint32_t i = beginIndex; i < endIndex; i++) m_deviceId.push_back(m_numDevices);
+            beginIndex = endIndex;
+            m_numDevices++;
+        }
+        UASSERT(m_deviceId.size() == m_classesp.size(), "not enough device capacity");
+        buildGraph(netlistp);
+        const uint64_t linearCut = cutWords();
+        int pass = 0;
+        for (bool swapped = true; swapped && pass < MAX_PASSES; pass++) {
+            swapped = false;
+            for (uint32_t devA = 0; devA < m_numDevices; devA++) {
+                for (uint32_t devB = devA + 1; devB < m_numDevices; devB++) {
+                    swapped |= refinePair(devA, devB);
+                }
+            }
+        }
+        const uint64_t refinedCut = cutWords();
+        UINFO(3, "Inter-IPU exchange reduced from " << linearCut << " to " << refinedCut
+                                                    << " words in " << pass << " passes" << endl);
+        V3Stats::addStat("BspPlace, inter-IPU exchange words, linear", linearCut);
+        V3Stats::addStat("BspPlace, inter-IPU exchange words, refined", refinedCut);
+    }
+    // classes ordered by device, preserving the relative order within each device
+    std::vector<AstClass*> ordered() const {
+        std::vector<ClassId> ids(m_classesp.size());
+        std::iota(ids.begin(), ids.end(), 0);
+        std::stable_sort(ids.begin(), ids.end(), [this](ClassId a, ClassId b) {
+            return m_deviceId[a] < m_deviceId[b];
+        });
+        std::vector<AstClass*> classesp;
+        for (const ClassId id : ids) classesp.push_back(m_classesp[id]);
+        return classesp;
+    }
+};
+
 // Assigns tile and worker ids to the bsp classes
 class IpuLinearPlacement final {
 private:
@@ -368,7 +554,12 @@ public:
             }
         }
         if (m_devModel.numIpusUsed(unplaced.size()) > 1) {
-            setLocationsLinearlyMultiIpu(unplaced);
+            if (v3Global.opt.fIpuExchangePlace()) {
+                setLocationsLinearlyMultiIpu(
+                    IpuExchangePlacement{netlistp, m_devModel, unplaced}.ordered());
+            } else {
+                setLocationsLinearlyMultiIpu(unplaced);
+            }
         } else {
             setLocationLinearlySingleIpu(unplaced);
         }
@@ -0,0 +1,348 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator BSP: Run several cycles between two exchanges
+//
+// Code available from: https://verilator.org
+//
+//*************************************************************************
+//
+// Copyright 2005-2023 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+
+#include "V3BspLookahead.h"
+
+#include "V3Global.h"
+#include "V3Stats.h"
+
+#include <array>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+
+VL_DEFINE_DEBUG_FUNCTIONS;
+
+namespace V3BspSched {
+
+namespace {
+
+// Call fn for every variable that vtxp makes its partition the producer of,
+// mirrors ModuleBuilderImpl::computeReferences in V3BspModules.cpp
+template <typename Fn>
+void foreachProduced(AnyVertex* vtxp, Fn&& fn) {
+    if (CompVertex* const compp = vtxp->cast<CompVertex>()) {
+        if (!VN_IS(compp->nodep(), AssignPost) && !VN_IS(compp->nodep(), AlwaysPost)) return;
+        compp->nodep()->foreach([&](const AstVarRef* vrefp) {
+            if (vrefp->access().isWriteOrRW()) fn(vrefp->varScopep());
+        });
+    } else if (ConstrCommitVertex* const commitp = vtxp->cast<ConstrCommitVertex>()) {
+        if (commitp->outEmpty()) fn(commitp->vscp());
+    }
+}
+
+class LookaheadReplicator final {
+    using Partitions = std::vector<std::unique_ptr<DepGraph>>;
+    using VarSet = std::unordered_set<const AstVarScope*>;
+
+    struct Cone {
+        std::vector<AnyVertex*> vtxps;  // vertices of the owner graph
+        bool replicable = true;  // false if the cone has side effects
+    };
+    struct Replicas {
+        std::vector<AnyVertex*> vtxps;  // replicated vertices of other partitions
+        std::unordered_set<AnyVertex*> vtxSetp;  // the same, for lookups
+        std::unordered_set<const AstNode*> nodesp;  // logic computed by the partition
+        VarSet knownp;  // owned, replicated or already requested variables
+        std::vector<const AstVarScope*> frontierp;  // remote variables to replicate next
+        uint64_t cost = 0;  // cost of the partition with the replicas
+    };
+
+    // STATE
+    Partitions& m_partitionsp;
+    std::unordered_map<const AstVarScope*, size_t> m_owner;  // variable -> owner index
+    std::unordered_map<const AstVarScope*, std::vector<AnyVertex*>> m_producersp;
+    std::unordered_map<const AstVarScope*, Cone> m_cones;  // memoized one cycle cones
+    std::vector<Replicas> m_replicas;  // indexed like m_partitionsp
+
+    static bool hasSideEffects(const CompVertex* compp) {
+        return compp->nodep()->exists([](const AstNode* nodep) {
+            return !nodep->isPure() || nodep->isOutputter() || VN_IS(nodep, NodeCCall);
+        });
+    }
+
+    // Remote variables read by vtxp in partition pix, not yet known to it
+    void gatherRemote(size_t pix, AnyVertex* vtxp) {
+        Replicas& reps = m_replicas[pix];
+        const auto visit = [&](const AstVarScope* vscp) {
+            const auto it = m_owner.find(vscp);
+            if (it == m_owner.end() || it->second == pix) return;
+            if (reps.knownp.insert(vscp).second) reps.frontierp.push_back(vscp);
+        };
+        if (ConstrDefVertex* const defp = vtxp->cast<ConstrDefVertex>()) {
+            // a DEF without any logic in front reads the committed value
+            if (defp->inEmpty()) visit(defp->vscp());
+        } else if (CompVertex* const compp = vtxp->cast<CompVertex>()) {
+            // a clock generated by another partition has to be replicated as well
+            if (compp->domainp()) {
+                compp->domainp()->foreach([&](const AstVarRef* vrefp) {
+                    if (vrefp->access().isReadOrRW()) visit(vrefp->varScopep());
+                });
+            }
+        }
+    }
+
+    // The logic of the owner that commits vscp, see backwardTraverseAndCollect
+    const Cone& coneOf(const AstVarScope* vscp) {
+        const auto it = m_cones.find(vscp);
+        if (it != m_cones.end()) return it->second;
+        Cone& cone = m_cones[vscp];
+        std::unordered_set<AnyVertex*> visited;
+        std::queue<AnyVertex*> toVisit;
+        for (AnyVertex* const vtxp : m_producersp[vscp]) {
+            if (visited.insert(vtxp).second) toVisit.push(vtxp);
+        }
+        while (!toVisit.empty()) {
+            AnyVertex* const headp = toVisit.front();
+            toVisit.pop();
+            cone.vtxps.push_back(headp);
+            if (CompVertex* const compp = headp->cast<CompVertex>()) {
+                if (hasSideEffects(compp)) cone.replicable = false;
+                // the constraints on what the logic writes come along
+                for (V3GraphEdge* edgep = compp->outBeginp(); edgep; edgep = edgep->outNextp()) {
+                    AnyVertex* const top = static_cast<AnyVertex*>(edgep->top());
+                    if (visited.insert(top).second) cone.vtxps.push_back(top);
+                }
+            }
+            // ordering constraints only, not data dependences
+            if (headp->is<ConstrPostVertex>() || headp->is<ConstrInitVertex>()) continue;
+            for (V3GraphEdge* edgep = headp->inBeginp(); edgep; edgep = edgep->inNextp()) {
+                AnyVertex* const fromp = static_cast<AnyVertex*>(edgep->fromp());
+                if (visited.insert(fromp).second) toVisit.push(fromp);
+            }
+        }
+        return cone;
+    }
+
+    // Replicate the cones of the frontier of every partition, returns false without
+    // changing anything if that makes a partition more expensive than budget
+    bool replicateLevel(uint64_t budget) {
+        std::vector<Replicas> nextp = m_replicas;
+        for (size_t pix = 0; pix < m_partitionsp.size(); ++pix) {
+            Replicas& reps = nextp[pix];
+            std::vector<const AstVarScope*> frontierp;
+            std::swap(frontierp, reps.frontierp);
+            for (const AstVarScope* const vscp : frontierp) {
+                const Cone& cone = coneOf(vscp);
+                if (!cone.replicable) {
+                    UINFO(3, "Can not replicate " << vscp->prettyNameQ() << endl);
+                    return false;
+                }
+                for (AnyVertex* const vtxp : cone.vtxps) {
+                    if (!reps.vtxSetp.insert(vtxp).second) continue;
+                    reps.vtxps.push_back(vtxp);
+                    if (CompVertex* const compp = vtxp->cast<CompVertex>()) {
+                        if (reps.nodesp.insert(compp->nodep()).second) reps.cost += compp->cost();
+                    }
+                }
+            }
+            if (reps.cost > budget) {
+                UINFO(3, "Partition " << pix << " would cost " << reps.cost << " > " << budget
+                                      << endl);
+                return false;
+            }
+        }
+        // the remote variables read by the new replicas are next
+        std::swap(m_replicas, nextp);
+        for (size_t pix = 0; pix < m_partitionsp.size(); ++pix) {
+            const Replicas& oldp = nextp[pix];
+            Replicas& reps = m_replicas[pix];
+            for (size_t ix = oldp.vtxps.size(); ix < reps.vtxps.size(); ++ix) {
+                gatherRemote(pix, reps.vtxps[ix]);
+            }
+        }
+        return true;
+    }
+
+    static bool isAcyclic(DepGraph* graphp) {
+        std::unordered_map<V3GraphVertex*, size_t> inDegree;
+        std::vector<V3GraphVertex*> readyp;
+        size_t numVertices = 0;
+        for (V3GraphVertex* vtxp = graphp->verticesBeginp(); vtxp; vtxp = vtxp->verticesNextp()) {
+            ++numVertices;
+            size_t n = 0;
+            for (V3GraphEdge* edgep = vtxp->inBeginp(); edgep; edgep = edgep->inNextp()) ++n;
+            if (n) {
+                inDegree[vtxp] = n;
+            } else {
+                readyp.push_back(vtxp);
+            }
+        }
+        size_t numOrdered = 0;
+        while (!readyp.empty()) {
+            V3GraphVertex* const vtxp = readyp.back();
+            readyp.pop_back();
+            ++numOrdered;
+            for (V3GraphEdge* edgep = vtxp->outBeginp(); edgep; edgep = edgep->outNextp()) {
+                if (--inDegree[edgep->top()] == 0) readyp.push_back(edgep->top());
+            }
+        }
+        return numOrdered == numVertices;
+    }
+
+    // The partition pix with its replicas, vertices are merged like V3BspMerger does
+    std::unique_ptr<DepGraph> buildPartition(size_t pix) const {
+        using Slots = std::array<AnyVertex*, static_cast<size_t>(DepVertexKind::NUM_KINDS)>;
+        DepGraph* const oldp = m_partitionsp[pix].get();
+        const Replicas& reps = m_replicas[pix];
+        std::unique_ptr<DepGraph> newp{new DepGraph};
+        newp->modp(oldp->modp());
+        std::unordered_map<const AstNode*, Slots> clonesp;
+        std::unordered_map<AnyVertex*, AnyVertex*> origToClonep;
+        const auto keyp = [](AnyVertex* vtxp) -> const AstNode* {
+            if (CompVertex* const compp = vtxp->cast<CompVertex>()) return compp->nodep();
+            return static_cast<ConstrVertex*>(vtxp)->vscp();
+        };
+        const auto cloneVertex = [&](AnyVertex* vtxp) {
+            AnyVertex*& slotp = clonesp[keyp(vtxp)][static_cast<size_t>(vtxp->kind())];
+            if (!slotp) {
+                slotp = vtxp->clone(newp.get());
+                slotp->hash(vtxp->hash());
+            }
+            origToClonep.emplace(vtxp, slotp);
+        };
+        const auto cloneEdges = [&](AnyVertex* vtxp) {
+            AnyVertex* const fromp = origToClonep.at(vtxp);
+            for (V3GraphEdge* edgep = vtxp->outBeginp(); edgep; edgep = edgep->outNextp()) {
+                const auto it = origToClonep.find(static_cast<AnyVertex*>(edgep->top()));
+                if (it == origToClonep.end()) continue;  // not replicated
+                if (CompVertex* const compp = fromp->cast<CompVertex>()) {
+                    newp->addEdge(compp, static_cast<ConstrVertex*>(it->second));
+                } else {
+                    newp->addEdge(static_cast<ConstrVertex*>(fromp),
+                                  static_cast<CompVertex*>(it->second));
+                }
+            }
+        };
+        for (V3GraphVertex* vtxp = oldp->verticesBeginp(); vtxp; vtxp = vtxp->verticesNextp()) {
+            cloneVertex(static_cast<AnyVertex*>(vtxp));
+        }
+        for (AnyVertex* const vtxp : reps.vtxps) cloneVertex(vtxp);
+        for (V3GraphVertex* vtxp = oldp->verticesBeginp(); vtxp; vtxp = vtxp->verticesNextp()) {
+            cloneEdges(static_cast<AnyVertex*>(vtxp));
+        }
+        for (AnyVertex* const vtxp : reps.vtxps) cloneEdges(vtxp);
+        newp->removeRedundantEdges(V3GraphEdge::followAlwaysTrue);
+
+        // whatever the replicas commit is still owned by the original producer
+        VarSet ownedp;
+        for (V3GraphVertex* vtxp = oldp->verticesBeginp(); vtxp; vtxp = vtxp->verticesNextp()) {
+            foreachProduced(static_cast<AnyVertex*>(vtxp),
+                            [&](const AstVarScope* vscp) { ownedp.insert(vscp); });
+        }
+        for (V3GraphVertex* vtxp = newp->verticesBeginp(); vtxp; vtxp = vtxp->verticesNextp()) {
+            foreachProduced(static_cast<AnyVertex*>(vtxp), [&](const AstVarScope* vscp) {
+                if (!ownedp.count(vscp)) newp->addReplica(vscp);
+            });
+        }
+        return newp;
+    }
+
+public:
+    explicit LookaheadReplicator(Partitions& partitionsp)
+        : m_partitionsp{partitionsp} {
+        m_replicas.resize(partitionsp.size());
+        for (size_t pix = 0; pix < partitionsp.size(); ++pix) {
+            DepGraph* const graphp = partitionsp[pix].get();
+            for (V3GraphVertex* vtxp = graphp->verticesBeginp(); vtxp;
+                 vtxp = vtxp->verticesNextp()) {
+                AnyVertex* const anyp = static_cast<AnyVertex*>(vtxp);
+                foreachProduced(anyp, [&](const AstVarScope* vscp) {
+                    m_owner.emplace(vscp, pix);
+                    m_producersp[vscp].push_back(anyp);
+                    m_replicas[pix].knownp.insert(vscp);
+                });
+                if (CompVertex* const compp = anyp->cast<CompVertex>()) {
+                    if (m_replicas[pix].nodesp.insert(compp->nodep()).second) {
+                        m_replicas[pix].cost += compp->cost();
+                    }
+                }
+            }
+        }
+        for (size_t pix = 0; pix < partitionsp.size(); ++pix) {
+            DepGraph* const graphp = partitionsp[pix].get();
+            for (V3GraphVertex* vtxp = graphp->verticesBeginp(); vtxp;
+                 vtxp = vtxp->verticesNextp()) {
+                gatherRemote(pix, static_cast<AnyVertex*>(vtxp));
+            }
+        }
+    }
+
+    // Replicate up to maxDepth levels, returns the number of levels replicated
+    int replicate(int maxDepth, double threshold) {
+        uint64_t maxCost = 0;
+        for (const Replicas& reps : m_replicas) maxCost = std::max(maxCost, reps.cost);
+        const uint64_t budget = static_cast<uint64_t>(maxCost * (1.0 + threshold));
+        int depth = 0;
+        while (depth < maxDepth && replicateLevel(budget)) ++depth;
+        if (depth == 0) return 0;
+
+        Partitions newPartitionsp;
+        size_t numReplicated = 0;
+        uint64_t newMaxCost = 0;
+        for (size_t pix = 0; pix < m_partitionsp.size(); ++pix) {
+            newPartitionsp.emplace_back(buildPartition(pix));
+            if (!isAcyclic(newPartitionsp.back().get())) {
+                v3warn(E_UNSUPPORTED, "Replicated logic creates a cycle in a partition, "
+                                      "--bsp-lookahead is ignored");
+                return 0;
+            }
+            numReplicated += m_replicas[pix].vtxps.size();
+            newMaxCost = std::max(newMaxCost, m_replicas[pix].cost);
+        }
+        std::swap(m_partitionsp, newPartitionsp);
+        V3Stats::addStat("BspLookahead, replicated vertices", numReplicated);
+        V3Stats::addStat("BspLookahead, max partition cost before", maxCost);
+        V3Stats::addStat("BspLookahead, max partition cost after", newMaxCost);
+        return depth;
+    }
+};
+
+}  // namespace
+
+void V3BspLookahead::replicateAll(std::vector<std::unique_ptr<DepGraph>>& partitionsp) {
+    const int requested = v3Global.opt.bspLookahead();
+    const int batch = v3Global.bspCycleBatch();  // see V3BspDpi::settleHostCondition
+    if (v3Global.opt.fIpuActivityGate()) {
+        v3warn(E_UNSUPPORTED, "--bsp-lookahead can not be used with -fipu-activity-gate, "
+                              "exchanging every cycle");
+        return;
+    }
+    if (batch == 1) {
+        v3warn(E_UNSUPPORTED, "--bsp-lookahead needs --bsp-cycle-batch, exchanging every cycle");
+        return;
+    }
+    // the windows have to tile a batch
+    int maxCycles = requested;
+    while (batch % maxCycles) --maxCycles;
+    if (maxCycles != requested) {
+        v3warn(E_UNSUPPORTED, "--bsp-cycle-batch " << batch << " is not a multiple of "
+                                                   << "--bsp-lookahead " << requested
+                                                   << ", using " << maxCycles);
+    }
+    LookaheadReplicator replicator{partitionsp};
+    const int depth = replicator.replicate(maxCycles - 1, v3Global.opt.lookaheadThreshold());
+    int cycles = depth + 1;
+    while (batch % cycles) --cycles;  // replicas of a level that can not be used are harmless
+    UINFO(3, "Running " << cycles << " cycles per exchange" << endl);
+    V3Stats::addStat("BspLookahead, cycles per exchange", cycles);
+    v3Global.bspLookahead(cycles);
+}
+
+}  // namespace V3BspSched
@@ -0,0 +1,65 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator BSP: Run several cycles between two exchanges
+//
+// Code available from: https://verilator.org
+//
+//*************************************************************************
+//
+// Copyright 2005-2023 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+//
+// With --bsp-lookahead <k>, every partition recomputes the registers of
+// other partitions it reads, so that it can run k cycles on a single
+// exchange. A register owned by another partition is only exact for one
+// cycle after the exchange. Copying the logic that commits it, i.e., its
+// one cycle cone in the owner partition, keeps it exact for one more cycle
+// as long as the remote registers read by that cone are exact. Replicating
+// the cones transitively to a depth of k - 1 hence keeps every register a
+// partition reads exact for k cycles:
+//
+//      k = 2, P reads r <= f(s), r and s are owned by other partitions
+//      cycle 1:    P reads r (exchanged), the replica computes f(s) (exchanged)
+//      cycle 2:    P reads r (replica), the replica computes f(stale s)
+//      cycle 3:    exchange, everything is exact again
+//
+// A replicated register still receives the value of its owner in every
+// exchange (see V3BspModules), so the values that went wrong within the
+// window never leave it. The depth is lowered until the most expensive
+// partition grows by at most --lookahead-threshold.
+//
+// The runtime only skips the exchanges within a batch of --bsp-cycle-batch
+// cycles, whose size should be a multiple of k. Differential exchange relies
+// on seeing every cycle's exchange, so it is skipped once the lookahead is in
+// effect. Activity gating does too and disables the lookahead.
+//
+//*************************************************************************
+
+#ifndef VERILATOR_V3BSPLOOKAHEAD_H_
+#define VERILATOR_V3BSPLOOKAHEAD_H_
+
+#include "config_build.h"
+#include "verilatedos.h"
+
+#include "V3BspGraph.h"
+
+#include <memory>
+#include <vector>
+
+namespace V3BspSched {
+
+class V3BspLookahead final {
+public:
+    // Replicate the logic feeding the remote registers of each partition and set
+    // v3Global.bspLookahead() to the number of cycles run per exchange
+    static void replicateAll(std::vector<std::unique_ptr<DepGraph>>& partitionsp);
+};
+
+}  // namespace V3BspSched
+
+#endif  // Guard
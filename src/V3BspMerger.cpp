@@ -25,7 +25,6 @@
 #include "V3File.h"
 #include "V3FunctionTraits.h"
 #include "V3Hasher.h"
-#include "V3InstrCount.h"
 #include "V3PairingHeap.h"
 #include "V3Stats.h"
 
@@ -101,6 +100,10 @@ private:
     uint32_t m_memWords = 0;
     VlBitSet m_dupSet;
     VlBitSet m_dupVarSet;
+    // sparse views of m_dupSet and m_dupVarSet, used to compute the cost of merging
+    // two cores in O(|smaller set|) rather than O(number of duplicates)
+    std::vector<uint32_t> m_dupList;
+    std::vector<uint32_t> m_dupVarList;
     std::vector<int> m_partIndex;
     std::unique_ptr<HeapNode> m_heapNode;
     bool m_hasPli;
@@ -122,8 +125,37 @@ public:
     inline void memoryWords(uint32_t v) { m_memWords = v; }
     uint32_t memoryWords() const { return m_memWords; }
     inline std::vector<int>& partp() { return m_partIndex; }
-    inline VlBitSet& dupSet() { return m_dupSet; }
-    inline VlBitSet& dupVarSet() { return m_dupVarSet; }
+    inline const VlBitSet& dupSet() const { return m_dupSet; }
+    inline const VlBitSet& dupVarSet() const { return m_dupVarSet; }
+    inline const std::vector<uint32_t>& dupList() const { return m_dupList; }
+    inline const std::vector<uint32_t>& dupVarList() const { return m_dupVarList; }
+    inline void insertDup(uint32_t ix) {
+        if (m_dupSet.contains(ix)) return;
+        m_dupSet.insert(ix);
+        m_dupList.push_back(ix);
+    }
+    inline void insertDupVar(uint32_t ix) {
+        if (m_dupVarSet.contains(ix)) return;
+        m_dupVarSet.insert(ix);
+        m_dupVarList.push_back(ix);
+    }
+    // absorb the duplicate sets of otherp, O(|otherp's sets|)
+    inline void unionDups(const CoreVertex* otherp) {
+        for (const uint32_t ix : otherp->dupList()) insertDup(ix);
+        for (const uint32_t ix : otherp->dupVarList()) insertDupVar(ix);
+    }
+    // sum costs[ix] over the duplicates shared with otherp, O(min(|this|, |otherp|))
+    inline uint32_t commonDupCost(const CoreVertex* otherp,
+                                  const std::vector<uint32_t>& costs) const {
+        const CoreVertex* const smallp
+            = m_dupList.size() <= otherp->dupList().size() ? this : otherp;
+        const CoreVertex* const largep = smallp == this ? otherp : this;
+        uint32_t sum = 0;
+        for (const uint32_t ix : smallp->dupList()) {
+            if (largep->dupSet().contains(ix)) sum += costs[ix];
+        }
+        return sum;
+    }
     inline CostType cost() const { return CostType{instrCount(), recvWords(), memoryWords()}; }
     inline void heapNode(std::unique_ptr<HeapNode>&& n) { m_heapNode = std::move(n); }
     inline std::unique_ptr<HeapNode>& heapNode() { return m_heapNode; }
@@ -172,11 +204,77 @@ template <typename Fn>
 static void iterVertex(V3Graph* const graphp, Fn&& fn) {
     using Traits = FunctionTraits<Fn>;
     using Arg = typename Traits::template arg<0>::type;
+    using ArgClass = std::remove_pointer_t<Arg>;
     for (V3GraphVertex *vtxp = graphp->verticesBeginp(), *nextp; vtxp; vtxp = nextp) {
         nextp = vtxp->verticesNextp();
-        if (Arg const vp = dynamic_cast<Arg>(vtxp)) { fn(vp); }
+        if constexpr (std::is_base_of<AnyVertex, ArgClass>::value) {
+            // DepGraph vertex, dispatch on the vertex kind
+            if (Arg const vp = vtxCast<ArgClass>(vtxp)) { fn(vp); }
+        } else {
+            if (Arg const vp = dynamic_cast<Arg>(vtxp)) { fn(vp); }
+        }
     }
 }
+
+//==============================================================================
+// Clones a set of fibers into a single DepGraph. Fibers share logic and variables, so
+// vertices with the same kind and AstNode are cloned only once.
+class FiberCloner final {
+    using Slots = std::array<AnyVertex*, static_cast<size_t>(DepVertexKind::NUM_KINDS)>;
+    std::unordered_map<AstNode*, Slots> m_clonesp;  // AstNode -> clones, indexed by kind
+    DepGraph* const m_newp;  // The graph being built
+
+    static AstNode* keyp(AnyVertex* vtxp) {
+        if (CompVertex* const compp = vtxp->cast<CompVertex>()) return compp->nodep();
+        return static_cast<ConstrVertex*>(vtxp)->vscp();
+    }
+    AnyVertex*& slot(AnyVertex* oldp) {
+        return m_clonesp[keyp(oldp)][static_cast<size_t>(oldp->kind())];
+    }
+    AnyVertex* clonep(AnyVertex* oldp) {
+        AnyVertex* const newp = slot(oldp);
+        UASSERT(newp, "vertex not cloned");
+        return newp;
+    }
+
+public:
+    explicit FiberCloner(DepGraph* newp, size_t numVertices)
+        : m_newp{newp} {
+        m_clonesp.reserve(numVertices);
+    }
+    // Clone the vertices of oldp, calls onNew(compp) for every CompVertex cloned for the
+    // first time
+    template <typename Fn>
+    void cloneVertices(DepGraph* oldp, Fn&& onNew) {
+        for (V3GraphVertex* vtxp = oldp->verticesBeginp(); vtxp; vtxp = vtxp->verticesNextp()) {
+            AnyVertex* const anyp = static_cast<AnyVertex*>(vtxp);
+            AnyVertex*& newp = slot(anyp);
+            if (newp) continue;
+            newp = anyp->clone(m_newp);
+            newp->hash(anyp->hash());
+            if (CompVertex* const compp = anyp->cast<CompVertex>()) onNew(compp);
+        }
+    }
+    // Clone the edges of oldp, all vertices of oldp should already be cloned
+    void cloneEdges(DepGraph* oldp) {
+        for (V3GraphVertex* vtxp = oldp->verticesBeginp(); vtxp; vtxp = vtxp->verticesNextp()) {
+            AnyVertex* const newFromp = clonep(static_cast<AnyVertex*>(vtxp));
+            for (V3GraphEdge* edgep = vtxp->outBeginp(); edgep; edgep = edgep->outNextp()) {
+                AnyVertex* const newTop = clonep(static_cast<AnyVertex*>(edgep->top()));
+                if (CompVertex* const fromCompp = newFromp->cast<CompVertex>()) {
+                    ConstrVertex* const toConstrp = newTop->cast<ConstrVertex>();
+                    UASSERT(toConstrp, "ill-constructed graph");
+                    m_newp->addEdge(fromCompp, toConstrp);
+                } else {
+                    CompVertex* const toCompp = newTop->cast<CompVertex>();
+                    UASSERT(toCompp, "ill-constructed graph");
+                    m_newp->addEdge(static_cast<ConstrVertex*>(newFromp), toCompp);
+                }
+            }
+        }
+    }
+};
+
 class PartitionMerger {
 private:
     struct NodeInfo {
@@ -185,21 +283,12 @@ private:
         bool hasDuplicates = false;
         bool visited = false;
     };
-    struct NodeVtx {
-        ConstrCommitVertex* commitp = nullptr;
-        ConstrDefVertex* defp = nullptr;
-        ConstrPostVertex* postp = nullptr;
-        ConstrInitVertex* initp = nullptr;
-        CompVertex* compp = nullptr;
-    };
     const uint32_t m_targetTileCount;
     const uint32_t m_targetWorkerCount;
     inline uint32_t targetCoreCount() const { return m_targetTileCount * m_targetWorkerCount; }
     const VNUser1InUse m_user1InUse;
     const VNUser2InUse m_user2InUse;
-    const VNUser3InUse m_user3Inuse;
     AstUser2Allocator<AstNode, NodeInfo> m_nodeInfo;
-    AstUser3Allocator<AstNode, NodeVtx> m_nodeVtx;
     // STATE
     // AstVarScope::user1()  -> Producer partition index + 1 (0 means no producer)
     // AstNode::user1()      -> true if cost is computed
@@ -260,7 +349,7 @@ private:
             uint32_t memAccum = 0;
 
             iterVertex(graphp.get(), [&](AnyVertex* const vtxp) {
-                if (ConstrCommitVertex* const commitp = dynamic_cast<ConstrCommitVertex*>(vtxp)) {
+                if (ConstrCommitVertex* const commitp = vtxp->cast<ConstrCommitVertex>()) {
                     UASSERT(commitp->vscp(), "ConstrCommitVertex of nullptr");
                     UASSERT_OBJ(!commitp->vscp()->user1p(), commitp->vscp(),
                                 "produced by multiple partitions "
@@ -272,7 +361,7 @@ private:
                           * commitp->vscp()->varp()->widthWords();
                     memAccum += bytes;
                 }
-                if (ConstrDefVertex* const constrp = dynamic_cast<ConstrDefVertex*>(vtxp)) {
+                if (ConstrDefVertex* const constrp = vtxp->cast<ConstrDefVertex>()) {
                     UASSERT(constrp->vscp(), "Expected VarScope");
                     auto& infoRef = m_nodeInfo(constrp->vscp());
                     const uint32_t bytes
@@ -299,13 +388,13 @@ private:
                     }
                 }
                 // compute and cache the cost of each node
-                if (CompVertex* const compp = dynamic_cast<CompVertex*>(vtxp)) {
+                if (CompVertex* const compp = vtxp->cast<CompVertex>()) {
                     auto& infoRef = m_nodeInfo(compp->nodep());
 
                     if (PliCheck::check(compp->nodep())) { hasPli[pix] = true; }
 
                     if (!infoRef.visited) {
-                        uint32_t numInstr = V3InstrCount::count(compp->nodep(), false, ofsp.get());
+                        uint32_t numInstr = compp->cost(ofsp.get());
                         infoRef.visited = true;
                         infoRef.nodeIndex = nodeIndex;
                         m_instrCount.push_back(numInstr);
@@ -367,18 +456,16 @@ private:
 
             // Fill-in the duplicate set within the core
             iterVertex(depGraphp.get(), [&](AnyVertex* const vtxp) {
-                if (ConstrVertex* constrp = dynamic_cast<ConstrVertex*>(vtxp)) {
+                if (ConstrVertex* constrp = vtxp->cast<ConstrVertex>()) {
                     // set the variables that are duplicated
                     AstVarScope* const vscp = constrp->vscp();
                     auto& info = m_nodeInfo(vscp);
-                    auto& varDups = corep->dupVarSet();
-                    if (info.hasDuplicates) { varDups.insert(info.nodeDupIndex); }
-                } else if (CompVertex* const compp = dynamic_cast<CompVertex*>(vtxp)) {
+                    if (info.hasDuplicates) { corep->insertDupVar(info.nodeDupIndex); }
+                } else if (CompVertex* const compp = vtxp->cast<CompVertex>()) {
                     // set the compute nodes that are duplicated
                     AstNode* const nodep = compp->nodep();
                     auto& info = m_nodeInfo(nodep);
-                    auto& dups = corep->dupSet();
-                    if (info.hasDuplicates) { dups.insert(info.nodeDupIndex); }
+                    if (info.hasDuplicates) { corep->insertDup(info.nodeDupIndex); }
                 }
             });
         }
@@ -420,41 +507,60 @@ private:
 
         if (dumpGraph() >= 5) { m_coreGraphp->dumpDotFilePrefixed("multicore"); }
     }
-    // compute the cost of merging
+    // step through the in-edges and then the out-edges of corep, start with edgep == nullptr
+    // and inward == true
+    static V3GraphEdge* nextCoreEdge(CoreVertex* corep, V3GraphEdge* edgep, bool& inward) {
+        if (inward) {
+            edgep = edgep ? edgep->inNextp() : corep->inBeginp();
+            if (edgep) return edgep;
+            inward = false;
+            return corep->outBeginp();
+        }
+        return edgep ? edgep->outNextp() : nullptr;
+    }
+    // compute the cost of merging, only looks at the deltas between the two cores: the shared
+    // duplicates and the channels between them
     CostType costAfterMerge(CoreVertex* core1p, CoreVertex* core2p) const {
 
         const uint32_t rawInstrCost = core1p->instrCount() + core2p->instrCount();
         const uint32_t rawRecvCost = core1p->recvWords() + core2p->recvWords();
         const uint32_t rawMemWords = core1p->memoryWords() + core2p->memoryWords();
 
-        auto sumRecvFrom = [](CoreVertex* recvp, CoreVertex* sendp) {
-            uint32_t sum = 0;
-            for (V3GraphEdge* edgep = recvp->inBeginp(); edgep; edgep = edgep->inNextp()) {
-                if (edgep->fromp() == sendp) { sum += static_cast<uint32_t>(edgep->weight()); }
-            }
-            return sum;
-        };
-        const uint32_t recvReduction = sumRecvFrom(core1p, core2p) + sumRecvFrom(core2p, core1p);
+        // There is at most one edge in each direction between two cores (see
+        // removeRedundantEdgesSum and doMergeKeepHeap), so it suffices to scan the
+        // edges of the core with the smaller degree. Walk both edge lists in lock-step to find
+        // it in O(min degree).
+        bool in1 = true;
+        bool in2 = true;
+        V3GraphEdge* edge1p = nextCoreEdge(core1p, nullptr, in1);
+        V3GraphEdge* edge2p = nextCoreEdge(core2p, nullptr, in2);
+        while (edge1p && edge2p) {
+            edge1p = nextCoreEdge(core1p, edge1p, in1);
+            edge2p = nextCoreEdge(core2p, edge2p, in2);
+        }
+        CoreVertex* const scanp = edge1p ? core2p : core1p;
+        CoreVertex* const otherp = scanp == core1p ? core2p : core1p;
+        uint32_t recvReduction = 0;
+        for (V3GraphEdge* edgep = scanp->inBeginp(); edgep; edgep = edgep->inNextp()) {
+            if (edgep->fromp() == otherp) recvReduction += static_cast<uint32_t>(edgep->weight());
+        }
+        for (V3GraphEdge* edgep = scanp->outBeginp(); edgep; edgep = edgep->outNextp()) {
+            if (edgep->top() == otherp) recvReduction += static_cast<uint32_t>(edgep->weight());
+        }
 
         // compute the duplicatation instruction count between the two core
         uint32_t dupCostCommon = 0;
         if (!v3Global.opt.ipuMergeStrategy().ignoreDupCost()) {
-            VlBitSet dupInCommon = VlBitSet::doIntersect(core1p->dupSet(), core2p->dupSet());
-            dupInCommon.foreach([&](size_t dupIx) { dupCostCommon += m_dupInstrCount[dupIx]; });
+            dupCostCommon = core1p->commonDupCost(core2p, m_dupInstrCount);
         }
 
-        // compute the variable duplication count between the two cores
-        VlBitSet varDupInCommon = VlBitSet::doIntersect(core1p->dupVarSet(), core2p->dupVarSet());
-        uint32_t dupVarCostCommon = 0;
-        varDupInCommon.foreach([&](size_t dupIx) { dupVarCostCommon += m_dupVarSize[dupIx]; });
-
         UASSERT(rawInstrCost >= dupCostCommon, "invalid instr cost computation");
         UASSERT(rawRecvCost >= recvReduction, "invalid recv cost computation");
         const uint32_t mergedCost = rawInstrCost - dupCostCommon;
         const uint32_t mergedRecvCost = rawRecvCost - recvReduction;
-        // the following assertion does not need to hold since we only model the
-        // cost of always-live variables and duplications occur in temporary variables
-        // UASSERT(rawMemWords >= dupVarCostCommon, "invalid mem byte computation");
+        // Shared duplicated variables (m_dupVarSize) are not subtracted from the memory since we
+        // only model the cost of always-live variables and duplications occur in temporary
+        // variables
 
         return CostType{mergedCost, mergedRecvCost, rawMemWords};
     }
@@ -468,12 +574,9 @@ private:
         UINFO(10, "merging " << core1p->partsString() << " and " << core2p->partsString() << endl);
 
         // push core2p into core1p
-        std::vector<int> parts{core1p->partp()};
-
         for (const auto p : core2p->partp()) { core1p->partp().push_back(p); }
 
-        core1p->dupSet().unionInPlace(core2p->dupSet());
-        core1p->dupVarSet().unionInPlace(core2p->dupVarSet());
+        core1p->unionDups(core2p);
         core1p->memoryWords(newCost.memWords);
         core1p->instrCount(newCost.instrCount);
         core1p->recvWords(newCost.recvCount);
@@ -892,8 +995,8 @@ private:
                 if (ofsp) {
                     for (V3GraphVertex* vtxp = m_partitionsp.back()->verticesBeginp(); vtxp;
                          vtxp = vtxp->verticesNextp()) {
-                        if (CompVertex* const compp = dynamic_cast<CompVertex*>(vtxp)) {
-                            totalCost += V3InstrCount::count(compp->nodep(), false, ofsp.get());
+                        if (CompVertex* const compp = vtxCast<CompVertex>(vtxp)) {
+                            totalCost += compp->cost(ofsp.get());
                         }
                     }
                 }
@@ -902,38 +1005,17 @@ private:
             }
 
             // a merged partition
-            AstNode::user3ClearTree();
-            // user3u has the new vertices
             m_partitionsp.emplace_back(std::make_unique<DepGraph>());
             const auto& newPartp = m_partitionsp.back();
+            size_t numVertices = 0;
+            for (const int pix : corep->partp()) {
+                numVertices += oldPartitionsp[pix]->vertexCount();
+            }
+            FiberCloner cloner{newPartp.get(), numVertices};
             // iterate the vertices and clone them if not already cloned
             for (const int pix : corep->partp()) {
-                const auto& oldPartp = oldPartitionsp[pix];
-                iterVertex(oldPartp.get(), [&](AnyVertex* vtxp) {
-                    auto cloneOnce = [&newPartp](auto const origp, auto newp) {
-                        // clone only clone does not exist.
-                        if (origp && !(*newp)) { *newp = origp->clone(newPartp.get()); }
-                    };
-
-                    if (ConstrVertex* const constrp = dynamic_cast<ConstrVertex*>(vtxp)) {
-                        UASSERT(constrp->vscp(), "vscp should not be nullptr");
-                        auto& linker = m_nodeVtx(constrp->vscp());
-                        auto const commitp = dynamic_cast<ConstrCommitVertex*>(vtxp);
-                        auto const defp = dynamic_cast<ConstrDefVertex*>(vtxp);
-                        auto const postp = dynamic_cast<ConstrPostVertex*>(vtxp);
-                        auto const initp = dynamic_cast<ConstrInitVertex*>(vtxp);
-                        cloneOnce(commitp, &linker.commitp);
-                        cloneOnce(defp, &linker.defp);
-                        cloneOnce(postp, &linker.postp);
-                        cloneOnce(initp, &linker.initp);
-                    } else {
-                        CompVertex* const compp = dynamic_cast<CompVertex*>(vtxp);
-                        UASSERT(compp, "ill-constructed partitionp" << pix << endl);
-                        if (ofsp && !m_nodeVtx(compp->nodep()).compp) {
-                            totalCost += V3InstrCount::count(compp->nodep(), false, ofsp.get());
-                        }
-                        cloneOnce(compp, &m_nodeVtx(compp->nodep()).compp);
-                    }
+                cloner.cloneVertices(oldPartitionsp[pix].get(), [&](CompVertex* compp) {
+                    if (ofsp) totalCost += compp->cost(ofsp.get());
                 });
             }
             if (ofsp) {
@@ -942,54 +1024,8 @@ private:
                                                      << " in core " << pix << endl);
             }
             // now iterate old edges and clone them
-            auto getNewVtxp = [this](AnyVertex* const oldp) -> AnyVertex* {
-                AnyVertex* newp = nullptr;
-                if (auto const compp = dynamic_cast<CompVertex*>(oldp)) {
-                    newp = m_nodeVtx(compp->nodep()).compp;
-                } else {
-                    auto const constrp = dynamic_cast<ConstrVertex*>(oldp);
-                    auto& linker = m_nodeVtx(constrp->vscp());
-                    if (dynamic_cast<ConstrCommitVertex*>(oldp)) {
-                        newp = linker.commitp;
-                    } else if (dynamic_cast<ConstrDefVertex*>(oldp)) {
-                        newp = linker.defp;
-                    } else if (dynamic_cast<ConstrPostVertex*>(oldp)) {
-                        newp = linker.postp;
-                    } else if (dynamic_cast<ConstrInitVertex*>(oldp)) {
-                        newp = linker.initp;
-                    }
-                }
-                UASSERT(newp, "vertex not cloned");
-                return newp;
-            };
-            for (const int pix : corep->partp()) {
-                const auto& oldPartp = oldPartitionsp[pix];
-                // TODO: do not create redundant edges
-                iterVertex(oldPartp.get(), [&](AnyVertex* vtxp) {
-                    for (V3GraphEdge* edgep = vtxp->outBeginp(); edgep;
-                         edgep = edgep->outNextp()) {
-                        // DepEdge* dedgep = dynamic_cast<DepEdge*>(edgep);
-                        // UASSERT(dedgep, "invalid edge type");
-                        ConstrVertex* const fromConstrp
-                            = dynamic_cast<ConstrVertex*>(edgep->fromp());
-                        CompVertex* const toCompp = dynamic_cast<CompVertex*>(edgep->top());
-                        if (fromConstrp && toCompp) {
-                            auto newFromp = dynamic_cast<ConstrVertex*>(getNewVtxp(fromConstrp));
-                            auto newTop = dynamic_cast<CompVertex*>(getNewVtxp(toCompp));
-                            newPartp->addEdge(newFromp, newTop);
-                        } else {
-                            ConstrVertex* const toConstrp
-                                = dynamic_cast<ConstrVertex*>(edgep->top());
-                            CompVertex* const frompCompp
-                                = dynamic_cast<CompVertex*>(edgep->fromp());
-                            UASSERT(toConstrp && frompCompp, "ill-constructed graph");
-                            auto newFromp = dynamic_cast<CompVertex*>(getNewVtxp(frompCompp));
-                            auto newTop = dynamic_cast<ConstrVertex*>(getNewVtxp(toConstrp));
-                            newPartp->addEdge(newFromp, newTop);
-                        }
-                    }
-                });
-            }
+            // TODO: do not create redundant edges
+            for (const int pix : corep->partp()) { cloner.cloneEdges(oldPartitionsp[pix].get()); }
             newPartp->removeRedundantEdges(V3GraphEdge::followAlwaysTrue);
             pix++;
         });
@@ -1037,13 +1073,6 @@ public:
 
 void V3BspMerger::merge(std::vector<std::unique_ptr<DepGraph>>& oldFibersp,
                         const std::vector<std::vector<std::size_t>>& indices) {
-    struct NodeVtx {
-        ConstrCommitVertex* commitp = nullptr;
-        ConstrDefVertex* defp = nullptr;
-        ConstrPostVertex* postp = nullptr;
-        ConstrInitVertex* initp = nullptr;
-        CompVertex* compp = nullptr;
-    };
 
     std::ofstream summary{v3Global.opt.makeDir() + "/" + "mergedCostEstimate.txt"};
     // clang-format off
@@ -1073,7 +1102,7 @@ void V3BspMerger::merge(std::vector<std::unique_ptr<DepGraph>>& oldFibersp,
         //         for (V3GraphVertex* vtxp = newPartitionsp.back()->verticesBeginp(); vtxp;
         //              vtxp = vtxp->verticesNextp()) {
         //             if (CompVertex* const compp = dynamic_cast<CompVertex*>(vtxp)) {
-        //                 totalCost += V3InstrCount::count(compp->nodep(), false, ofsp.get());
+        //                 totalCost += compp->cost(ofsp.get());
         //             }
         //         }
         //     }
@@ -1081,92 +1110,26 @@ void V3BspMerger::merge(std::vector<std::unique_ptr<DepGraph>>& oldFibersp,
         // }
 
         // a merged partition
-
-        std::unordered_map<AstNode*, NodeVtx> nodeLookup;
-        // user3u has the new vertices
         newPartitionsp.emplace_back(std::make_unique<DepGraph>());
         const auto& newPartp = newPartitionsp.back();
-        // iterate the vertices and clone them if not already cloned
+        size_t numVertices = 0;
         for (const int fiberId : includedParts) {
-            const auto& oldPartp = oldFibersp[fiberId];
-            for (V3GraphVertex* vtxp = oldPartp->verticesBeginp(); vtxp;
-                 vtxp = vtxp->verticesNextp()) {
-                auto cloneOnce = [&newPartp](auto const origp, auto newp) {
-                    // clone only clone does not exist, since fibers share compuate, the
-                    // clone may already exist.
-                    if (origp && !(*newp)) { *newp = origp->clone(newPartp.get()); }
-                };
-
-                if (ConstrVertex* const constrp = dynamic_cast<ConstrVertex*>(vtxp)) {
-                    UASSERT(constrp->vscp(), "vscp should not be nullptr");
-                    auto& linker = nodeLookup[constrp->vscp()];
-                    auto const commitp = dynamic_cast<ConstrCommitVertex*>(vtxp);
-                    auto const defp = dynamic_cast<ConstrDefVertex*>(vtxp);
-                    auto const postp = dynamic_cast<ConstrPostVertex*>(vtxp);
-                    auto const initp = dynamic_cast<ConstrInitVertex*>(vtxp);
-                    cloneOnce(commitp, &linker.commitp);
-                    cloneOnce(defp, &linker.defp);
-                    cloneOnce(postp, &linker.postp);
-                    cloneOnce(initp, &linker.initp);
-                } else {
-                    CompVertex* const compp = dynamic_cast<CompVertex*>(vtxp);
-                    UASSERT(compp, "ill-constructed fiber " << fiberId << endl);
-                    if (ofsp && !nodeLookup[compp->nodep()].compp) {
-                        totalCost += V3InstrCount::count(compp->nodep(), false, ofsp.get());
-                    }
-                    cloneOnce(compp, &nodeLookup[compp->nodep()].compp);
-                }
-            }
+            numVertices += oldFibersp[fiberId]->vertexCount();
+        }
+        FiberCloner cloner{newPartp.get(), numVertices};
+        // iterate the vertices and clone them if not already cloned, since fibers share
+        // compute, the clone may already exist.
+        for (const int fiberId : includedParts) {
+            cloner.cloneVertices(oldFibersp[fiberId].get(), [&](CompVertex* compp) {
+                if (ofsp) totalCost += compp->cost(ofsp.get());
+            });
         }
         summary << pix << "            " << totalCost << "            "
                 << (memUsage * VL_EDATASIZE / VL_BYTESIZE) << "            "
                 << includedParts.size() << std::endl;
         // now iterate old edges and clone them
-        auto getNewVtxp = [&nodeLookup](AnyVertex* const oldp) -> AnyVertex* {
-            AnyVertex* newp = nullptr;
-            if (auto const compp = dynamic_cast<CompVertex*>(oldp)) {
-                newp = nodeLookup[compp->nodep()].compp;
-            } else {
-                auto const constrp = dynamic_cast<ConstrVertex*>(oldp);
-                auto& linker = nodeLookup[constrp->vscp()];
-                if (dynamic_cast<ConstrCommitVertex*>(oldp)) {
-                    newp = linker.commitp;
-                } else if (dynamic_cast<ConstrDefVertex*>(oldp)) {
-                    newp = linker.defp;
-                } else if (dynamic_cast<ConstrPostVertex*>(oldp)) {
-                    newp = linker.postp;
-                } else if (dynamic_cast<ConstrInitVertex*>(oldp)) {
-                    newp = linker.initp;
-                }
-            }
-            UASSERT(newp, "vertex not cloned");
-            return newp;
-        };
-        for (int fiberId : includedParts) {
-            const auto& oldPartp = oldFibersp[fiberId];
-            // TODO: do not create redundant edges
-            for (V3GraphVertex* vtxp = oldPartp->verticesBeginp(); vtxp;
-                 vtxp = vtxp->verticesNextp()) {
-                for (V3GraphEdge* edgep = vtxp->outBeginp(); edgep; edgep = edgep->outNextp()) {
-                    // DepEdge* dedgep = dynamic_cast<DepEdge*>(edgep);
-                    // UASSERT(dedgep, "invalid edge type");
-                    ConstrVertex* const fromConstrp = dynamic_cast<ConstrVertex*>(edgep->fromp());
-                    CompVertex* const toCompp = dynamic_cast<CompVertex*>(edgep->top());
-                    if (fromConstrp && toCompp) {
-                        auto newFromp = dynamic_cast<ConstrVertex*>(getNewVtxp(fromConstrp));
-                        auto newTop = dynamic_cast<CompVertex*>(getNewVtxp(toCompp));
-                        newPartp->addEdge(newFromp, newTop);
-                    } else {
-                        ConstrVertex* const toConstrp = dynamic_cast<ConstrVertex*>(edgep->top());
-                        CompVertex* const frompCompp = dynamic_cast<CompVertex*>(edgep->fromp());
-                        UASSERT(toConstrp && frompCompp, "ill-constructed graph");
-                        auto newFromp = dynamic_cast<CompVertex*>(getNewVtxp(frompCompp));
-                        auto newTop = dynamic_cast<ConstrVertex*>(getNewVtxp(toConstrp));
-                        newPartp->addEdge(newFromp, newTop);
-                    }
-                }
-            }
-        }
+        // TODO: do not create redundant edges
+        for (const int fiberId : includedParts) { cloner.cloneEdges(oldFibersp[fiberId].get()); }
         newPartp->removeRedundantEdges(V3GraphEdge::followAlwaysTrue);
     }
 
@@ -23,10 +23,15 @@
 #include "V3AstUserAllocator.h"
 #include "V3BspGraph.h"
 #include "V3InstrCount.h"
+#include "V3Os.h"
 #include "V3Stats.h"
+#include "V3ThreadPool.h"
 #include "V3UniqueNames.h"
 
 #include <algorithm>
+#include <atomic>
+#include <future>
+#include <unordered_map>
 VL_DEFINE_DEBUG_FUNCTIONS;
 
 namespace V3BspSched {
@@ -80,7 +85,7 @@ public:
         std::vector<SchedVertex*> newVtxsp;
         for (V3GraphVertex* vtxp = graphp->verticesBeginp(); vtxp; vtxp = vtxp->verticesNextp()) {
             if (color && vtxp->color() != color) continue;
-            if (CompVertex* const compp = dynamic_cast<CompVertex*>(vtxp)) {
+            if (CompVertex* const compp = vtxCast<CompVertex>(vtxp)) {
                 SchedVertex* const newp = new SchedVertex{schedGraphp.get()};
                 newp->compp(compp);
                 auto nodep = newp->compp()->nodep();
@@ -96,10 +101,10 @@ public:
         for (SchedVertex* schedp : newVtxsp) {
             for (V3GraphEdge* edgep = schedp->compp()->outBeginp(); edgep;
                  edgep = edgep->outNextp()) {
-                UASSERT(dynamic_cast<ConstrVertex*>(edgep->top()), "invalid vertex type!");
+                UASSERT(vtxIs<ConstrVertex>(edgep->top()), "invalid vertex type!");
                 for (V3GraphEdge* edge2p = edgep->top()->outBeginp(); edge2p;
                      edge2p = edge2p->outNextp()) {
-                    CompVertex* succCompp = dynamic_cast<CompVertex*>(edge2p->top());
+                    CompVertex* succCompp = vtxCast<CompVertex>(edge2p->top());
                     UASSERT(succCompp, "invalid vertex type");
                     UASSERT(newVtxMapp.count(succCompp), "not found");
                     SchedVertex* succp = newVtxMapp.find(succCompp)->second;
@@ -248,6 +253,7 @@ class VarScopeReferences {
 private:
     DepGraph* m_producer = nullptr;
     std::vector<DepGraph*> m_consumer;
+    std::vector<DepGraph*> m_replicas;  // consumers that also recompute it, see V3BspLookahead
     std::pair<AstVarScope*, AstVar*> m_sourcep;
     std::vector<std::pair<AstVarScope*, AstVar*>> m_targets;
     std::pair<AstVarScope*, AstVar*> m_initp;
@@ -273,6 +279,13 @@ public:
     inline bool isRemote(const std::unique_ptr<DepGraph>& graphp) const {
         return !isLocal() && !isOwned(graphp);
     }
+    inline bool isReplica(const std::unique_ptr<DepGraph>& graphp) const {
+        return std::find(m_replicas.begin(), m_replicas.end(), graphp.get()) != m_replicas.end();
+    }
+    inline void replica(const std::unique_ptr<DepGraph>& graphp) {
+        m_replicas.push_back(graphp.get());
+        consumer(graphp);
+    }
     inline void producer(const std::unique_ptr<DepGraph>& graphp) {
         UASSERT(!m_producer || m_producer == graphp.get(), "multiple producers!");
         m_producer = graphp.get();
@@ -315,6 +328,7 @@ private:
     V3UniqueNames m_memberNames;
     AstNetlist* m_netlistp;  // original netlist
     const std::vector<std::unique_ptr<DepGraph>>& m_partitionsp;  // partitions
+    V3BspModules::PartitionClasses m_partitionClasses;  // class made for each partition
     const V3Sched::LogicByScope m_initials;
     const V3Sched::LogicByScope m_initialStatics;
     const V3Sched::LogicByScope m_actives;
@@ -364,6 +378,14 @@ private:
         return false;
     }
 
+    void produced(AstVarScope* vscp, const std::unique_ptr<DepGraph>& graphp) {
+        if (graphp->isReplica(vscp)) {
+            // only a copy of the logic of the owner, the owner stays the producer
+            m_vscpRefs(vscp).replica(graphp);
+        } else {
+            m_vscpRefs(vscp).producer(graphp);
+        }
+    }
     // compute the references to each variable
     void computeReferences() {
         AstNode::user1ClearTree();
@@ -373,10 +395,10 @@ private:
             UINFO(100, "Inspecting graph " << graphp.get() << endl);
             for (V3GraphVertex* vtxp = graphp->verticesBeginp(); vtxp;
                  vtxp = vtxp->verticesNextp()) {
-                if (ConstrDefVertex* const defp = dynamic_cast<ConstrDefVertex*>(vtxp)) {
+                if (ConstrDefVertex* const defp = vtxCast<ConstrDefVertex>(vtxp)) {
                     UINFO(100, "consumed: " << defp->vscp()->name() << endl);
                     m_vscpRefs(defp->vscp()).consumer(graphp);
-                } else if (CompVertex* const compp = dynamic_cast<CompVertex*>(vtxp)) {
+                } else if (CompVertex* const compp = vtxCast<CompVertex>(vtxp)) {
                     if (VN_IS(compp->nodep(), AssignPost) || VN_IS(compp->nodep(), AlwaysPost)) {
                         // this is a commit node whose variables appears in the LHS of some post
                         // assignment
@@ -384,7 +406,7 @@ private:
                             if (vrefp->access().isWriteOrRW()) {
                                 UINFO(100, "produced: " << vrefp->varScopep()->name() << " from "
                                                         << cvtToHex(compp->nodep()) << endl);
-                                m_vscpRefs(vrefp->varScopep()).producer(graphp);
+                                produced(vrefp->varScopep(), graphp);
                             }
                         });
                     }
@@ -396,11 +418,11 @@ private:
                         });
                     }
                 } else if (ConstrCommitVertex* const commitp
-                           = dynamic_cast<ConstrCommitVertex*>(vtxp)) {
+                           = vtxCast<ConstrCommitVertex>(vtxp)) {
                     if (commitp->outEmpty()) {
                         UINFO(100,
                               "produced: " << commitp->vscp()->name() << " from commit" << endl);
-                        m_vscpRefs(commitp->vscp()).producer(graphp);
+                        produced(commitp->vscp(), graphp);
                     } else {
                         // Leads to an LHS of a post assignment which is handled above.
                         // Note that a commit node with both and incoming edge and outgoing
@@ -468,11 +490,21 @@ private:
                 stp->foreach([this, stp](AstVarRef* vrefp) {
                     if (vrefp->varp()->isUsedClock() && vrefp->varp()->isReadOnly()
                         && !stp->sensesp()->nextp() /* should be a single item*/) {
-                        UASSERT_OBJ(m_triggering.autoTriggerp == vrefp->varScopep()
-                                        || !m_triggering.autoTriggerp,
-                                    vrefp->varScopep(), "Could not determine global clock");
-                        // select the global clocker, there should be just one global clock for now
-                        // and this global clock should be the sole primary IO of the top module
+                        if (m_triggering.autoTriggerp
+                            && m_triggering.autoTriggerp != vrefp->varScopep()) {
+                            vrefp->v3warn(E_UNSUPPORTED, "Multiple primary clocks: "
+                                                             << vrefp->prettyNameQ() << " and "
+                                                             << m_triggering.autoTriggerp
+                                                                    ->prettyNameQ()
+                                                             << "\n"
+                                                             << vrefp->warnMore()
+                                                             << "... Only clocks derived from "
+                                                                "a single primary clock are "
+                                                                "supported");
+                            return;
+                        }
+                        // select the global clocker, there should be just one primary clock and
+                        // all other clocks should be derived from it (e.g., divided clocks)
                         m_triggering.autoTriggerp = vrefp->varScopep();
                         m_triggering.autoTriggerSenTreep = stp;
                     }
@@ -495,15 +527,56 @@ private:
         // make base classes for compute and top level program
         // now go though all partitions and create a class and an instance of it
         std::vector<AstClass*> vtxClassesp;
-        // AstTopScope* topScopep =
-        int index = 0;
+        // Parallel ordering: ordering the computation only touches the graph of each
+        // partition, so all the partitions are ordered in parallel. Building a class stays
+        // serial, it consumes the orders as they become ready. It can not run in parallel
+        // because:
+        // - makeClass clears user2/user3 for each class; the clear bumps a process wide
+        //   generation counter, so two classes can not own these fields at the same time.
+        // - Replicated logic is cloned into several classes. cloneTree goes through the
+        //   clonep() field of the source nodes and the global clone counter.
+        // - m_vscpRefs (user1) records the producer and consumers of each variable for
+        //   every class.
+        // - Editing the tree bumps the global edit count, and with VL_LEAK_CHECKS node
+        //   allocation updates the V3Broken tables. None of these are thread safe.
+        // - m_modNames and m_memberNames hand out the class and member names in
+        //   partition order, which keeps the output stable between runs.
+        // The stats below tell the two apart: the serial part only waits for an order if
+        // ordering is the bottleneck.
+        std::atomic<uint64_t> orderUsecs{0};
+        std::vector<std::future<std::vector<CompVertex*>>> orders;
         for (const auto& graphp : m_partitionsp) {
             UASSERT(graphp->verticesBeginp(), "Expected non-empty graph");
-            AstClass* modp = makeClass(graphp);
-            if (dumpGraph() > 0) { graphp->dumpDotFilePrefixed("ordered_" + cvtToStr(index++)); }
+            DepGraph* const gp = graphp.get();
+            orders.emplace_back(V3ThreadPool::s().enqueue(
+                std::function<std::vector<CompVertex*>()>([gp, &orderUsecs]() {
+                    const uint64_t startUsecs = V3Os::timeUsecs();
+                    std::vector<CompVertex*> order = HybridDfsBfsScheduler::schedule(gp);
+                    orderUsecs += V3Os::timeUsecs() - startUsecs;
+                    return order;
+                })));
+        }
+        uint64_t waitUsecs = 0;
+        uint64_t buildUsecs = 0;
+        int index = 0;
+        for (const auto& graphp : m_partitionsp) {
+            UASSERT(orders[index].valid(), "invalid future?");
+            const uint64_t waitStartUsecs = V3Os::timeUsecs();
+            const std::vector<CompVertex*> orderedVtxps
+                = V3ThreadPool::s().waitForFuture(orders[index]);
+            const uint64_t buildStartUsecs = V3Os::timeUsecs();
+            waitUsecs += buildStartUsecs - waitStartUsecs;
+            AstClass* modp = makeClass(graphp, orderedVtxps);
+            m_partitionClasses.emplace(graphp.get(), modp);
+            buildUsecs += V3Os::timeUsecs() - buildStartUsecs;
+            if (dumpGraph() > 0) { graphp->dumpDotFilePrefixed("ordered_" + cvtToStr(index)); }
+            index++;
 
             vtxClassesp.push_back(modp);
         }
+        V3Stats::addStatPerf("BspModules, ordering time, all threads (sec)", orderUsecs / 1.0e6);
+        V3Stats::addStatPerf("BspModules, waiting for ordering (sec)", waitUsecs / 1.0e6);
+        V3Stats::addStatPerf("BspModules, building classes (sec)", buildUsecs / 1.0e6);
 
         // make class for initialization
         return vtxClassesp;
@@ -644,6 +717,7 @@ private:
         // void triggerEval() {
         //     trigger.clear();
         //     while (trigger.empty()) {
+        //          combinational active region logic
         //          trigger.set(...)
         //          trigger.set(...)
         //          if (!trigger.any()) {
@@ -651,6 +725,16 @@ private:
         //              time += 1;
         //          }
         //     }
+        //     // only if there is clocked logic in the active region (e.g., a divided clock)
+        //     settle.clear();
+        //     settle.thisOr(trigger);
+        //     while (settle.any()) {
+        //          if (settle.at(...)) { pre and clocked active region logic }
+        //          combinational active region logic
+        //          settle.clear();
+        //          settle.set(...)
+        //          trigger.thisOr(settle);
+        //     }
         // }
         trigEvalFuncp->isMethod(true);
         trigEvalFuncp->isInline(true);
@@ -752,6 +836,8 @@ private:
             });
 
         AstNode* const actp = new AstComment{classp->fileline(), "active region computation"};
+        // Active region logic in order, along with the domain of the clocked ones
+        std::vector<std::pair<AstSenTree*, AstNode*>> actLogicp;
         for (const std::pair<AstScope*, AstActive*>& activePair : m_actives) {
 
             // "act" region should be execute before setting the triggers
@@ -797,9 +883,34 @@ private:
                 });
             AstNode* const clonep = activePair.second->stmtsp()->cloneTree(true);
             for (AstNode* cp = clonep; cp; cp = cp->nextp()) { ReplaceOldVarRefsVisitor{cp}; }
-            actp->addNext(clonep);
+            AstSenTree* const senTreep = activePair.second->sensesp();
+            if (senTreep->hasCombo()) {
+                actLogicp.emplace_back(nullptr, clonep);
+            } else {
+                // AssignPre logic or logic that computes a clock from another clock. This
+                // should only run once the triggers of its domain are known.
+                const auto it = std::find_if(
+                    atFuncs.begin(), atFuncs.end(),
+                    [senTreep](const auto& p) { return p.first->sameTree(senTreep); });
+                UASSERT_OBJ(it != atFuncs.end(), senTreep, "unknown active domain");
+                actLogicp.emplace_back(it->first, clonep);
+            }
+        }
+        bool hasClockedAct = false;
+        for (const auto& pair : actLogicp) {
+            if (pair.first) {
+                hasClockedAct = true;
+            } else {
+                actp->addNext(pair.second->cloneTree(true));
+            }
         }
 
+        // keep clones of the trigger computation for the settle loop below
+        AstNode* const settleSetStmtp
+            = hasClockedAct && trigSetStmtp ? trigSetStmtp->cloneTree(true) : nullptr;
+        AstNode* const settleUpdateStmtp
+            = hasClockedAct && trigUpdateStmtp ? trigUpdateStmtp->cloneTree(true) : nullptr;
+
         trigLoopp->addStmtsp(actp);
 
         trigLoopp->addStmtsp(trigSetStmtp);
@@ -817,11 +928,80 @@ private:
         AstIf* const doTogglep
             = new AstIf{classp->fileline(), trigEmptyp->cloneTree(false), clockTogglep, nullptr};
         trigLoopp->addStmtsp(doTogglep);
+
+        if (hasClockedAct) {
+            makeSettleLoop(trigEvalFuncp, classp, scopep, thisTrigVscp, actLogicp, atFuncs,
+                           settleSetStmtp, settleUpdateStmtp);
+        } else {
+            for (const auto& pair : actLogicp) VL_DO_DANGLING(pair.second->deleteTree(), pair);
+        }
         trigEvalFuncp->addStmtsp(new AstCReturn{
             classp->fileline(), new AstVarRef{classp->fileline(), thisTrigVscp, VAccess::READ}});
         return {atFuncs, trigEvalFuncp};
     }
 
+    // Execute the clocked logic of the active region (AssignPre logic and logic computing
+    // derived clocks) for the domains that fired, then recompute the triggers. Repeat until
+    // no new trigger fires, every domain triggered along the way is then executed by nbaTop.
+    void makeSettleLoop(AstCFunc* trigEvalFuncp, AstClass* classp, AstScope* scopep,
+                        AstVarScope* thisTrigVscp,
+                        const std::vector<std::pair<AstSenTree*, AstNode*>>& actLogicp,
+                        std::map<AstSenTree*, TrigAtGen>& atFuncs, AstNode* setStmtp,
+                        AstNode* updateStmtp) {
+        FileLine* const fl = classp->fileline();
+        AstVar* const settleTrigp
+            = new AstVar{fl, VVarType::MEMBER, freshName("settleTrig"), m_triggering.trigDTypep};
+        settleTrigp->funcLocal(true);
+        settleTrigp->lifetime(VLifetime::AUTOMATIC);
+        trigEvalFuncp->addStmtsp(settleTrigp);
+        AstVarScope* const settleTrigVscp = new AstVarScope{fl, scopep, settleTrigp};
+        scopep->addVarsp(settleTrigVscp);
+
+        auto mkCall = [fl](AstVarScope* vscp, VAccess access, const string& name,
+                           AstNodeExpr* argp) {
+            AstCMethodHard* const callp
+                = new AstCMethodHard{fl, new AstVarRef{fl, vscp, access}, name, argp};
+            callp->dtypeSetVoid();
+            return callp;
+        };
+        auto mkClearOr = [&](AstVarScope* dstp, AstVarScope* srcp, bool clear) {
+            AstNode* const orp = new AstStmtExpr{
+                fl, mkCall(dstp, VAccess::WRITE, "thisOr", new AstVarRef{fl, srcp, VAccess::READ})};
+            if (!clear) return orp;
+            AstNode* const clearp
+                = new AstStmtExpr{fl, mkCall(dstp, VAccess::WRITE, "clear", nullptr)};
+            clearp->addNext(orp);
+            return clearp;
+        };
+        trigEvalFuncp->addStmtsp(mkClearOr(settleTrigVscp, thisTrigVscp, true));
+
+        AstCMethodHard* const anyp = mkCall(settleTrigVscp, VAccess::READ, "any", nullptr);
+        anyp->dtypeSetBit();
+        AstWhile* const settleLoopp = new AstWhile{fl, anyp, nullptr, nullptr};
+        trigEvalFuncp->addStmtsp(settleLoopp);
+        for (const auto& pair : actLogicp) {
+            if (pair.first) {
+                settleLoopp->addStmtsp(
+                    new AstIf{fl, atFuncs[pair.first](settleTrigVscp), pair.second, nullptr});
+            } else {
+                settleLoopp->addStmtsp(pair.second);
+            }
+        }
+        settleLoopp->addStmtsp(new AstStmtExpr{
+            fl, mkCall(settleTrigVscp, VAccess::WRITE, "clear", nullptr)});
+        // retarget the trigger computation to the settle triggers
+        if (setStmtp) {
+            setStmtp->foreachAndNext([&](AstVarRef* refp) {
+                if (refp->varScopep() != thisTrigVscp) return;
+                refp->varScopep(settleTrigVscp);
+                refp->varp(settleTrigp);
+            });
+            settleLoopp->addStmtsp(setStmtp);
+        }
+        if (updateStmtp) settleLoopp->addStmtsp(updateStmtp);
+        settleLoopp->addStmtsp(mkClearOr(thisTrigVscp, settleTrigVscp, false));
+    }
+
     void makeClassMemberVarOrConst(AstVarScope* const vscp,
                                    const std::unique_ptr<DepGraph>& graphp, AstScope* const scopep,
                                    AstClass* const classp, AstVarScope* const instVscp,
@@ -878,6 +1058,15 @@ private:
                 refInfo.addTargetp({instVscp, varp});
                 varp->bspFlag(VBspFlag{}.append(VBspFlag::MEMBER_OUTPUT));
                 V3Stats::addStatSum("BspModules, output variable", 1);
+            } else if (refInfo.isReplica(graphp)
+                       && (refInfo.isClocked() || refInfo.initp().first)) {
+                // recomputed here between exchanges (--bsp-lookahead), but received
+                // from the owner like any other input
+                classp->addStmtsp(varp);
+                varp->bspFlag(
+                    VBspFlag{}.append(VBspFlag::MEMBER_INPUT).append(VBspFlag::MEMBER_LOCAL));
+                refInfo.addTargetp(std::make_pair(instVscp, varp));
+                V3Stats::addStatSum("BspModules, replica variable", 1);
             } else if (refInfo.isClocked() || refInfo.initp().first) {
                 UASSERT_OBJ(refInfo.isConsumed(graphp), vscp, "Unexpected reference!");
                 // not produced here but consumed
@@ -906,7 +1095,7 @@ private:
                              AstClass* const classp, AstVarScope* const instVscp,
                              AstCFunc* const nbaTopp, FileLine* const fl) {
         for (V3GraphVertex* vtxp = graphp->verticesBeginp(); vtxp; vtxp = vtxp->verticesNextp()) {
-            if (ConstrVertex* constrp = dynamic_cast<ConstrVertex*>(vtxp)) {
+            if (ConstrVertex* constrp = vtxCast<ConstrVertex>(vtxp)) {
                 AstVarScope* vscp = constrp->vscp();
                 makeClassMemberVarOrConst(vscp, graphp, scopep, classp, instVscp, nbaTopp, fl);
             }
@@ -915,15 +1104,17 @@ private:
 
     /// @brief create a class for the given partiton
     /// @param graphp
+    /// @param orderedVtxps the compute vertices of graphp in execution order
     /// @return
-    AstClass* makeClass(const std::unique_ptr<DepGraph>& graphp) {
+    AstClass* makeClass(const std::unique_ptr<DepGraph>& graphp,
+                        const std::vector<CompVertex*>& orderedVtxps) {
 
         m_memberNames.reset();
         UASSERT(m_packagep, "need bsp package!");
         FileLine* fl = nullptr;
         // get a better fileline
         for (V3GraphVertex* itp = graphp->verticesBeginp(); itp; itp = itp->verticesNextp()) {
-            if (CompVertex* vtxp = dynamic_cast<CompVertex*>(itp)) {
+            if (CompVertex* vtxp = vtxCast<CompVertex>(itp)) {
                 if (VN_IS(vtxp->nodep(), AlwaysPost) || VN_IS(vtxp->nodep(), AssignPost)) {
                     fl = vtxp->nodep()->fileline();
                 } else if (!fl) {
@@ -985,10 +1176,6 @@ private:
         // triggerCheckGen can be used to create trigger.at(i) expression for each AstSenTree
 
         // add the computation
-        UINFO(5, "Ordering computation" << endl);
-        // graphp->order();  // order the computation
-
-        std::vector<CompVertex*> orderedVtxps = HybridDfsBfsScheduler::schedule(graphp.get());
         // Go through the compute vertices in order and append them to nbaTopp.
         // Each compute vertex has a domainp (nullptr if combinatiol) that
         // determines whether the statement should fire or not. We keep track
@@ -1239,13 +1426,17 @@ private:
         AstCFunc* computeSetp
             = new AstCFunc{m_netlistp->topModulep()->fileline(), funcName, m_topScopep, "void"};
         computeSetp->dontCombine(true);
+        // a single pass over the instances, there are as many as classes
+        std::unordered_map<const AstClass*, AstVarScope*> instances;
+        for (AstVarScope* vscp = m_topScopep->varsp(); vscp;
+             vscp = VN_AS(vscp->nextp(), VarScope)) {
+            AstClassRefDType* classRefp = VN_CAST(vscp->dtypep(), ClassRefDType);
+            if (classRefp) instances.emplace(classRefp->classp(), vscp);
+        }
         for (AstClass* classp : computeClassesp) {
-            AstVarScope* vscp = nullptr;
-            for (vscp = m_topScopep->varsp(); vscp; vscp = VN_AS(vscp->nextp(), VarScope)) {
-                AstClassRefDType* classRefp = VN_CAST(vscp->dtypep(), ClassRefDType);
-                if (classRefp && classRefp->classp() == classp) break;
-            }
-            UASSERT(vscp, "did not find class instance!");
+            const auto it = instances.find(classp);
+            UASSERT(it != instances.end(), "did not find class instance!");
+            AstVarScope* const vscp = it->second;
             FileLine* fl = vscp->fileline();
             AstCFunc* methodp = nullptr;
             classp->foreach([&methodp](AstCFunc* np) {
@@ -1422,6 +1613,9 @@ public:
         m_netlistp->addModulesp(initClassp->classOrPackagep());
         // 5. create a class that handles the initialization
     }
+    const V3BspModules::PartitionClasses& partitionClasses() const {
+        return m_partitionClasses;
+    }
 
 };  // namespace
 }  // namespace
@@ -1431,17 +1625,20 @@ std::string V3BspModules::builtinBaseClass = "__VbuiltinBspCompute";
 std::string V3BspModules::builtinBaseInitClass = "__VbuiltinBspInit";
 std::string V3BspModules::builtinBaseClassPkg = "__VbuiltinBspComputePkg";
 
-void V3BspModules::makeModules(AstNetlist* netlistp,
-                               const std::vector<std::unique_ptr<DepGraph>>& partitionsp,
-                               const V3Sched::LogicByScope& initials,
-                               const V3Sched::LogicByScope& statics,
-                               const V3Sched::LogicByScope& actives) {
-
+V3BspModules::PartitionClasses
+V3BspModules::makeModules(AstNetlist* netlistp,
+                          const std::vector<std::unique_ptr<DepGraph>>& partitionsp,
+                          const V3Sched::LogicByScope& initials,
+                          const V3Sched::LogicByScope& statics,
+                          const V3Sched::LogicByScope& actives) {
+    PartitionClasses partitionClasses;
     {
         ModuleBuilderImpl builder{netlistp, partitionsp, initials, statics, actives};
         builder.go();
+        partitionClasses = builder.partitionClasses();
     }
     V3Global::dumpCheckGlobalTree("bspmodules", 0, dumpTree() >= 1);
+    return partitionClasses;
 }
 
 namespace {
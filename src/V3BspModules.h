@@ -22,6 +22,8 @@
 #include "V3Ast.h"
 #include "V3BspGraph.h"
 #include "V3Sched.h"
+
+#include <unordered_map>
 class DepGraph;
 class AstNetlist;
 class AstModule;
@@ -34,7 +36,9 @@ public:
     static std::string builtinBaseClass;
     static std::string builtinBaseInitClass;
     static std::string builtinBaseClassPkg;
-    static void makeModules(AstNetlist* origp,
+    // Class of each partition, keyed by the partition it was built from
+    using PartitionClasses = std::unordered_map<const DepGraph*, AstClass*>;
+    static PartitionClasses makeModules(AstNetlist* origp,
                             const std::vector<std::unique_ptr<DepGraph>>& partitionsp,
                             const V3Sched::LogicByScope& initials,
                             const V3Sched::LogicByScope& statics,
@@ -0,0 +1,266 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Reuse BSP partitions of a previous run
+//
+// Code available from: https://verilator.org
+//
+//*************************************************************************
+//
+// Copyright 2003-2023 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+
+#include "V3BspPartitionCache.h"
+
+#include "V3BspMerger.h"
+#include "V3File.h"
+#include "V3Global.h"
+#include "V3InstrCount.h"
+#include "V3Os.h"
+#include "V3Stats.h"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <unordered_set>
+
+VL_DEFINE_DEBUG_FUNCTIONS;
+
+namespace V3BspSched {
+
+string PartitionCache::filename() {
+    return v3Global.opt.makeDir() + "/" + v3Global.opt.prefix() + "__bsp_partitions.dat";
+}
+
+// Anything that changes the outcome of partitioning invalidates the cache
+string PartitionCache::configKey() {
+    const V3Options& opt = v3Global.opt;
+    std::stringstream ss;
+    ss << "tiles=" << opt.tiles() << " workers=" << opt.workers()
+       << " tilesPerIpu=" << opt.tilesPerIpu() << " merge=" << opt.ipuMergeStrategy().ascii()
+       << " threshold=" << opt.ipuMergeStrategy().threshold()
+       << " minTiles=" << opt.ipuMergeStrategy().minimizeTileCount()
+       << " ignoreDup=" << opt.ipuMergeStrategy().ignoreDupCost()
+       << " interIpu=" << opt.fInterIpuComm() << " preMerge=" << opt.fPreMergeIpuPartition()
+       << " imbalance=" << opt.kahyparImbalance() << " costModel=" << opt.bspCostModel();
+    return V3Hash{ss.str()}.toString();
+}
+
+PartitionCache::FiberHash PartitionCache::fiberHash(const DepGraph* graphp) {
+    std::vector<uint32_t> hashes;
+    for (const V3GraphVertex* vtxp = graphp->verticesBeginp(); vtxp;
+         vtxp = vtxp->verticesNextp()) {
+        hashes.push_back(static_cast<const AnyVertex*>(vtxp)->hash().value());
+    }
+    // vertex order is not stable between runs
+    std::sort(hashes.begin(), hashes.end());
+    // 32 bits are too few for hundreds of thousands of fibers, so combine the
+    // hashes in both directions to get 64 bits
+    V3Hash lo{static_cast<uint32_t>(hashes.size())};
+    V3Hash hi;
+    for (auto it = hashes.begin(); it != hashes.end(); ++it) lo += *it;
+    for (auto it = hashes.rbegin(); it != hashes.rend(); ++it) hi += *it;
+    return (static_cast<FiberHash>(hi.value()) << 32) | lo.value();
+}
+
+// Commits and sink logic are never replicated, so the partition holding one of them
+// also holds the fiber that was collected from it, see backwardTraverseAndCollect
+const AstNode* PartitionCache::rootKey(AnyVertex* vtxp) {
+    if (CompVertex* const compp = vtxp->cast<CompVertex>()) return compp->nodep();
+    if (ConstrCommitVertex* const commitp = vtxp->cast<ConstrCommitVertex>()) {
+        return commitp->vscp();
+    }
+    return nullptr;
+}
+
+void PartitionCache::load() {
+    const std::unique_ptr<std::ifstream> ifp{V3File::new_ifstream_nodepend(filename())};
+    if (ifp->fail()) return;
+    string line = V3Os::getline(*ifp);
+    if (line != "config " + configKey()) {
+        UINFO(3, "Stale BSP partition cache " << filename() << endl);
+        return;
+    }
+    while (!ifp->eof()) {
+        line = V3Os::getline(*ifp);
+        if (line.empty()) continue;
+        std::istringstream is{line};
+        m_cached.emplace_back();
+        Entry& entry = m_cached.back();
+        is >> std::dec >> entry.tileId >> entry.workerId >> entry.cost;
+        FiberHash h;
+        while (is >> std::hex >> h) entry.fibers.push_back(h);
+    }
+    UINFO(3, "Read " << m_cached.size() << " partitions from " << filename() << endl);
+}
+
+PartitionCache::PartitionCache(const std::vector<std::unique_ptr<DepGraph>>& fibersp)
+    : m_enabled{v3Global.opt.fIpuPartitionCache()} {
+    if (!m_enabled) return;
+    std::vector<FiberHash> hashes;
+    std::unordered_set<const AstNode*> shared;
+    for (const auto& fiberp : fibersp) {
+        hashes.push_back(fiberHash(fiberp.get()));
+        for (const AstNode* const rootp : fiberp->rootps()) {
+            const auto pair = m_rootFiber.emplace(rootp, hashes.back());
+            if (!pair.second && pair.first->second != hashes.back()) shared.insert(rootp);
+        }
+    }
+    // A root that also shows up in another fiber does not identify a single fiber
+    for (size_t ix = 0; ix < fibersp.size(); ++ix) {
+        for (V3GraphVertex* vtxp = fibersp[ix]->verticesBeginp(); vtxp;
+             vtxp = vtxp->verticesNextp()) {
+            const AstNode* const keyp = rootKey(static_cast<AnyVertex*>(vtxp));
+            const auto it = keyp ? m_rootFiber.find(keyp) : m_rootFiber.end();
+            if (it != m_rootFiber.end() && it->second != hashes[ix]) shared.insert(keyp);
+        }
+    }
+    for (const AstNode* const keyp : shared) m_rootFiber.erase(keyp);
+    V3Stats::addStat("BspSched, partition cache shared roots", shared.size());
+    load();
+}
+
+bool PartitionCache::reuse(std::vector<std::unique_ptr<DepGraph>>& fibersp) {
+    if (!m_enabled || m_cached.empty() || fibersp.empty()) return false;
+    // identical fibers may exist, keep every index of a hash
+    std::unordered_map<FiberHash, std::vector<size_t>> fiberIndex;
+    for (size_t ix = 0; ix < fibersp.size(); ++ix) {
+        fiberIndex[fiberHash(fibersp[ix].get())].push_back(ix);
+    }
+    std::vector<std::vector<size_t>> indices;
+    std::vector<bool> taken(fibersp.size(), false);
+    bool complete = true;  // every old partition is intact and there is nothing new
+    for (const Entry& entry : m_cached) {
+        std::vector<size_t> group;
+        for (const FiberHash h : entry.fibers) {
+            const auto it = fiberIndex.find(h);
+            if (it == fiberIndex.end() || it->second.empty()) {
+                complete = false;  // the fiber was edited or removed
+                continue;
+            }
+            group.push_back(it->second.back());
+            taken[it->second.back()] = true;
+            it->second.pop_back();
+        }
+        if (!group.empty()) indices.emplace_back(std::move(group));
+    }
+    size_t numHits = 0;
+    for (size_t ix = 0; ix < fibersp.size(); ++ix) {
+        if (taken[ix]) {
+            ++numHits;
+        } else {
+            indices.emplace_back(std::vector<size_t>{ix});
+            complete = false;
+        }
+    }
+    V3Stats::addStat("BspSched, partition cache fiber hits", numHits);
+    V3Stats::addStat("BspSched, partition cache fiber misses", fibersp.size() - numHits);
+    if (numHits == 0) return false;
+    UINFO(3, "Reusing " << numHits << " of " << fibersp.size() << " fibers from "
+                        << filename() << endl);
+    V3BspMerger::merge(fibersp, indices);
+    return complete;
+}
+
+void PartitionCache::record(const std::vector<std::unique_ptr<DepGraph>>& partitionsp) {
+    m_final.clear();
+    if (!m_enabled) return;
+    for (const auto& partp : partitionsp) {
+        m_final.emplace_back(partp.get(), Entry{});
+        Entry& entry = m_final.back().second;
+        std::unordered_set<FiberHash> seen;
+        for (V3GraphVertex* vtxp = partp->verticesBeginp(); vtxp; vtxp = vtxp->verticesNextp()) {
+            if (CompVertex* const compp = vtxCast<CompVertex>(vtxp)) {
+                entry.cost += V3InstrCount::count(compp->nodep(), false);
+            }
+            const AstNode* const keyp = rootKey(static_cast<AnyVertex*>(vtxp));
+            if (!keyp) continue;
+            const auto it = m_rootFiber.find(keyp);
+            if (it == m_rootFiber.end()) continue;  // not the root of a fiber
+            if (seen.insert(it->second).second) entry.fibers.push_back(it->second);
+        }
+    }
+}
+
+void PartitionCache::restorePlacement(const V3BspModules::PartitionClasses& partitionClasses) {
+    if (!m_enabled || m_cached.empty()) return;
+    // A partition is unchanged if it holds exactly the fibers of an old one
+    std::map<std::vector<FiberHash>, const Entry*> oldPartitions;
+    for (const Entry& entry : m_cached) {
+        std::vector<FiberHash> key = entry.fibers;
+        std::sort(key.begin(), key.end());
+        oldPartitions.emplace(std::move(key), &entry);
+    }
+    using Slot = std::pair<uint32_t, uint32_t>;  // tile, worker
+    const auto slotOf = [](const AstClass* classp) {
+        return Slot{classp->flag().tileId(), classp->flag().workerId()};
+    };
+    const auto moveTo = [](AstClass* classp, const Slot& slot) {
+        VClassFlag flag = classp->flag();
+        classp->flag(flag.withTileId(slot.first).withWorkerId(slot.second));
+    };
+    std::map<Slot, AstClass*> slots;
+    uint32_t maxWorkerId = 0;
+    for (const auto& pair : m_final) {
+        AstClass* const classp = partitionClasses.at(pair.first);
+        slots.emplace(slotOf(classp), classp);
+        maxWorkerId = std::max(maxWorkerId, classp->flag().workerId());
+    }
+    std::unordered_set<const AstClass*> kept;
+    for (const auto& pair : m_final) {
+        std::vector<FiberHash> key = pair.second.fibers;
+        if (key.empty()) continue;
+        std::sort(key.begin(), key.end());
+        const auto it = oldPartitions.find(key);
+        if (it == oldPartitions.end()) continue;
+        AstClass* const classp = partitionClasses.at(pair.first);
+        const Slot have = slotOf(classp);
+        const Slot want{it->second->tileId, it->second->workerId};
+        if (have != want) {
+            const auto wantIt = slots.find(want);
+            if (wantIt == slots.end()) {
+                // Do not add a worker, that would undo the supervisor promotion
+                if (want.second > maxWorkerId) continue;
+                slots.erase(have);
+            } else {
+                AstClass* const otherp = wantIt->second;
+                if (kept.count(otherp)) continue;  // an unchanged partition holds it
+                moveTo(otherp, have);
+                slots[have] = otherp;
+            }
+            moveTo(classp, want);
+            slots[want] = classp;
+        }
+        kept.insert(classp);
+    }
+    UINFO(3, "Kept the placement of " << kept.size() << " partitions" << endl);
+    V3Stats::addStat("BspSched, partition cache placements kept", kept.size());
+}
+
+void PartitionCache::save(const V3BspModules::PartitionClasses& partitionClasses) {
+    if (!m_enabled) return;
+    const std::unique_ptr<std::ofstream> ofp{V3File::new_ofstream_nodepend(filename())};
+    if (ofp->fail()) {
+        v3warn(E_UNSUPPORTED, "Cannot write BSP partition cache " << filename());
+        return;
+    }
+    *ofp << "config " << configKey() << "\n";
+    for (const auto& pair : m_final) {
+        const auto it = partitionClasses.find(pair.first);
+        UASSERT(it != partitionClasses.end(), "every partition should have a class");
+        const Entry& entry = pair.second;
+        const VClassFlag flag = it->second->flag();
+        *ofp << std::dec << flag.tileId() << " " << flag.workerId() << " " << entry.cost;
+        for (const FiberHash h : entry.fibers) *ofp << " " << std::hex << h;
+        *ofp << "\n";
+    }
+}
+
+}  // namespace V3BspSched
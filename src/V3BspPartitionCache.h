@@ -0,0 +1,98 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Reuse BSP partitions of a previous run
+//
+// Code available from: https://verilator.org
+//
+//*************************************************************************
+//
+// Copyright 2003-2023 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+//
+// Partitioning (device partitioning and merging) is the most expensive part
+// of BSP scheduling. We keep the result of the last run in the Mdir, as a
+// list of final partitions where each partition records its tile, worker,
+// estimated cost and fiber hashes. A fiber hash combines the hashes of its
+// vertices (see DepGraph::rehash) so it only depends on the logic of the
+// fiber, not on pointers.
+//
+// On the next run, fibers whose hash is found in the cache are merged back
+// into their old partitions before partitioning, so only the new or edited
+// fibers have to be placed. If every fiber is found and nothing new exists,
+// partitioning is skipped altogether. After placement, the classes of unchanged
+// partitions are moved back to their old tile and worker. The cache is opt-in
+// with -fipu-partition-cache, which --bsp-profile-use relies on.
+//
+//*************************************************************************
+
+#ifndef VERILATOR_V3BSPPARTITIONCACHE_H_
+#define VERILATOR_V3BSPPARTITIONCACHE_H_
+
+#include "config_build.h"
+#include "verilatedos.h"
+
+#include "V3BspGraph.h"
+#include "V3BspModules.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace V3BspSched {
+
+class PartitionCache final {
+public:
+    // TYPES
+    using FiberHash = uint64_t;
+    struct Entry final {
+        uint32_t tileId = 0;
+        uint32_t workerId = 0;
+        uint32_t cost = 0;  // estimated cost, not scaled by any profile
+        std::vector<FiberHash> fibers;
+    };
+
+private:
+    // MEMBERS
+    const bool m_enabled;  // -fipu-partition-cache
+    std::unordered_map<const AstNode*, FiberHash> m_rootFiber;  // root logic -> fiber
+    std::vector<Entry> m_cached;  // partitions read from the cache file
+    std::vector<std::pair<const DepGraph*, Entry>> m_final;  // partitions of this run
+
+    // METHODS
+    static string filename();
+    static string configKey();
+    static const AstNode* rootKey(AnyVertex* vtxp);
+    void load();
+
+public:
+    // CONSTRUCTORS
+    // Hash the fibers and read the cache file of the previous run
+    explicit PartitionCache(const std::vector<std::unique_ptr<DepGraph>>& fibersp);
+
+    // METHODS
+    static FiberHash fiberHash(const DepGraph* graphp);
+    // Partitions of the previous run, empty if there is no valid cache
+    const std::vector<Entry>& cached() const { return m_cached; }
+
+    // Merge the fibers that belonged to the same partition in the previous run.
+    // Returns true if every partition was reconstructed from the cache, in which case
+    // fibersp already holds the final partitions.
+    bool reuse(std::vector<std::unique_ptr<DepGraph>>& fibersp);
+    // Record the final partitions, before their logic is moved into classes
+    void record(const std::vector<std::unique_ptr<DepGraph>>& partitionsp);
+    // Move the classes of partitions that hold the same fibers as in the previous run back
+    // to their old tile and worker, after V3BspIpuPlace::placeAll
+    void restorePlacement(const V3BspModules::PartitionClasses& partitionClasses);
+    // Write the recorded partitions for the next run, with the placement of the class
+    // made for each of them (see V3BspModules::makeModules and V3BspIpuPlace::placeAll)
+    void save(const V3BspModules::PartitionClasses& partitionClasses);
+};
+
+}  // namespace V3BspSched
+
+#endif
@@ -24,11 +24,13 @@
 #include "V3BspDpi.h"
 #include "V3BspModules.h"
 #include "V3BspPlusArgs.h"
+#include "V3BspTrace.h"
 #include "V3EmitCBase.h"
 #include "V3Global.h"
 #include "V3Stats.h"
 #include "V3UniqueNames.h"
 
+#include <map>
 #include <unordered_map>
 
 VL_DEFINE_DEBUG_FUNCTIONS;
@@ -311,6 +313,16 @@ private:
                                                    nullptr)});
                 }
             }
+            if (varp->bspFlag().hasTraceBuf()) {
+                ctorp->addStmtsp(new AstStmtExpr{
+                    fl, mkCall(fl, "addTraceBuffer",
+                               {mkConst(m_handles(varp).id), mkConst(vectorSize)})});
+            }
+            if (varp->bspFlag().hasTraceReq() && classp->flag().isBspCond()) {
+                ctorp->addStmtsp(new AstStmtExpr{
+                    fl, mkCall(fl, "isTraceRequest",
+                               {new AstVarRef{fl, tensorVscp, VAccess::READWRITE}})});
+            }
             if (varp->bspFlag().hasHostWrite()) {
                 const std::string hwHandle = "hw." + tensorDeviceHandle;
                 m_handles(varp).hostWrite = hwHandle;
@@ -320,6 +332,16 @@ private:
                                                 new AstVarRef{fl, tensorVscp, VAccess::READWRITE},
                                                 mkConst(vectorSize)},
                                                nullptr)});
+                // a write has to update the batched copy of the host read of the same
+                // tensor, host requests share the "interrupt" handle and are never paired
+                if (varp->bspFlag().hasHostRead() && !varp->bspFlag().hasAnyHostReq()) {
+                    ctorp->addStmtsp(new AstStmtExpr{
+                        fl, mkCall(fl, "pairHostReadWrite",
+                                   {new AstConst{fl, AstConst::String{},
+                                                 m_handles(varp).hostRead},
+                                    new AstConst{fl, AstConst::String{}, hwHandle}},
+                                   nullptr)});
+                }
             }
         }
 
@@ -334,32 +356,90 @@ private:
     AstConst* mkConst(uint32_t n) const {
         return new AstConst{m_netlistp->fileline(), AstConst::WidthedValue{}, 32, n};
     }
+    void addNextCurrentPair(AstAssign* assignp, std::vector<AstNode*>& stmtsp) {
+        AstVar* const top = VN_AS(assignp->lhsp(), MemberSel)->varp();
+        AstVar* const fromp = VN_AS(assignp->rhsp(), MemberSel)->varp();
+        const string nextHandle = m_handles(fromp).tensor;
+        UASSERT(!nextHandle.empty(), "handle not set!");
+        const string currentHandle = m_handles(top).tensor;
+        UASSERT(!currentHandle.empty(), "handle not set!");
+        const auto totalWords
+            = top->dtypep()->skipRefp()->widthWords() * top->dtypep()->arrayUnpackedElements();
+
+        stmtsp.push_back(new AstComment{assignp->fileline(),
+                                        "next: " + nextHandle + " current: " + currentHandle});
+        stmtsp.push_back(new AstStmtExpr{assignp->fileline(),
+                                         mkCall(assignp->fileline(), "addNextCurrentPair",
+                                                {mkConst(m_handles(fromp).id) /*source*/,
+                                                 mkConst(m_handles(top).id) /*target*/,
+                                                 mkConst(totalWords) /*number of words*/})});
+    }
+    // A source with many targets is broadcast: a single copy reaches every target on one IPU.
+    // Targets on another IPU receive it from a relay on one of their tiles, so the inter-IPU
+    // links carry it once per IPU rather than once per target.
+    void addBroadcast(AstVar* fromp, const std::vector<AstAssign*>& assignsp,
+                      std::vector<AstNode*>& stmtsp) {
+        FileLine* const fl = fromp->fileline();
+        const uint32_t totalWords
+            = fromp->dtypep()->skipRefp()->widthWords() * fromp->dtypep()->arrayUnpackedElements();
+        const uint32_t tilesPerIpu = v3Global.opt.tilesPerIpu();
+        const uint32_t sourceIpu
+            = getClass(assignsp.front()->rhsp())->flag().tileId() / tilesPerIpu;
+        std::map<uint32_t, std::vector<AstAssign*>> targetsByIpu;
+        for (AstAssign* const assignp : assignsp) {
+            const uint32_t ipu = getClass(assignp->lhsp())->flag().tileId() / tilesPerIpu;
+            targetsByIpu[ipu].push_back(assignp);
+        }
+        stmtsp.push_back(new AstComment{fl, "Broadcast " + m_handles(fromp).tensor + " to "
+                                                + cvtToStr(assignsp.size()) + " targets"});
+        for (const auto& pair : targetsByIpu) {
+            int sourceId = m_handles(fromp).id;
+            if (pair.first != sourceIpu && pair.second.size() > 1) {
+                const int relayId = m_nextTensorId++;
+                const uint32_t relayTile = getClass(pair.second.front()->lhsp())->flag().tileId();
+                stmtsp.push_back(new AstStmtExpr{
+                    fl, mkCall(fl, "addRelay",
+                               {mkConst(sourceId), mkConst(relayId), mkConst(totalWords),
+                                mkConst(relayTile)})});
+                sourceId = relayId;
+                V3Stats::addStatSum("Poplar, Broadcast relays", 1);
+                V3Stats::addStatSum("Poplar, Inter-IPU words saved by relays",
+                                    totalWords * (pair.second.size() - 1));
+            }
+            for (AstAssign* const assignp : pair.second) {
+                AstVar* const top = VN_AS(assignp->lhsp(), MemberSel)->varp();
+                stmtsp.push_back(new AstStmtExpr{
+                    fl, mkCall(fl, "addBroadcastTarget",
+                               {mkConst(sourceId), mkConst(m_handles(top).id),
+                                mkConst(totalWords)})});
+            }
+        }
+        V3Stats::addStatSum("Poplar, Broadcast sources", 1);
+        V3Stats::addStatSum("Poplar, Broadcast targets", assignsp.size());
+    }
     void addNextCurrentPairs(AstCFunc* exchangep) {
-
-        std::vector<AstNode*> stmtsp;
-        for (AstNode* nodep = exchangep->stmtsp(); nodep;) {
+        // the targets of every source, sources in order of appearance
+        std::vector<AstVar*> sourcesp;
+        std::unordered_map<AstVar*, std::vector<AstAssign*>> targetsp;
+        for (AstNode* nodep = exchangep->stmtsp(); nodep; nodep = nodep->nextp()) {
             UASSERT(VN_IS(nodep, Assign), "expected AstAssign");
             AstAssign* const assignp = VN_AS(nodep, Assign);
-            AstVar* const top = VN_AS(assignp->lhsp(), MemberSel)->varp();
             AstVar* const fromp = VN_AS(assignp->rhsp(), MemberSel)->varp();
-            const string nextHandle = m_handles(fromp).tensor;
-            UASSERT(!nextHandle.empty(), "handle not set!");
-            const string currentHandle = m_handles(top).tensor;
-            UASSERT(!currentHandle.empty(), "handle not set!");
-            const auto totalWords
-                = top->dtypep()->skipRefp()->widthWords() * top->dtypep()->arrayUnpackedElements();
-
-            stmtsp.push_back(new AstComment{nodep->fileline(),
-                                            "next: " + nextHandle + " current: " + currentHandle});
-            AstNode* newp = new AstStmtExpr{nodep->fileline(),
-                                            mkCall(assignp->fileline(), "addNextCurrentPair",
-                                                   {mkConst(m_handles(fromp).id) /*source*/,
-                                                    mkConst(m_handles(top).id) /*target*/,
-                                                    mkConst(totalWords) /*number of words*/})};
-            AstNode* const nextp = nodep->nextp();
-            stmtsp.push_back(newp);
-            // newp->addHereThisAsNext(newCommentp);
-            nodep = nextp;
+            std::vector<AstAssign*>& assignsp = targetsp[fromp];
+            if (assignsp.empty()) sourcesp.push_back(fromp);
+            assignsp.push_back(assignp);
+        }
+        const size_t minFanout = v3Global.opt.bspBroadcastFanout();
+        std::vector<AstNode*> stmtsp;
+        for (AstVar* const fromp : sourcesp) {
+            const std::vector<AstAssign*>& assignsp = targetsp[fromp];
+            if (minFanout && assignsp.size() >= minFanout) {
+                addBroadcast(fromp, assignsp, stmtsp);
+                continue;
+            }
+            for (AstAssign* const assignp : assignsp) {
+                addNextCurrentPair(assignp, stmtsp);
+            }
         }
         AstCFunc* splitFuncp = nullptr;
         const uint32_t maxFuncStmts = static_cast<uint32_t>(v3Global.opt.outputSplit());
@@ -705,9 +785,14 @@ void V3BspPoplarProgram::createProgram(AstNetlist* nodep) {
 
     V3BspPlusArgs::makeCache(nodep);
 
+    // record the traced signals before the DPI calls split nbaTop
+    if (v3Global.opt.trace()) V3BspTrace::traceAll(nodep);
+
     // delegate all dpi calls to the host
     V3BspDpi::delegateAll(nodep);
 
+    if (v3Global.opt.trace()) V3BspTrace::requestAll(nodep);
+
     { PoplarLegalizeFieldNamesVisitor{nodep}; }
     V3Global::dumpCheckGlobalTree("bspLegal", 0, dumpTree() >= 1);
     { PoplarViewsVisitor{nodep}; }  // destroy before checking
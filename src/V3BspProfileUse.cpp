@@ -0,0 +1,145 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Feed measured tile cycles back into BSP partitioning
+//
+// Code available from: https://verilator.org
+//
+//*************************************************************************
+//
+// Copyright 2003-2023 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+
+#include "V3BspProfileUse.h"
+
+#include "V3File.h"
+#include "V3Global.h"
+#include "V3Os.h"
+#include "V3Stats.h"
+
+#include <sstream>
+#include <unordered_map>
+
+VL_DEFINE_DEBUG_FUNCTIONS;
+
+namespace V3BspSched {
+
+namespace {
+
+// Do not let a single noisy measurement dominate the partitioning
+constexpr float MIN_SCALE = 0.125f;
+constexpr float MAX_SCALE = 8.0f;
+
+std::unordered_map<uint32_t, double> readTileCycles(const string& filename) {
+    std::unordered_map<uint32_t, double> cycles;
+    const std::unique_ptr<std::ifstream> ifp{V3File::new_ifstream(filename)};
+    if (ifp->fail()) {
+        v3fatal("Cannot open --bsp-profile-use file: " << filename);
+        return cycles;
+    }
+    int lineno = 0;
+    while (!ifp->eof()) {
+        const string line = V3Os::getline(*ifp);
+        ++lineno;
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream is{line};
+        uint32_t tileId = 0;
+        double c = 0;
+        if (!(is >> tileId >> c)) {
+            v3fatal("Malformed --bsp-profile-use entry at " << filename << ":" << lineno << ": "
+                                                            << line);
+            return cycles;
+        }
+        cycles[tileId] = c;
+    }
+    return cycles;
+}
+
+}  // namespace
+
+void V3BspProfileUse::apply(const PartitionCache& cache,
+                            std::vector<std::unique_ptr<DepGraph>>& fibersp) {
+    const string filename = v3Global.opt.bspProfileUse();
+    const std::unordered_map<uint32_t, double> measured = readTileCycles(filename);
+    if (!v3Global.opt.fIpuPartitionCache()) {
+        v3error("--bsp-profile-use needs the partition cache, add -fipu-partition-cache");
+        return;
+    }
+    if (cache.cached().empty()) {
+        v3error("--bsp-profile-use needs the partitions of the profiled build, rebuild in the "
+                "same Mdir with the same options as the profiled build");
+        return;
+    }
+
+    // The workers of a tile run in parallel, so the tile takes as long as its most
+    // expensive partition
+    std::unordered_map<uint32_t, uint32_t> estimated;
+    for (const PartitionCache::Entry& entry : cache.cached()) {
+        uint32_t& est = estimated[entry.tileId];
+        est = std::max(est, entry.cost);
+    }
+    double measuredSum = 0;
+    double estimatedSum = 0;
+    for (const auto& pair : estimated) {
+        const auto it = measured.find(pair.first);
+        if (it == measured.end() || pair.second == 0) continue;
+        measuredSum += it->second;
+        estimatedSum += pair.second;
+    }
+    if (measuredSum <= 0 || estimatedSum <= 0) {
+        v3warn(E_UNSUPPORTED, "No usable measurements in " << filename);
+        return;
+    }
+    // the units of the cost model and the measurements differ, only the relative
+    // error of each tile matters
+    const double globalRatio = measuredSum / estimatedSum;
+
+    std::unordered_map<PartitionCache::FiberHash, float> fiberScale;
+    float maxScale = 0;
+    for (const PartitionCache::Entry& entry : cache.cached()) {
+        const auto it = measured.find(entry.tileId);
+        const uint32_t est = estimated[entry.tileId];
+        if (it == measured.end() || est == 0) continue;
+        const float scale = std::min(
+            MAX_SCALE,
+            std::max(MIN_SCALE, static_cast<float>(it->second / est / globalRatio)));
+        maxScale = std::max(maxScale, scale);
+        for (const PartitionCache::FiberHash h : entry.fibers) fiberScale.emplace(h, scale);
+    }
+
+    // Logic duplicated in several fibers takes the largest scale of them
+    std::unordered_map<const AstNode*, float> nodeScale;
+    size_t numProfiled = 0;
+    for (const auto& fiberp : fibersp) {
+        const auto it = fiberScale.find(PartitionCache::fiberHash(fiberp.get()));
+        if (it == fiberScale.end()) continue;
+        ++numProfiled;
+        for (V3GraphVertex* vtxp = fiberp->verticesBeginp(); vtxp; vtxp = vtxp->verticesNextp()) {
+            if (CompVertex* const compp = vtxCast<CompVertex>(vtxp)) {
+                float& scale = nodeScale[compp->nodep()];
+                scale = std::max(scale, it->second);
+            }
+        }
+    }
+    for (const auto& fiberp : fibersp) {
+        for (V3GraphVertex* vtxp = fiberp->verticesBeginp(); vtxp; vtxp = vtxp->verticesNextp()) {
+            if (CompVertex* const compp = vtxCast<CompVertex>(vtxp)) {
+                const auto it = nodeScale.find(compp->nodep());
+                if (it != nodeScale.end()) compp->costScale(it->second);
+            }
+        }
+    }
+    UINFO(3, "Profile " << filename << " covers " << numProfiled << " of " << fibersp.size()
+                        << " fibers" << endl);
+    V3Stats::addStat("BspSched, profiled fibers", numProfiled);
+    V3Stats::addStat("BspSched, max profiled cost scale", maxScale);
+}
+
+}  // namespace V3BspSched
@@ -0,0 +1,49 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Feed measured tile cycles back into BSP partitioning
+//
+// Code available from: https://verilator.org
+//
+//*************************************************************************
+//
+// Copyright 2003-2023 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+//
+// An instrumented run (VL_INSTRUMENT) writes the mean compute cycles of each
+// tile to <prefix>_tileProfile.txt, one "<tile> <cycles>" line per tile.
+// With --bsp-profile-use <file>, the ratio of measured to estimated cycles
+// of each tile, relative to the ratio of the whole design, scales the cost
+// of the fibers that were on that tile. The partition cache of the profiled
+// build (see V3BspPartitionCache.h) maps tiles back to fibers.
+//
+//*************************************************************************
+
+#ifndef VERILATOR_V3BSPPROFILEUSE_H_
+#define VERILATOR_V3BSPPROFILEUSE_H_
+
+#include "config_build.h"
+#include "verilatedos.h"
+
+#include "V3BspGraph.h"
+#include "V3BspPartitionCache.h"
+
+#include <memory>
+#include <vector>
+
+namespace V3BspSched {
+
+class V3BspProfileUse final {
+public:
+    // Set the cost scale of the CompVertices in fibersp from the profile
+    static void apply(const PartitionCache& cache,
+                      std::vector<std::unique_ptr<DepGraph>>& fibersp);
+};
+
+}  // namespace V3BspSched
+
+#endif
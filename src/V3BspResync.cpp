@@ -1237,6 +1237,9 @@ void resyncAll(AstNetlist* netlistp) {
         }
 
         { ResyncVisitor{netlistp, resyncGraphsp, logicClasses}; }
+        for (const auto& pair : regions.m_pre) {
+            netlistp->topScopep()->scopep()->addBlocksp(pair.second);
+        }
         for (const auto& pair : regions.m_act) {
             netlistp->topScopep()->scopep()->addBlocksp(pair.second);
         }
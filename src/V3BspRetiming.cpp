@@ -742,6 +742,10 @@ public:
             regions.m_act.front().second->v3fatalExit("active regions prevents retiming");
             return;
         }
+        if (!regions.m_pre.empty()) {
+            regions.m_pre.front().second->v3fatalExit("pre-active regions prevents retiming");
+            return;
+        }
         UASSERT(regions.m_act.empty(), "retiming can not be done when there is an active region");
 
         // use the data dependence graph to build a netlist grpah, a netlist graph is
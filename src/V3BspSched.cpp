@@ -15,7 +15,9 @@
 //*************************************************************************
 // V3BspSched::schedule is the top level entry-point for a parallel scheduling
 // of simulation. This scheduling mode is currently quite limited:
-//  - Only modules with a single clock at the top (without combinational inputs) are supported
+//  - Only modules with a single clock at the top (without combinational inputs) are supported,
+//    although clocks derived from it (e.g., divided clocks) are fine. Every derived clock is a
+//    separate domain that is only executed in the time steps where its edge fires.
 //  - Combinational loops are not supported, the scheduler simply fails if they exist.
 //  - The code does not attempt to optimize/elide __dly variables.
 //  - The top clock is automatically toggled, hence there is no need for a testbench
@@ -74,11 +76,15 @@
 
 // reuse some code from V3Sched
 #include "V3Ast.h"
+#include "V3BspDpi.h"
 #include "V3BspGraph.h"
 #include "V3BspHyperMerger.h"
 #include "V3BspIpuDevicePartitioning.h"
+#include "V3BspLookahead.h"
 #include "V3BspMerger.h"
 #include "V3BspModules.h"
+#include "V3BspPartitionCache.h"
+#include "V3BspProfileUse.h"
 #include "V3BspResync.h"
 #include "V3BspRetiming.h"
 #include "V3EmitCBase.h"
@@ -173,9 +179,6 @@ buildDepGraphs(AstNetlist* netlistp) {
     V3Sched::LogicRegions logicRegions
         = V3Sched::partition(logicClasses.m_clocked, logicClasses.m_comb, logicClasses.m_hybrid);
 
-    unsupportedWhy(logicRegions.m_pre,
-                   "Pre-active not supprted because as can only handle a single clock");
-
     // if (v3Global.opt.fIpuResync()) {
     //     unsupportedWhy(logicRegions.m_act, "active region computation is not fully supported");
     // }
@@ -218,20 +221,38 @@ void schedule(AstNetlist* netlistp) {
     auto& splitGraphsp = std::get<2>(deps);
     auto& logicClasses = std::get<0>(deps);
     auto& logicRegions = std::get<1>(deps);
+    V3Stats::addStatPerf("BspGraph, peak DepGraph arena (MB), bspGraph",
+                         DepGraphArena::takePeakBytes() / 1024.0 / 1024.0);
     V3Stats::statsStage("bspGraph");
 
     auto performPartitionMerge = [](std::vector<std::unique_ptr<DepGraph>>& graphsp,
                                     uint32_t numTiles, uint32_t numWorkers) {
-        if (v3Global.opt.ipuMergeStrategy().hypergraph()) {
+        if (v3Global.opt.ipuMergeStrategy().hypergraph()
+            || v3Global.opt.ipuMergeStrategy().parallelHypergraph()) {
 
             V3BspHyperMerger::mergeAll(graphsp, numTiles, numWorkers);
         } else {
             V3BspMerger::mergeAll(graphsp, numTiles, numWorkers);
         }
+        V3Stats::addStatPerf("BspGraph, peak DepGraph arena (MB), bspMerge",
+                             DepGraphArena::takePeakBytes() / 1024.0 / 1024.0);
         V3Stats::statsStage("bspMerge");
     };
     auto deviceModel = IpuDevModel::instance();
-    if (v3Global.opt.fInterIpuComm() && v3Global.opt.fPreMergeIpuPartition()) {
+    // Fibers that are unchanged since the last run go back to their old partitions,
+    // unless a profile of the last run asks for repartitioning
+    PartitionCache partitionCache{splitGraphsp};
+    bool cacheComplete = false;
+    if (!v3Global.opt.bspProfileUse().empty()) {
+        V3BspProfileUse::apply(partitionCache, splitGraphsp);
+        V3Stats::statsStage("bspProfileUse");
+    } else {
+        cacheComplete = partitionCache.reuse(splitGraphsp);
+    }
+    V3Stats::statsStage("bspPartitionCache");
+    if (cacheComplete) {
+        // nothing changed, the partitions are already final
+    } else if (v3Global.opt.fInterIpuComm() && v3Global.opt.fPreMergeIpuPartition()) {
         // prepartition fibers into IPU devices
         auto devPartitions
             = V3BspIpuDevicePartitioning::partitionFibers(splitGraphsp, deviceModel);
@@ -264,13 +285,35 @@ void schedule(AstNetlist* netlistp) {
             V3Stats::statsStage("bspDevicePartitionPostMerge");
         }
     }
+    partitionCache.record(splitGraphsp);
+    // Settle the effective --bsp-cycle-batch, the lookahead windows have to tile it
+    {
+        bool strict = false;
+        for (const V3Sched::LogicByScope* const regionp :
+             {&logicRegions.m_pre, &logicRegions.m_act, &logicRegions.m_nba}) {
+            for (const auto& pair : *regionp) strict = strict || V3BspDpi::isStrict(pair.second);
+        }
+        V3BspDpi::settleHostCondition(strict);
+    }
+    if (v3Global.opt.bspLookahead() > 1) {
+        // after recording, the replicas should not be cached as part of a partition
+        V3BspLookahead::replicateAll(splitGraphsp);
+        V3Stats::statsStage("bspLookahead");
+    }
     // Create a module for each DepGraph. To do this we also need to determine
     // whether a varialbe is solely referenced locally or by multiple cores.
-    V3BspModules::makeModules(netlistp, splitGraphsp, logicClasses.m_initial,
-                              logicClasses.m_static, logicRegions.m_act);
+    // Pre-active and active logic is executed by the triggerEval function of every
+    // partition, the pre-active logic goes first.
+    V3Sched::LogicByScope actLogic;
+    for (const auto& pair : logicRegions.m_pre) actLogic.push_back(pair);
+    for (const auto& pair : logicRegions.m_act) actLogic.push_back(pair);
+    const V3BspModules::PartitionClasses partitionClasses = V3BspModules::makeModules(
+        netlistp, splitGraphsp, logicClasses.m_initial, logicClasses.m_static, actLogic);
 
     // Set the tile ids
     V3BspIpuPlace::placeAll(netlistp, deviceModel);
+    partitionCache.restorePlacement(partitionClasses);
+    partitionCache.save(partitionClasses);
 }
 
 };  // namespace V3BspSched
\ No newline at end of file
@@ -0,0 +1,402 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator BSP: Waveform tracing through on-tile change buffers
+//
+// Code available from: https://verilator.org
+//
+//*************************************************************************
+//
+// Copyright 2005-2023 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+
+#include "V3BspTrace.h"
+
+#include "V3Ast.h"
+#include "V3EmitCBase.h"
+#include "V3File.h"
+#include "V3Global.h"
+#include "V3Stats.h"
+#include "V3String.h"
+#include "V3UniqueNames.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+
+VL_DEFINE_DEBUG_FUNCTIONS;
+
+namespace {
+
+// Smallest trace buffer in words, larger ones are needed for classes that may
+// append more than this in the cycles between two checks of traceFull
+constexpr uint32_t TRACE_BUFFER_WORDS = 1024;
+
+class BspTraceVisitor final : public VNVisitor {
+private:
+    // NODE STATE
+    // AstVar::user1()      -> true if written by nbaTop
+    const VNUser1InUse m_user1InUse;
+
+    struct TracedSignal final {
+        uint32_t code;
+        int width;
+        string name;
+    };
+
+    // STATE
+    AstNetlist* const m_netlistp;
+    V3UniqueNames m_newNames{"__Vbsptrace"};
+    std::map<string, TracedSignal> m_signals;  // pretty name -> signal, first class wins
+
+    VDouble0 m_statsClasses;
+    VDouble0 m_statsSignals;
+    VDouble0 m_statsWords;
+
+    // METHODS
+    static AstVarRef* mkRef(AstVarScope* vscp, VAccess access) {
+        return new AstVarRef{vscp->fileline(), vscp, access};
+    }
+    static AstConst* mkConst(FileLine* flp, uint32_t value) {
+        return new AstConst{flp, AstConst::WidthedValue{}, 32, value};
+    }
+    static AstNodeExpr* mkAdd(AstVarScope* vscp, uint32_t offset) {
+        AstNodeExpr* const refp = mkRef(vscp, VAccess::READ);
+        if (!offset) return refp;
+        return new AstAdd{vscp->fileline(), refp, mkConst(vscp->fileline(), offset)};
+    }
+    static AstArraySel* mkWord(AstVarScope* bufVscp, AstNodeExpr* indexp, VAccess access) {
+        return new AstArraySel{bufVscp->fileline(), mkRef(bufVscp, access), indexp};
+    }
+    static AstVarScope* newVar(AstClass* classp, AstScope* scopep, AstCFunc* funcp,
+                               const string& name, AstNodeDType* dtypep, VBspFlag flag) {
+        FileLine* const flp = classp->fileline();
+        AstVar* const varp = new AstVar{flp, VVarType::MEMBER, name, dtypep};
+        if (funcp) {
+            varp->funcLocal(true);
+            varp->lifetime(VLifetime::AUTOMATIC);
+            funcp->stmtsp()->addHereThisAsNext(varp);
+        } else {
+            varp->lifetime(VLifetime::STATIC);
+            varp->bspFlag(flag);
+            classp->addStmtsp(varp);
+        }
+        AstVarScope* const vscp = new AstVarScope{flp, scopep, varp};
+        scopep->addVarsp(vscp);
+        return vscp;
+    }
+
+    // Name of the original signal, see V3BspModules
+    static string signalName(const AstVar* varp) {
+        string name = varp->origName();
+        const size_t pos = name.rfind("->");
+        if (pos != string::npos) name.replace(pos, 2, ".");
+        return AstNode::prettyName(name);
+    }
+    static const char* ignoreReason(const AstVarScope* vscp) {
+        const AstVar* const varp = vscp->varp();
+        const string& origName = varp->origName();
+        const string leaf = origName.substr(origName.rfind('>') + 1);
+        if (!vscp->isTrace()) return "trace_off";
+        if (!varp->dtypep()->skipRefp()->isIntegralOrPacked()) return "not packed";
+        if (varp->width() > v3Global.opt.traceMaxWidth()) return "too wide";
+        if (VString::startsWith(leaf, "__V")) return "internal";
+        if (!v3Global.opt.traceUnderscore() && VString::startsWith(leaf, "_")) {
+            return "leading underscore";
+        }
+        return nullptr;
+    }
+
+    // Append the changes of the traced members at the end of nbaTop
+    void instrument(AstClass* classp) {
+        AstScope* scopep = nullptr;
+        for (AstNode* nodep = classp->stmtsp(); nodep; nodep = nodep->nextp()) {
+            if (AstScope* const sp = VN_CAST(nodep, Scope)) scopep = sp;
+        }
+        UASSERT_OBJ(scopep, classp, "class without scope");
+        AstCFunc* nbaTopp = nullptr;
+        for (AstNode* nodep = scopep->blocksp(); nodep; nodep = nodep->nextp()) {
+            AstCFunc* const funcp = VN_CAST(nodep, CFunc);
+            if (funcp && funcp->name() == "nbaTop") nbaTopp = funcp;
+        }
+        if (!nbaTopp || !nbaTopp->stmtsp()) return;
+
+        AstNode::user1ClearTree();
+        nbaTopp->foreach([](AstNodeVarRef* refp) {
+            if (refp->access().isWriteOrRW()) refp->varp()->user1(true);
+        });
+        // Members computed by this class, replicas of remote state are inputs
+        // (see V3BspLookahead) and traced by their owner
+        std::vector<std::pair<AstVarScope*, TracedSignal>> tracedp;
+        for (AstVarScope* vscp = scopep->varsp(); vscp; vscp = VN_AS(vscp->nextp(), VarScope)) {
+            AstVar* const varp = vscp->varp();
+            // only members standing for a variable of the design, see V3BspModules
+            if (varp->isFuncLocal() || !varp->user1()
+                || varp->origName().find("->") == string::npos) {
+                continue;
+            }
+            if (varp->bspFlag().hasInput() && !varp->bspFlag().hasOutput()) continue;
+            const string name = signalName(varp);
+            if (const char* const reasonp = ignoreReason(vscp)) {
+                UINFO(9, "Not tracing " << name << ": " << reasonp << endl);
+                continue;
+            }
+            if (m_signals.count(name)) continue;  // traced by another class
+            const TracedSignal sig{static_cast<uint32_t>(m_signals.size()), varp->width(), name};
+            m_signals.emplace(name, sig);
+            tracedp.emplace_back(vscp, sig);
+        }
+        if (tracedp.empty()) return;
+
+        // Words a single cycle may append
+        uint32_t cycleWords = 2;
+        for (const auto& pair : tracedp) cycleWords += 1 + VL_WORDS_I(pair.second.width);
+        // traceFull has to be raised while there is still room for the cycles run until
+        // the runtime sees it. V3BspDpi only decides later whether the condition is fused
+        // and cycles are batched, so assume the worst.
+        const uint32_t checkCycles = static_cast<uint32_t>(v3Global.opt.bspCycleBatch())
+                                     + (v3Global.opt.fIpuFusedCond() ? 1 : 0);
+        const uint32_t payloadWords
+            = std::max(TRACE_BUFFER_WORDS, (checkCycles + 1) * cycleWords);
+        const uint32_t threshold = payloadWords - checkCycles * cycleWords;
+
+        FileLine* const flp = nbaTopp->fileline();
+        AstNodeDType* const wordDTypep = m_netlistp->findLogicDType(32, 32, VSigning::UNSIGNED);
+        AstUnpackArrayDType* const bufDTypep = new AstUnpackArrayDType{
+            flp, wordDTypep, new AstRange{flp, 0, static_cast<int>(payloadWords)}};
+        m_netlistp->typeTablep()->addTypesp(bufDTypep);
+        AstVarScope* const bufVscp
+            = newVar(classp, scopep, nullptr, m_newNames.get("traceBuf"), bufDTypep,
+                     {VBspFlag::MEMBER_LOCAL, VBspFlag::MEMBER_TRACEBUF});
+        AstVarScope* const cycleVscp = newVar(classp, scopep, nullptr, m_newNames.get("cycle"),
+                                              wordDTypep, {VBspFlag::MEMBER_LOCAL});
+        AstVarScope* const fullVscp = newVar(classp, scopep, nullptr, m_newNames.get("traceFull"),
+                                             m_netlistp->findBitDType(),
+                                             {VBspFlag::MEMBER_OUTPUT, VBspFlag::MEMBER_TRACEREQ});
+        AstVarScope* const posVscp
+            = newVar(classp, scopep, nbaTopp, m_newNames.get("pos"), wordDTypep, {});
+        AstVarScope* const countVscp
+            = newVar(classp, scopep, nbaTopp, m_newNames.get("count"), wordDTypep, {});
+
+        //      pos = traceBuf[0] + 3; count = 0;
+        //      if (sig != sig__prev) {
+        //          traceBuf[pos] = code; traceBuf[pos + 1] = sig[31:0]; ...
+        //          pos = pos + 1 + words; count = count + 1; sig__prev = sig;
+        //      }
+        //      ...
+        //      cycle = cycle + 1;
+        //      if (count != 0) {
+        //          traceBuf[traceBuf[0] + 1] = cycle; traceBuf[traceBuf[0] + 2] = count;
+        //          traceBuf[0] = pos - 1;
+        //      }
+        //      traceFull = traceBuf[0] > threshold;
+        AstNode* stmtsp = new AstAssign{
+            flp, mkRef(posVscp, VAccess::WRITE),
+            new AstAdd{flp, mkWord(bufVscp, mkConst(flp, 0), VAccess::READ), mkConst(flp, 3)}};
+        stmtsp->addNext(
+            new AstAssign{flp, mkRef(countVscp, VAccess::WRITE), mkConst(flp, 0)});
+        for (const auto& pair : tracedp) {
+            AstVarScope* const vscp = pair.first;
+            const TracedSignal& sig = pair.second;
+            AstVarScope* const prevVscp = newVar(classp, scopep, nullptr, m_newNames.get("prev"),
+                                                 vscp->varp()->dtypep(), {VBspFlag::MEMBER_LOCAL});
+            AstNode* thensp = new AstAssign{flp, mkWord(bufVscp, mkAdd(posVscp, 0), VAccess::WRITE),
+                                            mkConst(flp, sig.code)};
+            const int words = VL_WORDS_I(sig.width);
+            for (int word = 0; word < words; ++word) {
+                const int lsb = word * VL_EDATASIZE;
+                const int width = std::min(VL_EDATASIZE, sig.width - lsb);
+                AstNodeExpr* valuep = mkRef(vscp, VAccess::READ);
+                if (lsb || width != sig.width) valuep = new AstSel{flp, valuep, lsb, width};
+                if (width != VL_EDATASIZE) valuep = new AstExtend{flp, valuep, VL_EDATASIZE};
+                thensp->addNext(new AstAssign{
+                    flp, mkWord(bufVscp, mkAdd(posVscp, 1 + word), VAccess::WRITE), valuep});
+            }
+            thensp->addNext(new AstAssign{flp, mkRef(posVscp, VAccess::WRITE),
+                                          mkAdd(posVscp, 1 + words)});
+            thensp->addNext(
+                new AstAssign{flp, mkRef(countVscp, VAccess::WRITE), mkAdd(countVscp, 1)});
+            thensp->addNext(new AstAssign{flp, mkRef(prevVscp, VAccess::WRITE),
+                                          mkRef(vscp, VAccess::READ)});
+            stmtsp->addNext(new AstIf{flp,
+                                      new AstNeq{flp, mkRef(vscp, VAccess::READ),
+                                                 mkRef(prevVscp, VAccess::READ)},
+                                      thensp, nullptr});
+        }
+        stmtsp->addNext(
+            new AstAssign{flp, mkRef(cycleVscp, VAccess::WRITE), mkAdd(cycleVscp, 1)});
+        const auto headPlus = [&](uint32_t offset) {
+            return new AstAdd{flp, mkWord(bufVscp, mkConst(flp, 0), VAccess::READ),
+                              mkConst(flp, offset)};
+        };
+        AstNode* const recordp = new AstAssign{
+            flp, mkWord(bufVscp, headPlus(1), VAccess::WRITE), mkRef(cycleVscp, VAccess::READ)};
+        recordp->addNext(new AstAssign{flp, mkWord(bufVscp, headPlus(2), VAccess::WRITE),
+                                       mkRef(countVscp, VAccess::READ)});
+        recordp->addNext(new AstAssign{
+            flp, mkWord(bufVscp, mkConst(flp, 0), VAccess::WRITE),
+            new AstSub{flp, mkRef(posVscp, VAccess::READ), mkConst(flp, 1)}});
+        stmtsp->addNext(new AstIf{
+            flp, new AstNeq{flp, mkRef(countVscp, VAccess::READ), mkConst(flp, 0)}, recordp,
+            nullptr});
+        stmtsp->addNext(new AstAssign{
+            flp, mkRef(fullVscp, VAccess::WRITE),
+            new AstGt{flp, mkWord(bufVscp, mkConst(flp, 0), VAccess::READ),
+                      mkConst(flp, threshold)}});
+        nbaTopp->addStmtsp(stmtsp);
+
+        ++m_statsClasses;
+        m_statsSignals += tracedp.size();
+        m_statsWords += payloadWords + 1;
+    }
+
+    void writeSignals() {
+        const string filename
+            = v3Global.opt.makeDir() + "/"
+              + EmitCBaseVisitor::prefixNameProtect(m_netlistp->topModulep()) + "_trace.txt";
+        const std::unique_ptr<std::ofstream> ofp{V3File::new_ofstream(filename)};
+        if (ofp->fail()) v3fatal("Can't write " << filename);
+        *ofp << "# code width name" << endl;
+        for (const auto& pair : m_signals) {
+            const TracedSignal& sig = pair.second;
+            *ofp << sig.code << " " << sig.width << " " << sig.name << endl;
+        }
+    }
+
+    void visit(AstNode* nodep) override {}
+
+public:
+    explicit BspTraceVisitor(AstNetlist* netlistp)
+        : m_netlistp{netlistp} {
+        AstScope* const topScopep = netlistp->topScopep()->scopep();
+        for (AstVarScope* vscp = topScopep->varsp(); vscp; vscp = VN_AS(vscp->nextp(), VarScope)) {
+            AstClassRefDType* const dtypep = VN_CAST(vscp->varp()->dtypep(), ClassRefDType);
+            if (!dtypep) continue;
+            AstClass* const classp = dtypep->classp();
+            if (!classp->flag().isBsp() || classp->flag().isBspInit()
+                || classp->flag().isBspCond()) {
+                continue;
+            }
+            instrument(classp);
+        }
+        writeSignals();
+    }
+    ~BspTraceVisitor() override {
+        V3Stats::addStat("BspTrace, traced classes", m_statsClasses);
+        V3Stats::addStat("BspTrace, traced signals", m_statsSignals);
+        V3Stats::addStat("BspTrace, buffer words", m_statsWords);
+    }
+};
+
+// OR the traceFull flags of all classes in the condeval class:
+//      dpiExchange:    condeval.traceVec_i = class_i.traceFull
+//      condeval:       tmp = traceVec_0 | traceVec_1 | ...; traceFull = tmp;
+class BspTraceRequestVisitor final : public VNVisitor {
+private:
+    AstNetlist* const m_netlistp;
+    V3UniqueNames m_newNames{"__Vbsptrace"};
+
+    static AstMemberSel* mkMemberSel(AstVarScope* vscp, AstVarScope* instp, VAccess access) {
+        AstMemberSel* const selp
+            = new AstMemberSel{vscp->fileline(), new AstVarRef{vscp->fileline(), instp, access},
+                               VFlagChildDType{}, vscp->varp()->name()};
+        selp->varp(vscp->varp());
+        selp->dtypeFrom(vscp->varp());
+        return selp;
+    }
+
+    void visit(AstNode* nodep) override {}
+
+public:
+    explicit BspTraceRequestVisitor(AstNetlist* netlistp)
+        : m_netlistp{netlistp} {
+        AstScope* const topScopep = netlistp->topScopep()->scopep();
+        AstVarScope* condInstp = nullptr;
+        std::vector<std::pair<AstVarScope*, AstVarScope*>> fullsp;  // instance, traceFull
+        for (AstVarScope* vscp = topScopep->varsp(); vscp; vscp = VN_AS(vscp->nextp(), VarScope)) {
+            AstClassRefDType* const dtypep = VN_CAST(vscp->varp()->dtypep(), ClassRefDType);
+            if (!dtypep || !dtypep->classp()->flag().isBsp()) continue;
+            AstClass* const classp = dtypep->classp();
+            if (classp->flag().isBspCond()) {
+                condInstp = vscp;
+                continue;
+            }
+            classp->foreach([&](AstVarScope* memberp) {
+                if (memberp->varp()->bspFlag().hasTraceReq()) fullsp.emplace_back(vscp, memberp);
+            });
+        }
+        if (fullsp.empty()) return;
+        UASSERT(condInstp, "expected a condeval instance");
+        AstClass* const condClassp
+            = VN_AS(condInstp->varp()->dtypep(), ClassRefDType)->classp();
+        AstScope* condScopep = nullptr;
+        AstCFunc* computep = nullptr;
+        condClassp->foreach([&](AstScope* scopep) { condScopep = scopep; });
+        condClassp->foreach([&](AstCFunc* funcp) {
+            if (funcp->name() == "compute") computep = funcp;
+        });
+        AstCFunc* dpiExchangep = nullptr;
+        for (AstNode* nodep = topScopep->blocksp(); nodep; nodep = nodep->nextp()) {
+            AstCFunc* const funcp = VN_CAST(nodep, CFunc);
+            if (funcp && funcp->name() == "dpiExchange") dpiExchangep = funcp;
+        }
+        UASSERT_OBJ(condScopep && computep, condClassp, "expected condeval compute");
+        UASSERT(dpiExchangep, "expected dpiExchange");
+
+        FileLine* const flp = condClassp->fileline();
+        const auto newVar = [&](const string& name, bool funcLocal, VBspFlag flag) {
+            AstVar* const varp
+                = new AstVar{flp, VVarType::MEMBER, m_newNames.get(name), m_netlistp->findBitDType()};
+            if (funcLocal) {
+                varp->funcLocal(true);
+                varp->lifetime(VLifetime::AUTOMATIC);
+                computep->addStmtsp(varp);
+            } else {
+                varp->lifetime(VLifetime::STATIC);
+                varp->bspFlag(flag);
+                condClassp->addStmtsp(varp);
+            }
+            AstVarScope* const vscp = new AstVarScope{flp, condScopep, varp};
+            condScopep->addVarsp(vscp);
+            return vscp;
+        };
+        AstVarScope* const anyFullVscp
+            = newVar("traceFull", false, {VBspFlag::MEMBER_OUTPUT, VBspFlag::MEMBER_TRACEREQ});
+        AstVarScope* const tmpVscp = newVar("tmp", true, {});
+        computep->addStmtsp(new AstAssign{flp, new AstVarRef{flp, tmpVscp, VAccess::WRITE},
+                                          new AstConst{flp, AstConst::BitFalse{}}});
+        for (const auto& pair : fullsp) {
+            AstVarScope* const vecVscp = newVar("traceVec", false, {VBspFlag::MEMBER_INPUT});
+            dpiExchangep->addStmtsp(
+                new AstAssign{flp, mkMemberSel(vecVscp, condInstp, VAccess::WRITE),
+                              mkMemberSel(pair.second, pair.first, VAccess::READ)});
+            computep->addStmtsp(
+                new AstAssign{flp, new AstVarRef{flp, tmpVscp, VAccess::WRITE},
+                              new AstOr{flp, new AstVarRef{flp, tmpVscp, VAccess::READ},
+                                        new AstVarRef{flp, vecVscp, VAccess::READ}}});
+        }
+        computep->addStmtsp(new AstAssign{flp, new AstVarRef{flp, anyFullVscp, VAccess::WRITE},
+                                          new AstVarRef{flp, tmpVscp, VAccess::READ}});
+    }
+};
+
+}  // namespace
+
+void V3BspTrace::traceAll(AstNetlist* netlistp) {
+    UINFO(2, __FUNCTION__ << ": " << endl);
+    { BspTraceVisitor{netlistp}; }
+    v3Global.dumpCheckGlobalTree("bsptrace", 0, dumpTree() >= 3);
+}
+
+void V3BspTrace::requestAll(AstNetlist* netlistp) {
+    UINFO(2, __FUNCTION__ << ": " << endl);
+    { BspTraceRequestVisitor{netlistp}; }
+    v3Global.dumpCheckGlobalTree("bsptracereq", 0, dumpTree() >= 3);
+}
@@ -0,0 +1,57 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator BSP: Waveform tracing through on-tile change buffers
+//
+// Code available from: https://verilator.org
+//
+//*************************************************************************
+//
+// Copyright 2005-2023 by Wilson Snyder. This program is free software; you
+// can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+// SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+//
+//*************************************************************************
+//
+// With --trace, every BSP class records the traced members that its nbaTop
+// computes into a buffer of its own. The end of nbaTop compares each of them
+// against its value in the previous cycle and appends the ones that changed,
+// so the cost of tracing follows the activity of the class:
+//
+//      traceBuf[0]                     number of used words after traceBuf[0]
+//      traceBuf[1 ...]                 records, one per cycle with a change:
+//          cycle, count, count x { code, value words (LSB first) }
+//
+// Each class also raises traceFull when its buffer may not hold the cycles
+// simulated until the next check of the host request (--bsp-cycle-batch and
+// one more for the fused condition). The condeval class ORs these flags in
+// traceFull, on which the runtime copies all the buffers to the host and
+// clears them. The remaining records are copied at the end of every nba
+// program. The code, width and name of every traced signal are written to
+// <prefix>_trace.txt, which the runtime reads to create the FST file.
+//
+//*************************************************************************
+
+#ifndef VERILATOR_V3BSPTRACE_H_
+#define VERILATOR_V3BSPTRACE_H_
+
+#include "config_build.h"
+#include "verilatedos.h"
+
+#include "V3Ast.h"
+#include "V3Error.h"
+
+//============================================================================
+
+class V3BspTrace final {
+public:
+    // Record the changes of the traced members, before V3BspDpi::delegateAll so that
+    // re-entering nbaTop records a cycle only once
+    static void traceAll(AstNetlist* nodep);
+    // Gather the traceFull flags of all classes in the condeval class, after
+    // V3BspDpi::delegateAll created it
+    static void requestAll(AstNetlist* nodep);
+};
+
+#endif  // Guard
@@ -133,6 +133,12 @@ void EmitCBaseVisitor::emitVarDecl(const AstVar* nodep, bool asRef) {
     const AstBasicDType* const basicp = nodep->basicp();
     bool refNeedParens = VN_IS(nodep->dtypeSkipRefp(), UnpackArrayDType);
 
+    // Keep variables written by different threads on different cache lines
+    if (nodep->alignCacheLine() && !asRef) {
+        puts("VL_CACHE_LINE_PAD(__Vpad_" + nodep->nameProtect() + ")\n");
+        puts("VL_ALIGNAS_CACHE_LINE ");
+    }
+
     const auto emitDeclArrayBrackets = [this](const AstVar* nodep) -> void {
         // This isn't very robust and may need cleanup for other data types
         for (const AstUnpackArrayDType* arrayp = VN_CAST(nodep->dtypeSkipRefp(), UnpackArrayDType);
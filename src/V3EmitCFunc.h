@@ -191,6 +191,17 @@ public:
     void emitCCallArgs(const AstNodeCCall* nodep, const string& selfPointer);
     void emitDereference(const string& pointer);
     void emitCvtPackStr(AstNode* nodep);
+    void emitPlusArgsSearch(AstNode* searchp, int instance) {
+        if (instance < 0) {
+            emitCvtPackStr(searchp);
+            return;
+        }
+        puts("VL_INSTANCE_PLUSARGS(");
+        puts(cvtToStr(instance));
+        puts(", ");
+        emitCvtPackStr(searchp);
+        puts(")");
+    }
     void emitCvtWideArray(AstNode* nodep, AstNode* fromp);
     void emitConstant(AstConst* nodep, AstVarRef* assigntop, const string& assignString);
     void emitSetVarConstant(const string& assignString, AstConst* constp);
@@ -623,7 +634,7 @@ public:
         puts("(");
         puts(cvtToStr(nodep->outp()->widthMin()));
         puts(", ");
-        emitCvtPackStr(nodep->searchp());
+        emitPlusArgsSearch(nodep->searchp(), nodep->instance());
         puts(", ");
         putbs("");
         iterateAndNextNull(nodep->outp());
@@ -631,7 +642,7 @@ public:
     }
     void visit(AstTestPlusArgs* nodep) override {
         puts("VL_TESTPLUSARGS_I(");
-        emitCvtPackStr(nodep->searchp());
+        emitPlusArgsSearch(nodep->searchp(), nodep->instance());
         puts(")");
     }
     void visit(AstValuePlusArgsProxy* nodep) override {
@@ -926,7 +937,15 @@ public:
         puts(");\n");
     }
     void visit(AstFinish* nodep) override {
-        puts("VL_FINISH_MT(");
+        if (nodep->instance() >= 0) {
+            puts("VL_FINISH_INSTANCE_MT(");
+            puts(cvtToStr(nodep->instance()));
+            puts(", ");
+            puts(cvtToStr(v3Global.opt.instances()));
+            puts(", ");
+        } else {
+            puts("VL_FINISH_MT(");
+        }
         putsQuoted(protect(nodep->fileline()->filename()));
         puts(", ");
         puts(cvtToStr(nodep->fileline()->lineno()));
@@ -875,6 +875,30 @@ void EmitCSyms::emitSymImp() {
 
     emitScopeHier(false);
 
+    if (v3Global.opt.mtasks() && v3Global.opt.threadsNuma()) {
+        puts("// Place the variables written by each thread on the NUMA node of the thread\n");
+        for (const auto& i : m_scopes) {
+            const AstScope* const scopep = i.first;
+            const AstNodeModule* const modp = i.second;
+            for (const AstNode* nodep = modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+                const AstVar* const varp = VN_CAST(nodep, Var);
+                if (!varp || varp->writerThread() < 0 || varp->isStatic()) continue;
+                checkSplit(false);
+                const string varName = protectIf(scopep->nameDotless(), scopep->protect()) + "."
+                                       + protect(varp->name());
+                // V3Partition numbers the thread running eval after the last worker, the
+                // pool may have more workers at run time
+                const string thread = varp->writerThread() == v3Global.opt.threads() - 1
+                                          ? "VlThreadPool::MAIN_THREAD"
+                                          : cvtToStr(varp->writerThread());
+                puts("__Vm_threadPoolp->numaOwn(" + thread + ", &" + varName + ", sizeof("
+                     + varName + "));\n");
+                ++m_numStmts;
+            }
+        }
+        puts("__Vm_threadPoolp->numaPlace();\n");
+    }
+
     // Everything past here is in the __Vfinal loop, so start a new split file if needed
     closeSplit();
 
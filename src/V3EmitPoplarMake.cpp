@@ -78,8 +78,18 @@ public:
         ofp->puts("OBJ_DIR := " + v3Global.opt.makeDir() + "\n");
         ofp->puts("TILES_USED := " + cvtToStr(v3Global.opt.tiles()) + "\n");
         ofp->puts("WORKERS_USED := " + cvtToStr(v3Global.opt.workers()) + "\n");
+        ofp->puts("FUSED_COND := " + cvtToStr(v3Global.bspFusedCond() ? 1 : 0) + "\n");
+        ofp->puts("CYCLE_BATCH := " + cvtToStr(v3Global.bspCycleBatch()) + "\n");
+        // the lookahead windows are only used when batching cycles
+        ofp->puts("LOOKAHEAD := "
+                  + cvtToStr(v3Global.bspCycleBatch() > 1 ? v3Global.bspLookahead() : 1) + "\n");
+        ofp->puts("TRACE := " + cvtToStr(v3Global.opt.trace() ? 1 : 0) + "\n");
         ofp->puts("\n");
-        ofp->puts("include $(PARENDI_ROOT)/include/vlpoplar/verilated.mk\n");
+        if (v3Global.opt.bspCpu()) {
+            ofp->puts("include $(PARENDI_ROOT)/include/vlpoplar/verilated_bsp_cpu.mk\n");
+        } else {
+            ofp->puts("include $(PARENDI_ROOT)/include/vlpoplar/verilated.mk\n");
+        }
 
         // ofp->puts("HOST_SOURCES += $(USER_CPP)\n");
         // ofp->puts("OBJS_HOST = $(HOST_SOURCES:cpp=o)\n");
@@ -64,7 +64,11 @@ private:
         puts("#include \"" + topClassName() + "__structs.h\"\n");
         // puts("using namespace poplar;");
         if (!header) {
-            puts("#include <vlpoplar/verilated_poplar_context.h>\n");
+            if (v3Global.opt.bspCpu()) {
+                puts("#include <vlpoplar/verilated_bsp_cpu_context.h>\n");
+            } else {
+                puts("#include <vlpoplar/verilated_poplar_context.h>\n");
+            }
             for (const auto& hdr : m_headers) { puts("#include \"" + hdr + "\"\n"); }
         }
         if (!header) {
@@ -84,7 +84,7 @@ private:
         puts("// Poplar vertex implementation\n");
         if (m_usesSupervisor) { puts("#define VL_USES_IPU_SUPERVISOR\n"); }
         puts("#include <vlpoplar/verilated.h>\n");
-        puts("#include <poplar/Vertex.hpp>\n");
+        if (!v3Global.opt.bspCpu()) puts("#include <poplar/Vertex.hpp>\n");
         puts("#include \"" + topClassName() + "__structs.h\"\n");
         // puts("using namespace poplar;");
 
@@ -128,7 +128,8 @@ private:
         // emit method decls
         for (AstNode* stmtp = classp->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
             if (AstCFunc* funcp = VN_CAST(stmtp, CFunc)) {
-                if (classp->flag().isSupervisor() && funcp->name() == "compute") {
+                if (classp->flag().isSupervisor() && funcp->name() == "compute"
+                    && !v3Global.opt.bspCpu()) {
                     puts("__attribute__((target(\"supervisor\"))) ");
                 }
                 emitCFuncHeader(funcp, classp, false);
@@ -143,6 +144,22 @@ private:
         for (AstNode* stmtp = classp->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
             if (AstCFunc* funcp = VN_CAST(stmtp, CFunc)) { EmitCFunc::visit(funcp); }
         }
+        if (v3Global.opt.bspCpu()) emitCpuRegistration(classp);
+    }
+
+    void emitCpuRegistration(const AstClass* classp) {
+        // With --bsp-cpu there is no poplar graph to look up codelets and fields
+        // by name, so register them with the host runtime instead
+        const string name = prefixNameProtect(classp);
+        puts("\nstatic VlBspCpuVertexRegistrar<" + name + "> __Vbspcpu_" + name + "{\"" + name
+             + "\", {\n");
+        for (AstNode* stmtp = classp->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
+            if (const AstVar* const varp = VN_CAST(stmtp, Var)) {
+                puts("VlBspCpuVertexRegistrar<" + name + ">::field(\"" + varp->nameProtect()
+                     + "\", &" + name + "::" + varp->nameProtect() + "),\n");
+            }
+        }
+        puts("}};\n\n");
     }
 
     explicit EmitPoplarVertex(AstNetlist* netlistp)
@@ -114,6 +114,9 @@ class V3Global final {
     bool m_hasSCTextSections = false;  // Has `systemc_* sections that need to be emitted
     bool m_useParallelBuild = false;  // Use parallel build for model
     bool m_useRandomizeMethods = false;  // Need to define randomize() class methods
+    bool m_bspFusedCond = false;  // Host request condition is evaluated with the workload
+    int m_bspCycleBatch = 1;  // Cycles simulated between two host request checks
+    int m_bspLookahead = 1;  // Cycles simulated between two exchanges, see V3BspLookahead
 
     // Memory address to short string mapping (for debug)
     std::unordered_map<const void*, std::string>
@@ -149,6 +152,12 @@ public:
     void needTraceDumper(bool flag) { m_needTraceDumper = flag; }
     bool dpi() const VL_MT_SAFE { return m_dpi; }
     void dpi(bool flag) { m_dpi = flag; }
+    bool bspFusedCond() const { return m_bspFusedCond; }
+    void bspFusedCond(bool flag) { m_bspFusedCond = flag; }
+    int bspCycleBatch() const { return m_bspCycleBatch; }
+    void bspCycleBatch(int n) { m_bspCycleBatch = n; }
+    int bspLookahead() const { return m_bspLookahead; }
+    void bspLookahead(int n) { m_bspLookahead = n; }
     bool hasEvents() const { return m_hasEvents; }
     void setHasEvents() { m_hasEvents = true; }
     bool hasClasses() const { return m_hasClasses; }
@@ -19,7 +19,7 @@
 #include "verilatedos.h"
 
 #include "V3InstrCount.h"
-#include "V3BspIpuCostModelLinReg.h"
+#include "V3BspCostModel.h"
 
 #include "V3Ast.h"
 
@@ -266,7 +266,7 @@ private:
 
 public:
     static int count(AstNode* nodep) {
-        return IpuCostModelLinReg::estimate(nodep);
+        return V3BspCostModel::estimate(nodep);
         // const IpuInstrCountOverride vi{nodep};
         // return vi.m_count;
     }
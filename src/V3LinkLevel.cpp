@@ -190,6 +190,7 @@ void V3LinkLevel::wrapTop(AstNetlist* rootp) {
 void V3LinkLevel::wrapTopCell(AstNetlist* rootp) {
     AstNodeModule* const newmodp = rootp->modulesp();
     UASSERT_OBJ(newmodp && newmodp->isTop(), rootp, "No TOP module found to insert under");
+    const int instances = v3Global.opt.instances();
 
     // Find all duplicate signal names (if multitop)
     using NameSet = std::unordered_set<std::string>;
@@ -246,143 +247,117 @@ void V3LinkLevel::wrapTopCell(AstNetlist* rootp) {
     for (AstNodeModule* oldmodp = VN_AS(rootp->modulesp()->nextp(), NodeModule);
          oldmodp && oldmodp->level() <= 2; oldmodp = VN_AS(oldmodp->nextp(), NodeModule)) {
         if (VN_IS(oldmodp, Package)) continue;
-        // Add instance
-        UINFO(5, "LOOP " << oldmodp << endl);
-        AstCell* const cellp = new AstCell{
-            newmodp->fileline(),
-            newmodp->fileline(),
-            (!v3Global.opt.l2Name().empty() ? v3Global.opt.l2Name() : oldmodp->name()),
-            oldmodp->name(),
-            nullptr,
-            nullptr,
-            nullptr};
-        cellp->modp(oldmodp);
-        newmodp->addStmtsp(cellp);
-
-        // Add pins
-        for (AstNode* subnodep = oldmodp->stmtsp(); subnodep; subnodep = subnodep->nextp()) {
-            if (AstVar* const oldvarp = VN_CAST(subnodep, Var)) {
-                UINFO(8, "VARWRAP " << oldvarp << endl);
-                if (oldvarp->isIO()) {
-                    string name = oldvarp->name();
-                    if (dupNames.find(name) != dupNames.end()) {
-                        // __02E=. while __DOT__ looks nicer but will break V3LinkDot
-                        name = oldmodp->name() + "__02E" + name;
-                    }
-
-                    AstVar* const varp = oldvarp->cloneTree(false);
-                    varp->name(name);
-                    varp->protect(false);
-                    newmodp->addStmtsp(varp);
-                    varp->sigPublic(true);  // User needs to be able to get to it...
-                    oldvarp->primaryIO(false);
-                    varp->primaryIO(true);
-                    if (varp->direction().isRefOrConstRef()) {
-                        varp->v3warn(E_UNSUPPORTED,
-                                     "Unsupported: ref/const ref as primary input/output: "
-                                         << varp->prettyNameQ());
-                    }
-                    if (varp->isIO() && v3Global.opt.systemC()) {
-                        varp->sc(true);
-                        // User can see trace one level down from the wrapper
-                        // Avoids packing & unpacking SC signals a second time
-                        varp->trace(false);
-                    }
-
-                    AstPin* const pinp = new AstPin{
-                        oldvarp->fileline(), 0, varp->name(),
-                        new AstVarRef{varp->fileline(), varp,
-                                      oldvarp->isWritable() ? VAccess::WRITE : VAccess::READ}};
-                    // Skip length and width comp; we know it's a direct assignment
-                    pinp->modVarp(oldvarp);
-                    cellp->addPinsp(pinp);
-                } else if (v3Global.opt.topIfacesSupported() && oldvarp->isIfaceRef()) {
-                    // for each interface port on oldmodp instantiate a corresponding interface
-                    // cell in $root
-                    const AstNodeDType* const subtypep = oldvarp->subDTypep();
-                    if (VN_IS(subtypep, IfaceRefDType)) {
-                        const AstIfaceRefDType* const ifacerefp = VN_AS(subtypep, IfaceRefDType);
-                        if (!ifacerefp->cellp()) {
-                            string name = oldvarp->name();
-                            if (dupNames.find(name) != dupNames.end()) {
-                                // __02E=. while __DOT__ looks nicer but will break V3LinkDot
-                                name = oldmodp->name() + "__02E" + name;
-                            }
+        const string baseName
+            = !v3Global.opt.l2Name().empty() ? v3Global.opt.l2Name() : oldmodp->name();
+        if (instances > 1) {
+            // Keep a scope per instance, V3Scope tags the instance of the statements under it
+            oldmodp->addStmtsp(new AstPragma{oldmodp->fileline(), VPragmaType::NO_INLINE_MODULE});
+        }
+        // With --instances the copies share their inputs, so they all run from the same
+        // clocks, which the BSP flow requires
+        std::unordered_map<string, AstVar*> sharedInputs;
+        // With --instances, wrap N copies of the top, each with its own ports
+        for (int instance = 0; instance < instances; ++instance) {
+            const string cellName
+                = instances > 1 ? baseName + "_" + cvtToStr(instance) : baseName;
+            const auto portName = [&](const string& name, bool shared) {
+                // Ports of an instance are prefixed like the duplicates of a multitop
+                // __02E=. while __DOT__ looks nicer but will break V3LinkDot
+                if (instances > 1 && !shared) return cellName + "__02E" + name;
+                if (dupNames.find(name) != dupNames.end()) return oldmodp->name() + "__02E" + name;
+                return name;
+            };
+            // Add instance
+            UINFO(5, "LOOP " << oldmodp << endl);
+            AstCell* const cellp = new AstCell{
+                newmodp->fileline(),
+                newmodp->fileline(),
+                cellName,
+                oldmodp->name(),
+                nullptr,
+                nullptr,
+                nullptr};
+            cellp->modp(oldmodp);
+            newmodp->addStmtsp(cellp);
 
-                            AstCell* ifacecellp = new AstCell{newmodp->fileline(),
-                                                              newmodp->fileline(),
-                                                              name,
-                                                              ifacerefp->ifaceName(),
-                                                              nullptr,
-                                                              nullptr,
-                                                              nullptr};
-                            ifacecellp->modp(ifacerefp->ifacep());
-                            newmodp->addStmtsp(ifacecellp);
-
-                            AstIfaceRefDType* const idtypep = new AstIfaceRefDType{
-                                newmodp->fileline(), name, ifacerefp->ifaceName()};
-                            idtypep->ifacep(nullptr);
-                            idtypep->dtypep(idtypep);
-                            idtypep->cellp(ifacecellp);
-                            rootp->typeTablep()->addTypesp(idtypep);
-
-                            AstVar* varp = new AstVar{newmodp->fileline(), VVarType::IFACEREF,
-                                                      name + "__Viftop", idtypep};
-                            varp->isIfaceParent(true);
-                            ifacecellp->addNextHere(varp);
-                            ifacecellp->hasIfaceVar(true);
-
-                            AstPin* const pinp
-                                = new AstPin{oldvarp->fileline(), 0, varp->name(),
-                                             new AstVarRef{varp->fileline(), varp,
-                                                           oldvarp->isWritable() ? VAccess::WRITE
-                                                                                 : VAccess::READ}};
+            // Add pins
+            for (AstNode* subnodep = oldmodp->stmtsp(); subnodep; subnodep = subnodep->nextp()) {
+                if (AstVar* const oldvarp = VN_CAST(subnodep, Var)) {
+                    UINFO(8, "VARWRAP " << oldvarp << endl);
+                    if (oldvarp->isIO()) {
+                        const bool shared
+                            = instances > 1 && oldvarp->direction() == VDirection::INPUT;
+                        const auto sharedIt = sharedInputs.find(oldvarp->name());
+                        if (shared && sharedIt != sharedInputs.end()) {
+                            AstVar* const varp = sharedIt->second;
+                            AstPin* const pinp = new AstPin{
+                                oldvarp->fileline(), 0, varp->name(),
+                                new AstVarRef{varp->fileline(), varp, VAccess::READ}};
                             pinp->modVarp(oldvarp);
                             cellp->addPinsp(pinp);
+                            continue;
                         }
-                    } else if (VN_IS(subtypep, UnpackArrayDType)) {
-                        const AstUnpackArrayDType* const oldarrp
-                            = VN_AS(subtypep, UnpackArrayDType);
-                        const AstNodeDType* const arrsubtypep = oldarrp->subDTypep();
-                        if (VN_IS(arrsubtypep, IfaceRefDType)) {
+                        const string name = portName(oldvarp->name(), shared);
+
+                        AstVar* const varp = oldvarp->cloneTree(false);
+                        if (shared) sharedInputs.emplace(oldvarp->name(), varp);
+                        varp->name(name);
+                        varp->protect(false);
+                        newmodp->addStmtsp(varp);
+                        varp->sigPublic(true);  // User needs to be able to get to it...
+                        oldvarp->primaryIO(false);
+                        varp->primaryIO(true);
+                        if (varp->direction().isRefOrConstRef()) {
+                            varp->v3warn(E_UNSUPPORTED,
+                                         "Unsupported: ref/const ref as primary input/output: "
+                                             << varp->prettyNameQ());
+                        }
+                        if (varp->isIO() && v3Global.opt.systemC()) {
+                            varp->sc(true);
+                            // User can see trace one level down from the wrapper
+                            // Avoids packing & unpacking SC signals a second time
+                            varp->trace(false);
+                        }
+
+                        AstPin* const pinp = new AstPin{
+                            oldvarp->fileline(), 0, varp->name(),
+                            new AstVarRef{varp->fileline(), varp,
+                                          oldvarp->isWritable() ? VAccess::WRITE : VAccess::READ}};
+                        // Skip length and width comp; we know it's a direct assignment
+                        pinp->modVarp(oldvarp);
+                        cellp->addPinsp(pinp);
+                    } else if (v3Global.opt.topIfacesSupported() && oldvarp->isIfaceRef()) {
+                        // for each interface port on oldmodp instantiate a corresponding interface
+                        // cell in $root
+                        const AstNodeDType* const subtypep = oldvarp->subDTypep();
+                        if (VN_IS(subtypep, IfaceRefDType)) {
                             const AstIfaceRefDType* const ifacerefp
-                                = VN_AS(arrsubtypep, IfaceRefDType);
+                                = VN_AS(subtypep, IfaceRefDType);
                             if (!ifacerefp->cellp()) {
-                                string name = oldvarp->name();
-                                if (dupNames.find(name) != dupNames.end()) {
-                                    // __02E=. while __DOT__ looks nicer but will break V3LinkDot
-                                    name = oldmodp->name() + "__02E" + name;
-                                }
-
-                                AstUnpackArrayDType* arraydtypep
-                                    = VN_AS(oldvarp->dtypep(), UnpackArrayDType);
-                                AstCell* ifacearraycellp
-                                    = new AstCell{newmodp->fileline(),
-                                                  newmodp->fileline(),
-                                                  name,
-                                                  ifacerefp->ifaceName(),
-                                                  nullptr,
-                                                  nullptr,
-                                                  arraydtypep->rangep()->cloneTree(true)};
-                                ifacearraycellp->modp(ifacerefp->ifacep());
-                                newmodp->addStmtsp(ifacearraycellp);
+                                const string name = portName(oldvarp->name(), false);
+
+                                AstCell* ifacecellp = new AstCell{newmodp->fileline(),
+                                                                  newmodp->fileline(),
+                                                                  name,
+                                                                  ifacerefp->ifaceName(),
+                                                                  nullptr,
+                                                                  nullptr,
+                                                                  nullptr};
+                                ifacecellp->modp(ifacerefp->ifacep());
+                                newmodp->addStmtsp(ifacecellp);
 
                                 AstIfaceRefDType* const idtypep = new AstIfaceRefDType{
                                     newmodp->fileline(), name, ifacerefp->ifaceName()};
                                 idtypep->ifacep(nullptr);
                                 idtypep->dtypep(idtypep);
-                                idtypep->cellp(ifacearraycellp);
+                                idtypep->cellp(ifacecellp);
                                 rootp->typeTablep()->addTypesp(idtypep);
 
-                                AstNodeArrayDType* const arrp = new AstUnpackArrayDType{
-                                    newmodp->fileline(), idtypep,
-                                    arraydtypep->rangep()->cloneTree(true)};
                                 AstVar* varp = new AstVar{newmodp->fileline(), VVarType::IFACEREF,
-                                                          name + "__Viftop", arrp};
+                                                          name + "__Viftop", idtypep};
                                 varp->isIfaceParent(true);
-                                ifacearraycellp->addNextHere(varp);
-                                ifacearraycellp->hasIfaceVar(true);
-                                rootp->typeTablep()->addTypesp(arrp);
+                                ifacecellp->addNextHere(varp);
+                                ifacecellp->hasIfaceVar(true);
 
                                 AstPin* const pinp = new AstPin{
                                     oldvarp->fileline(), 0, varp->name(),
@@ -392,6 +367,56 @@ void V3LinkLevel::wrapTopCell(AstNetlist* rootp) {
                                 pinp->modVarp(oldvarp);
                                 cellp->addPinsp(pinp);
                             }
+                        } else if (VN_IS(subtypep, UnpackArrayDType)) {
+                            const AstUnpackArrayDType* const oldarrp
+                                = VN_AS(subtypep, UnpackArrayDType);
+                            const AstNodeDType* const arrsubtypep = oldarrp->subDTypep();
+                            if (VN_IS(arrsubtypep, IfaceRefDType)) {
+                                const AstIfaceRefDType* const ifacerefp
+                                    = VN_AS(arrsubtypep, IfaceRefDType);
+                                if (!ifacerefp->cellp()) {
+                                    const string name = portName(oldvarp->name(), false);
+
+                                    AstUnpackArrayDType* arraydtypep
+                                        = VN_AS(oldvarp->dtypep(), UnpackArrayDType);
+                                    AstCell* ifacearraycellp
+                                        = new AstCell{newmodp->fileline(),
+                                                      newmodp->fileline(),
+                                                      name,
+                                                      ifacerefp->ifaceName(),
+                                                      nullptr,
+                                                      nullptr,
+                                                      arraydtypep->rangep()->cloneTree(true)};
+                                    ifacearraycellp->modp(ifacerefp->ifacep());
+                                    newmodp->addStmtsp(ifacearraycellp);
+
+                                    AstIfaceRefDType* const idtypep = new AstIfaceRefDType{
+                                        newmodp->fileline(), name, ifacerefp->ifaceName()};
+                                    idtypep->ifacep(nullptr);
+                                    idtypep->dtypep(idtypep);
+                                    idtypep->cellp(ifacearraycellp);
+                                    rootp->typeTablep()->addTypesp(idtypep);
+
+                                    AstNodeArrayDType* const arrp = new AstUnpackArrayDType{
+                                        newmodp->fileline(), idtypep,
+                                        arraydtypep->rangep()->cloneTree(true)};
+                                    AstVar* varp
+                                        = new AstVar{newmodp->fileline(), VVarType::IFACEREF,
+                                                     name + "__Viftop", arrp};
+                                    varp->isIfaceParent(true);
+                                    ifacearraycellp->addNextHere(varp);
+                                    ifacearraycellp->hasIfaceVar(true);
+                                    rootp->typeTablep()->addTypesp(arrp);
+
+                                    AstPin* const pinp = new AstPin{
+                                        oldvarp->fileline(), 0, varp->name(),
+                                        new AstVarRef{varp->fileline(), varp,
+                                                      oldvarp->isWritable() ? VAccess::WRITE
+                                                                            : VAccess::READ}};
+                                    pinp->modVarp(oldvarp);
+                                    cellp->addPinsp(pinp);
+                                }
+                            }
                         }
                     }
                 }
@@ -447,6 +447,11 @@ void V3Options::poplarSet() {  // --poplar
     m_systemC = false;
     m_poplar = true;
 }
+void V3Options::bspCpuSet() {  // --bsp-cpu
+    // Same BSP pipeline as --poplar, only the emitted makefile and runtime differ
+    poplarSet();
+    m_bspCpu = true;
+}
 //######################################################################
 // File searching
 
@@ -1077,6 +1082,13 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
         m_main = true;
         if (m_timing.isDefault()) m_timing = VOptionBool::OPT_TRUE;
     });
+    DECL_OPTION("-bsp-cost-model", Set, &m_bspCostModel);
+    DECL_OPTION("-bsp-profile-use", Set, &m_bspProfileUse);
+    DECL_OPTION("-bsp-cpu", CbCall, [this]() { bspCpuSet(); });
+    DECL_OPTION("-bsp-cycle-batch", CbVal, [this, fl](const char* valp) {
+        m_bspCycleBatch = std::atoi(valp);
+        if (m_bspCycleBatch <= 0) fl->v3fatal("--bsp-cycle-batch must be > 0: " << valp);
+    });
     DECL_OPTION("-build", Set, &m_build);
     DECL_OPTION("-build-dep-bin", Set, &m_buildDepBin);
     DECL_OPTION("-build-jobs", CbVal, [this, fl](const char* valp) {
@@ -1225,6 +1237,10 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
     DECL_OPTION("-fipu-resync", FOnOff, &m_fIpuResync);
     DECL_OPTION("-finter-ipu-comm", FOnOff, &m_fInterIpuComm);
     DECL_OPTION("-fpre-merge-ipu-partition", FOnOff, &m_fPreMergeIpuPartition);
+    DECL_OPTION("-fipu-partition-cache", FOnOff, &m_fIpuPartitionCache);
+    DECL_OPTION("-fipu-exchange-place", FOnOff, &m_fIpuExchangePlace);
+    DECL_OPTION("-fipu-fused-cond", FOnOff, &m_fIpuFusedCond);
+    DECL_OPTION("-fipu-activity-gate", FOnOff, &m_fIpuActivityGate);
     DECL_OPTION("-G", CbPartialMatch, [this](const char* optp) { addParameter(optp, false); });
     DECL_OPTION("-gate-stmts", Set, &m_gateStmts);
     DECL_OPTION("-gdb", CbCall, []() {});  // Processed only in bin/verilator shell
@@ -1254,6 +1270,10 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
     DECL_OPTION("-if-depth", Set, &m_ifDepth);
     DECL_OPTION("-ignc", OnOff, &m_ignc);
     DECL_OPTION("-inline-mult", Set, &m_inlineMult);
+    DECL_OPTION("-instances", CbVal, [this, fl](int val) {
+        m_instances = val;
+        if (m_instances <= 0) fl->v3fatal("--instances must be > 0: " << val);
+    });
     DECL_OPTION("-instr-count-dpi", CbVal, [this, fl](int val) {
         m_instrCountDpi = val;
         if (m_instrCountDpi < 0) fl->v3fatal("--instr-count-dpi must be non-negative: " << val);
@@ -1452,6 +1472,8 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
         if (m_tiles <= 0) fl->v3fatal("--tiles must be >= 0: " << valp);
     });
 
+    DECL_OPTION("-threads-numa", OnOff, &m_threadsNuma);
+    DECL_OPTION("-threads-persistent", OnOff, &m_threadsPersistent);
     DECL_OPTION("-threads-dpi", CbVal, [this, fl](const char* valp) {
         if (!std::strcmp(valp, "all")) {
             m_threadsDpiPure = true;
@@ -1613,6 +1635,22 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
                                                                                         << endl);
         }
     });
+    DECL_OPTION("-bsp-lookahead", CbVal, [this, fl](const char* valp) {
+        m_bspLookahead = std::atoi(valp);
+        if (m_bspLookahead <= 0) fl->v3fatal("--bsp-lookahead must be > 0: " << valp);
+    });
+    DECL_OPTION("-bsp-broadcast-fanout", CbVal, [this, fl](const char* valp) {
+        m_bspBroadcastFanout = std::atoi(valp);
+        if (m_bspBroadcastFanout < 0) {
+            fl->v3fatal("--bsp-broadcast-fanout must be >= 0: " << valp);
+        }
+    });
+    DECL_OPTION("-lookahead-threshold", CbVal, [this, fl](const char* valp) {
+        m_lookaheadThreshold = std::atof(valp);
+        if (m_lookaheadThreshold < 0.0) {
+            fl->v3fatal("--lookahead-threshold should be >= 0.0 but was given " << valp << endl);
+        }
+    });
     DECL_OPTION("-kahypar-imbalance", CbVal, [this, fl](const char* valp) {
         m_kahyparImbalance = std::atof(valp);
         if (m_kahyparImbalance > 1.0 || m_kahyparImbalance < 0.0) {
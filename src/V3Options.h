@@ -192,7 +192,8 @@ public:
         BottomUpTopDown = 1,
         TopDown = 2,
         Hypergraph = 3,
-        Invalid = 4
+        ParallelHypergraph = 4,
+        Invalid = 5
     };
 private:
     Strategy m_strategy = Strategy::BottomUp;
@@ -204,6 +205,7 @@ public:
     bool topDown() const { return m_strategy == Strategy::TopDown; }
     bool bottomUpTopDown() const { return m_strategy == Strategy::BottomUpTopDown; }
     bool hypergraph() const { return m_strategy == Strategy::Hypergraph; }
+    bool parallelHypergraph() const { return m_strategy == Strategy::ParallelHypergraph; }
     bool valid() const { return m_strategy != Strategy::Invalid; }
     float threshold() const { return m_bottomUpThreshold; }
     void threshold(float v) { m_bottomUpThreshold = v; }
@@ -214,13 +216,14 @@ public:
 
     const char* ascii() const {
         static const char* const m_names[] = {
-            "BottomUp", "BottomUpTopDown", "TopDown", "Hypergraph", "Invalid"
+            "BottomUp", "BottomUpTopDown", "TopDown", "Hypergraph", "ParallelHypergraph",
+            "Invalid"
         };
         return m_names[m_strategy];
     }
 
     static std::string list() {
-        return "BottomUp, BottomUpTopDown, TopDown, or Hypergraph";
+        return "BottomUp, BottomUpTopDown, TopDown, Hypergraph, or ParallelHypergraph";
     }
 
     void setFrom(const std::string& n) {
@@ -232,6 +235,8 @@ public:
             m_strategy = Strategy::BottomUpTopDown;
         } else if (n == "Hypergraph") {
             m_strategy = Strategy::Hypergraph;
+        } else if (n == "ParallelHypergraph") {
+            m_strategy = Strategy::ParallelHypergraph;
         } else {
             m_strategy = Strategy::Invalid;
         }
@@ -324,11 +329,14 @@ private:
     bool m_structsPacked = false;   // main switch: --structs-packed
     bool m_systemC = false;         // main switch: --sc: System C instead of simple C++
     bool m_poplar = false;          // main switch: --poplar generate code for IPU
+    bool m_bspCpu = false;          // main switch: --bsp-cpu generate BSP code for host CPUs
     bool m_stats = false;           // main switch: --stats
     bool m_statsVars = false;       // main switch: --stats-vars
     bool m_threadsCoarsen = true;   // main switch: --threads-coarsen
     bool m_threadsDpiPure = true;   // main switch: --threads-dpi all/pure
     bool m_threadsDpiUnpure = false;  // main switch: --threads-dpi all
+    bool m_threadsNuma = false;  // main switch: --threads-numa
+    bool m_threadsPersistent = false;  // main switch: --threads-persistent
     VOptionBool m_timing;           // main switch: --timing
     bool m_trace = false;           // main switch: --trace
     bool m_traceCoverage = false;   // main switch: --trace-coverage
@@ -349,6 +357,7 @@ private:
     int         m_hierChild = 0;      // main switch: --hierarchical-child
     int         m_ifDepth = 0;      // main switch: --if-depth
     int         m_inlineMult = 2000;   // main switch: --inline-mult
+    int         m_instances = 1;    // main switch: --instances
     int         m_instrCountDpi = 200;   // main switch: --instr-count-dpi
     VOptionBool m_makeDepend;  // main switch: -MMD
     int         m_maxNumWidth = 65536;  // main switch: --max-num-width
@@ -364,7 +373,11 @@ private:
     int         m_workers = 1;      // main poplar switch: --workers
     int         m_maxUnpackCopies = 4096;   // main poplar switch: --max-unpack-copies
     int         m_diffExchangeThreshold = 16; // main poplar switch: --diff-exchange-threshold
+    int         m_bspCycleBatch = 1; // main poplar switch: --bsp-cycle-batch
     double      m_resyncThreshold = 0.8; // main poplar switch: --resync-threshold
+    int         m_bspLookahead = 1; // main poplar switch: --bsp-lookahead
+    int         m_bspBroadcastFanout = 0; // main poplar switch: --bsp-broadcast-fanout, 0 is off
+    double      m_lookaheadThreshold = 0.25; // main poplar switch: --lookahead-threshold
     double      m_kahyparImbalance = 0.03; // main poplar switch: --kahypar-imbalance
     int         m_tilesPerIpu       = 1472; // main poplar switch: --tiles-per-ipu
     int         m_ipuMemoryPerTile  = (500 * 1024); // main poplar switch: --ipu-memory-per-tile in bytes
@@ -386,6 +399,8 @@ private:
     int         m_compLimitMembers = 64;  // compiler selection; number of members in struct before make anon array
     int         m_compLimitParens = 240;  // compiler selection; number of nested parens
 
+    string      m_bspCostModel; // main poplar switch: --bsp-cost-model {filename}
+    string      m_bspProfileUse; // main poplar switch: --bsp-profile-use {filename}
     string      m_buildDepBin;  // main switch: --build-dep-bin {filename}
     string      m_exeName;      // main switch: -o {name}
     string      m_flags;        // main switch: -f {name}
@@ -444,6 +459,10 @@ private:
     bool m_fIpuResync = false;      // main switch: -fipu-resync: resynchronize bsp partitions
     bool m_fInterIpuComm = true; // main switch: -fno-inter-ipu-comm: do not optimize inter-ipu communcation
     bool m_fPreMergeIpuPartition = true; // main switch: -fno-pre-merge-ipu-partition: do not partition across devices before merge
+    bool m_fIpuPartitionCache = false; // main switch: -fipu-partition-cache: reuse partitions of the previous run
+    bool m_fIpuExchangePlace = true; // main switch: -fno-ipu-exchange-place: place partitions on IPUs linearly, ignoring their exchange
+    bool m_fIpuFusedCond = true; // main switch: -fno-ipu-fused-cond: evaluate the host request condition in its own superstep
+    bool m_fIpuActivityGate = false; // main switch: -fipu-activity-gate: skip the computation of idle partitions
 
     // clang-format on
 
@@ -494,6 +513,7 @@ public:
     bool available() const VL_MT_SAFE { return m_available; }
     void ccSet();
     void poplarSet();
+    void bspCpuSet();
     void notify();
 
     // ACCESSORS (options)
@@ -504,6 +524,7 @@ public:
     string flags() const { return m_flags; }
     bool systemC() const VL_MT_SAFE { return m_systemC; }
     bool poplar() const VL_MT_SAFE { return m_poplar; }
+    bool bspCpu() const VL_MT_SAFE { return m_bspCpu; }
     bool savable() const VL_MT_SAFE { return m_savable; }
     bool stats() const { return m_stats; }
     bool statsVars() const { return m_statsVars; }
@@ -548,6 +569,8 @@ public:
     bool threadsDpiPure() const { return m_threadsDpiPure; }
     bool threadsDpiUnpure() const { return m_threadsDpiUnpure; }
     bool threadsCoarsen() const { return m_threadsCoarsen; }
+    bool threadsNuma() const { return m_threadsNuma; }
+    bool threadsPersistent() const { return m_threadsPersistent; }
     VOptionBool timing() const { return m_timing; }
     bool trace() const { return m_trace; }
     bool traceCoverage() const { return m_traceCoverage; }
@@ -588,6 +611,7 @@ public:
     int gateStmts() const { return m_gateStmts; }
     int ifDepth() const { return m_ifDepth; }
     int inlineMult() const { return m_inlineMult; }
+    int instances() const { return m_instances; }
     int instrCountDpi() const { return m_instrCountDpi; }
     VOptionBool makeDepend() const { return m_makeDepend; }
     int maxNumWidth() const { return m_maxNumWidth; }
@@ -607,10 +631,16 @@ public:
     int workers(int w) { return m_workers = w; }
     int maxUnpackCopies() const VL_MT_SAFE { return m_maxUnpackCopies; }
     int diffExchangeThreshold() const VL_MT_SAFE { return m_diffExchangeThreshold; }
+    int bspCycleBatch() const VL_MT_SAFE { return m_bspCycleBatch; }
     double resyncThreshold() const VL_MT_SAFE { return m_resyncThreshold; }
+    int bspLookahead() const VL_MT_SAFE { return m_bspLookahead; }
+    int bspBroadcastFanout() const VL_MT_SAFE { return m_bspBroadcastFanout; }
+    double lookaheadThreshold() const VL_MT_SAFE { return m_lookaheadThreshold; }
     double kahyparImbalance() const VL_MT_SAFE { return m_kahyparImbalance; }
     int tilesPerIpu() const VL_MT_SAFE { return m_tilesPerIpu; }
     int ipuMemoryPerTile() const VL_MT_SAFE { return m_ipuMemoryPerTile; }
+    string bspCostModel() const VL_MT_SAFE { return m_bspCostModel; }
+    string bspProfileUse() const VL_MT_SAFE { return m_bspProfileUse; }
     VTimescale timeDefaultPrec() const { return m_timeDefaultPrec; }
     VTimescale timeDefaultUnit() const { return m_timeDefaultUnit; }
     VTimescale timeOverridePrec() const { return m_timeOverridePrec; }
@@ -722,6 +752,10 @@ public:
     bool fIpuResync() const { return m_fIpuResync; }
     bool fInterIpuComm() const { return m_fInterIpuComm; }
     bool fPreMergeIpuPartition() const { return m_fPreMergeIpuPartition; }
+    bool fIpuPartitionCache() const { return m_fIpuPartitionCache; }
+    bool fIpuExchangePlace() const { return m_fIpuExchangePlace; }
+    bool fIpuFusedCond() const { return m_fIpuFusedCond; }
+    bool fIpuActivityGate() const { return m_fIpuActivityGate; }
     string traceClassBase() const { return m_traceFormat.classBase(); }
     string traceClassLang() const { return m_traceFormat.classBase() + (systemC() ? "Sc" : "C"); }
     string traceSourceBase() const { return m_traceFormat.sourceName(); }
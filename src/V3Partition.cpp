@@ -3172,9 +3172,23 @@ static void addThreadStartToExecGraph(AstExecGraph* const execGraphp,
                + ";\n");
 
     const uint32_t last = funcps.size() - 1;
+    // With --threads-persistent the pool workers keep running between evaluations, the
+    // functions are handed to them in a single step and a barrier ends the evaluation
+    const bool persistent = v3Global.opt.threadsPersistent() && last > 0;
+    if (persistent) {
+        addTextStmt("{\nstatic const VlExecFnp __Vfnps[] = {");
+        for (uint32_t i = 0; i < last; ++i) {
+            if (i) addTextStmt(", ");
+            execGraphp->addStmtsp(new AstAddrOfCFunc{fl, funcps.at(i)});
+        }
+        addTextStmt("};\nvlSymsp->__Vm_threadPoolp->runPersistent(__Vfnps, " + cvtToStr(last)
+                    + ", vlSelf, vlSymsp->__Vm_even_cycle__" + tag + ");\n}\n");
+    }
     for (uint32_t i = 0; i <= last; ++i) {
         AstCFunc* const funcp = funcps.at(i);
-        if (i != last) {
+        if (persistent && i != last) {
+            continue;  // Already posted
+        } else if (i != last) {
             // The first N-1 will run on the thread pool.
             addTextStmt("vlSymsp->__Vm_threadPoolp->workerp(" + cvtToStr(i) + ")->addTask(");
             execGraphp->addStmtsp(new AstAddrOfCFunc{fl, funcp});
@@ -3189,11 +3203,59 @@ static void addThreadStartToExecGraph(AstExecGraph* const execGraphp,
         }
     }
 
-    addStrStmt("vlSelf->__Vm_mtaskstate_final__" + tag
-               + ".waitUntilUpstreamDone(vlSymsp->__Vm_even_cycle__" + tag + ");\n");
+    if (persistent) {
+        addStrStmt("vlSymsp->__Vm_threadPoolp->waitPersistent();\n");
+    } else {
+        addStrStmt("vlSelf->__Vm_mtaskstate_final__" + tag
+                   + ".waitUntilUpstreamDone(vlSymsp->__Vm_even_cycle__" + tag + ");\n");
+    }
 }
 
-static void implementExecGraph(AstExecGraph* const execGraphp) {
+//######################################################################
+// PartWriterThreads
+
+// Find the thread that writes each variable the most.
+// Writes are counted in the code of the thread functions and the functions
+// they call. Threads are numbered as the workers of VlThreadPool, the thread
+// calling eval, which runs the last thread function, is 'threads - 1'. The pool
+// may have more workers at run time, so V3EmitCSyms emits that thread as
+// VlThreadPool::MAIN_THREAD.
+class PartWriterThreads final {
+    // MEMBERS
+    std::unordered_map<AstVar*, std::vector<uint32_t>> m_writes;  // Number of writes by thread
+
+public:
+    // METHODS
+    void addThread(uint32_t thread, const AstCFunc* funcp) {
+        std::unordered_set<const AstCFunc*> visited{funcp};
+        std::vector<const AstCFunc*> stack{funcp};
+        while (!stack.empty()) {
+            const AstCFunc* const currp = stack.back();
+            stack.pop_back();
+            currp->foreach([&](const AstNode* nodep) {
+                if (const AstNodeVarRef* const refp = VN_CAST(nodep, NodeVarRef)) {
+                    if (!refp->access().isWriteOrRW()) return;
+                    std::vector<uint32_t>& writes = m_writes[refp->varp()];
+                    writes.resize(v3Global.opt.threads());
+                    ++writes.at(thread);
+                } else if (const AstNodeCCall* const callp = VN_CAST(nodep, NodeCCall)) {
+                    if (visited.insert(callp->funcp()).second) stack.push_back(callp->funcp());
+                }
+            });
+        }
+    }
+    // Mark each variable with its writer thread, ties go to the lowest thread
+    void apply() {
+        for (const auto& pair : m_writes) {
+            const std::vector<uint32_t>& writes = pair.second;
+            const auto it = std::max_element(writes.begin(), writes.end());
+            pair.first->writerThread(static_cast<int>(it - writes.begin()));
+        }
+    }
+};
+
+static void implementExecGraph(AstExecGraph* const execGraphp,
+                               PartWriterThreads& writerThreads) {
     // Nothing to be done if there are no MTasks in the graph at all.
     if (execGraphp->depGraphp()->empty()) return;
 
@@ -3208,10 +3270,17 @@ static void implementExecGraph(AstExecGraph* const execGraphp) {
 
     // Start the thread functions at the point this AstExecGraph is located in the tree.
     addThreadStartToExecGraph(execGraphp, funcps);
+
+    // Find the writer thread of each variable, for V3VariableOrder and --threads-numa
+    const uint32_t last = funcps.size() - 1;
+    for (uint32_t i = 0; i <= last; ++i) {
+        writerThreads.addThread(i == last ? v3Global.opt.threads() - 1 : i, funcps.at(i));
+    }
 }
 
 void V3Partition::finalize(AstNetlist* netlistp) {
     // Called by Verilator top stage
+    PartWriterThreads writerThreads;
     netlistp->topModulep()->foreach([&](AstExecGraph* execGraphp) {
         // Back in V3Order, we partitioned mtasks using provisional cost
         // estimates. However, V3Order precedes some optimizations (notably
@@ -3222,8 +3291,9 @@ void V3Partition::finalize(AstNetlist* netlistp) {
         finalizeCosts(execGraphp->depGraphp());
 
         // Replace the graph body with its multi-threaded implementation.
-        implementExecGraph(execGraphp);
+        implementExecGraph(execGraphp, writerThreads);
     });
+    writerThreads.apply();
 }
 
 void V3Partition::selfTest() {
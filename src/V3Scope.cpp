@@ -19,6 +19,9 @@
 //              SCOPE
 //                      {all blocked statements}
 //
+//      With --instances, tag the $finish and plusargs under each
+//      wrapped copy of the top with the number of the copy
+//
 //*************************************************************************
 
 #include "config_build.h"
@@ -59,6 +62,9 @@ private:
     AstCell* m_aboveCellp = nullptr;  // Cell that instantiates this module
     AstScope* m_aboveScopep = nullptr;  // Scope that instantiates this scope
     AstClocking* m_clockingp = nullptr;  // Current clocking block
+    int m_instance = -1;  // Instance of --instances the scope belongs to, or -1
+
+    std::unordered_map<AstNodeModule*, int> m_topInstances;  // Wrapped copies of each top
 
     std::unordered_map<AstNodeModule*, AstScope*> m_packageScopes;  // Scopes for each package
     VarScopeMap m_varScopes;  // Varscopes created for each scope and var
@@ -121,11 +127,17 @@ private:
                 // which is "above" in this code, but later in code execution order
                 VL_RESTORER(m_aboveCellp);
                 VL_RESTORER(m_aboveScopep);
+                VL_RESTORER(m_instance);
                 {
                     m_aboveCellp = cellp;
                     m_aboveScopep = m_scopep;
                     AstNodeModule* const modp = cellp->modp();
                     UASSERT_OBJ(modp, cellp, "Unlinked mod");
+                    if (nodep->isTop() && v3Global.opt.instances() > 1
+                        && !VN_IS(modp, Package) && !VN_IS(modp, Iface)) {
+                        // V3LinkLevel wraps the copies of a top in the order of instances
+                        m_instance = m_topInstances[modp]++;
+                    }
                     iterate(modp);  // Recursive call to visit(AstNodeModule)
                     if (VN_IS(modp, Iface)) {
                         // Remember newly created scope
@@ -324,6 +336,18 @@ private:
         if (afterp) nodep->addScopeEntrp(afterp);
         iterateChildren(nodep);
     }
+    void visit(AstTestPlusArgs* nodep) override {
+        nodep->instance(m_instance);
+        iterateChildren(nodep);
+    }
+    void visit(AstValuePlusArgs* nodep) override {
+        nodep->instance(m_instance);
+        iterateChildren(nodep);
+    }
+    void visit(AstFinish* nodep) override {
+        nodep->instance(m_instance);
+        iterateChildren(nodep);
+    }
     void visit(AstScope* nodep) override {
         // Scope that was made by this module for different cell;
         // Want to ignore blocks under it, so just do nothing
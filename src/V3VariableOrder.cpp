@@ -29,9 +29,13 @@
 #include "V3AstUserAllocator.h"
 #include "V3EmitCBase.h"
 #include "V3Global.h"
+#include "V3Stats.h"
 #include "V3TSP.h"
 
 #include <algorithm>
+#include <limits>
+#include <map>
+#include <set>
 #include <vector>
 
 VL_DEFINE_DEBUG_FUNCTIONS;
@@ -90,6 +94,10 @@ class VariableOrder final {
 
     AstUser1Allocator<AstVar, VarAttributes> m_attributes;  // Attributes used for sorting
 
+    // Cache lines written by more than one thread, counted per module, not per instance
+    uint32_t m_sharedLinesBefore = 0;  // In the previous order, by MTask affinity
+    uint32_t m_sharedLinesAfter = 0;  // In the final order
+
     //######################################################################
 
     // Simple sort
@@ -144,6 +152,71 @@ class VariableOrder final {
         sortAndAppend(m2v[MTaskIdSet()]);
     }
 
+    // Group of a variable in thread order, see threadSortVars
+    static int threadGroup(const AstVar* varp) {
+        // Not a member of the module instances, so not laid out
+        if (varp->isStatic() || varp->isParam()
+            || !(varp->isIO() || varp->isSignal() || varp->isClassMember() || varp->isTemp())) {
+            return std::numeric_limits<int>::max();
+        }
+        // Mtask states are written by every thread, keep them apart
+        if (varp->basicp() && varp->basicp()->keyword() == VBasicDTypeKwd::MTASKSTATE) {
+            return -1;
+        }
+        if (varp->writerThread() >= 0) return varp->writerThread();
+        // Not written by the mtasks, these are mostly read and shared by all threads
+        return v3Global.opt.threads();
+    }
+
+    // Sort by writer thread first, from V3Partition, then the same as tspSortVars.
+    // Each group of variables starts a new cache line, so that no two threads write
+    // the same line.
+    void threadSortVars(std::vector<AstVar*>& varps) {
+        std::map<int, std::vector<AstVar*>> g2v;
+        for (AstVar* const varp : varps) g2v[threadGroup(varp)].push_back(varp);
+
+        varps.clear();
+        const bool align = g2v.size() - g2v.count(std::numeric_limits<int>::max()) > 1;
+        for (auto& pair : g2v) {
+            tspSortVars(pair.second);
+            if (align && pair.first != std::numeric_limits<int>::max()) {
+                pair.second.front()->alignCacheLine(true);
+            }
+            for (AstVar* const varp : pair.second) varps.push_back(varp);
+        }
+    }
+
+    // Estimate the number of cache lines written by more than one thread, laying out the
+    // variables in order, as the C++ compiler would with C++17. Before C++17 each aligned
+    // variable follows a line of padding instead, which shares no more lines, see
+    // VL_CACHE_LINE_PAD
+    static uint32_t sharedCacheLines(const std::vector<AstVar*>& varps) {
+        constexpr uint32_t lineBytes = 64;  // As VL_CACHE_LINE_BYTES
+        std::map<uint32_t, std::set<int>> writers;  // Cache line -> writer threads
+        uint32_t offset = 0;
+        for (const AstVar* const varp : varps) {
+            if (threadGroup(varp) == std::numeric_limits<int>::max()) continue;
+            const AstNodeDType* const dtypep = varp->dtypeSkipRefp();
+            const uint32_t bytes = std::max(dtypep->widthTotalBytes(), 1);
+            const uint32_t alignBytes = varp->alignCacheLine()
+                                            ? lineBytes
+                                            : std::min(std::max(dtypep->widthAlignBytes(), 1), 8);
+            offset = (offset + alignBytes - 1) / alignBytes * alignBytes;
+            if (varp->writerThread() >= 0) {
+                for (uint32_t line = offset / lineBytes; line <= (offset + bytes - 1) / lineBytes;
+                     ++line) {
+                    writers[line].insert(varp->writerThread());
+                }
+            }
+            offset += bytes;
+        }
+        uint32_t shared = 0;
+        for (const auto& pair : writers) {
+            if (pair.second.size() > 1) ++shared;
+        }
+        return shared;
+    }
+
     void orderModuleVars(AstNodeModule* modp) {
         std::vector<AstVar*> varps;
 
@@ -177,8 +250,14 @@ class VariableOrder final {
             // Sort variables
             if (!v3Global.opt.mtasks()) {
                 simpleSortVars(varps);
-            } else {
+            } else if (VN_IS(modp, Class)) {
                 tspSortVars(varps);
+            } else {
+                std::vector<AstVar*> tspVarps{varps};
+                tspSortVars(tspVarps);
+                m_sharedLinesBefore += sharedCacheLines(tspVarps);
+                threadSortVars(varps);
+                m_sharedLinesAfter += sharedCacheLines(varps);
             }
 
             // Insert them back under the module, in the new order, but at
@@ -195,7 +274,9 @@ class VariableOrder final {
     }
 
 public:
-    static void processModule(AstNodeModule* modp) { VariableOrder{}.orderModuleVars(modp); }
+    void processModule(AstNodeModule* modp) { orderModuleVars(modp); }
+    uint32_t sharedLinesBefore() const { return m_sharedLinesBefore; }
+    uint32_t sharedLinesAfter() const { return m_sharedLinesAfter; }
 };
 
 //######################################################################
@@ -203,9 +284,16 @@ public:
 
 void V3VariableOrder::orderAll() {
     UINFO(2, __FUNCTION__ << ": " << endl);
+    VariableOrder order;
     for (AstNodeModule* modp = v3Global.rootp()->modulesp(); modp;
          modp = VN_AS(modp->nextp(), NodeModule)) {
-        VariableOrder::processModule(modp);
+        order.processModule(modp);
+    }
+    if (v3Global.opt.mtasks()) {
+        V3Stats::addStat("Variable order, false shared cache lines before",
+                         order.sharedLinesBefore());
+        V3Stats::addStat("Variable order, false shared cache lines after",
+                         order.sharedLinesAfter());
     }
     V3Global::dumpCheckGlobalTree("variableorder", 0, dumpTree() >= 3);
 }
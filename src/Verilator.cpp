@@ -22,6 +22,7 @@
 #include "V3Begin.h"
 #include "V3Branch.h"
 #include "V3Broken.h"
+#include "V3BspActivity.h"
 #include "V3BspDifferential.h"
 #include "V3BspPoplarProgram.h"
 #include "V3BspSched.h"
@@ -375,7 +376,10 @@ static void process() {
         // so should be optionally enabled for BSP only
 
         // Create tracing sample points, before we start eliminating signals
-        if (v3Global.opt.trace()) V3TraceDecl::traceDeclAll(v3Global.rootp());
+        // (BSP classes record their own changes, see V3BspTrace)
+        if (v3Global.opt.trace() && !v3Global.opt.poplar()) {
+            V3TraceDecl::traceDeclAll(v3Global.rootp());
+        }
 
         // Convert forceable signals, process force/release statements.
         // After V3TraceDecl so we don't trace additional signals inserted to implement forcing.
@@ -457,18 +461,24 @@ static void process() {
         // Note past this point, we presume traced variables won't move between CFuncs
         // (It's OK if untraced temporaries move around, or vars
         // "effectively" activate the same way.)
-        if (v3Global.opt.trace()) V3Trace::traceAll(v3Global.rootp());
+        if (v3Global.opt.trace() && !v3Global.opt.poplar()) V3Trace::traceAll(v3Global.rootp());
 
         if (v3Global.opt.stats()) V3Stats::statsStageAll(v3Global.rootp(), "Scoped");
     }
 
     if (v3Global.opt.poplar()) {
         // requires scopes
-        if (v3Global.opt.fIpuDiffExchnage()) {
-            // optimize the exchange of unpack variables by only sending the diffs
-            // use --diff-exchange-threshold to tune
+        if (v3Global.opt.fIpuDiffExchnage() && v3Global.bspLookahead() == 1) {
+            // optimize the exchange of unpack and wide packed variables by only sending the diffs
+            // use --diff-exchange-threshold to tune. A reader would miss the diffs of the
+            // cycles the lookahead does not exchange, see V3BspLookahead.
             V3BspDifferential::differentialUnpack(v3Global.rootp());
         }
+        if (v3Global.opt.fIpuActivityGate()) {
+            // skip the computation of partitions whose inputs and state did not change,
+            // after the differential exchange so its replays are gated too
+            V3BspActivity::gateAll(v3Global.rootp());
+        }
 
         // create a poplar program
         V3BspPoplarProgram::createProgram(v3Global.rootp());
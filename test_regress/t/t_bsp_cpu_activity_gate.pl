@@ -0,0 +1,54 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(
+    simulator => 1,
+    iv => 1
+);
+
+# Output of the default flow, computing every partition in every cycle, without
+# the driver's "- " lines
+my $default = "$Self->{obj_dir}/default.log";
+
+compile(
+    verilator_flags2 => ["--bsp-cpu"],
+    make_main => 0
+);
+
+execute(
+    check_finished => 1,
+    logfile => $default
+);
+
+write_wholefile("$default.out", join("", grep { !/^- / } split(/^/, file_contents($default))));
+
+compile(
+    verilator_flags2 => ["--bsp-cpu -fipu-activity-gate --stats"],
+    make_main => 0
+);
+
+if ($Self->{vlt_all}) {
+    file_grep($Self->{stats}, qr/ipu activity tracked classes\s+([1-9]\d*)/i);
+    file_grep($Self->{stats}, qr/ipu activity gated classes\s+([1-9]\d*)/i);
+}
+
+execute(
+    check_finished => 1,
+    expect_filename => "$default.out"
+);
+
+if ($Self->{vlt_all}) {
+    # The lanes are idle for 15 of every 16 cycles
+    my @logs = glob_all("$Self->{obj_dir}/*_runtime.log");
+    file_grep_any(\@logs, qr/activity skips: ([1-9]\d*)/i);
+}
+
+ok(1);
+1;
@@ -0,0 +1,37 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2023 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (
+    input wire clk
+);
+
+    reg [31:0] cyc = 32'h0;
+    always @(posedge clk) cyc <= cyc + 1;
+
+    // Changes once every 16 cycles, the lanes below are idle in between
+    reg [3:0] phase = 4'h0;
+    always @(posedge clk) phase <= cyc[7:4];
+
+    genvar i;
+    generate
+        for (i = 0; i < 4; i = i + 1) begin : lane
+            reg [31:0] acc = 32'h0;
+            always @(posedge clk) acc <= {28'h0, phase} * (i + 3);
+        end
+    endgenerate
+
+    always @(posedge clk) begin
+        if (cyc[3:0] == 4'h0) begin
+            $display("@%0d %0d %0d %0d %0d", cyc, lane[0].acc, lane[1].acc, lane[2].acc,
+                     lane[3].acc);
+        end
+        if (cyc == 100) begin
+            $write("*-* All Finished *-*\n");
+            $finish;
+        end
+    end
+
+endmodule
@@ -0,0 +1,42 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2023 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (
+    input wire clk
+);
+
+    reg [31:0] cyc = 32'h0;
+    always @(posedge clk) cyc <= cyc + 1;
+
+    // Read by every lane, so it is broadcast to all of their tiles
+    reg [31:0] shared = 32'h0;
+    always @(posedge clk) shared <= cyc * 32'h9e3779b9;
+
+    genvar i;
+    generate
+        for (i = 0; i < 16; i = i + 1) begin : lane
+            reg [31:0] acc = 32'h0;
+            always @(posedge clk) acc <= (acc << 1) + (shared ^ i);
+        end
+    endgenerate
+
+    reg [31:0] sum;
+    always @* begin
+        sum = lane[0].acc ^ lane[1].acc ^ lane[2].acc ^ lane[3].acc;
+        sum = sum ^ lane[4].acc ^ lane[5].acc ^ lane[6].acc ^ lane[7].acc;
+        sum = sum ^ lane[8].acc ^ lane[9].acc ^ lane[10].acc ^ lane[11].acc;
+        sum = sum ^ lane[12].acc ^ lane[13].acc ^ lane[14].acc ^ lane[15].acc;
+    end
+
+    always @(posedge clk) begin
+        $display("@%0d sum = 0x%x", cyc, sum);
+        if (cyc == 20) begin
+            $write("*-* All Finished *-*\n");
+            $finish;
+        end
+    end
+
+endmodule
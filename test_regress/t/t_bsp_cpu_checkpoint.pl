@@ -0,0 +1,57 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+sub output_lines {
+    my $filename = shift;
+    return grep { !/^- / } split(/^/, file_contents($filename));
+}
+
+my $checkpoint = "$Self->{obj_dir}/boot.ckpt";
+
+compile(
+    verilator_flags2 => ["--bsp-cpu"],
+    make_main => 0
+);
+
+# The whole simulation in one run
+execute(
+    check_finished => 1,
+    logfile => "$Self->{obj_dir}/full.log"
+);
+
+# Stop early and save
+execute(
+    all_run_flags => ["+boot", "+checkpoint+save+$checkpoint"],
+    logfile => "$Self->{obj_dir}/boot.log"
+);
+
+# Go on from the checkpoint, the plusargs of the boot run are restored as well
+execute(
+    check_finished => 1,
+    all_run_flags => ["+checkpoint+restore+$checkpoint"],
+    logfile => "$Self->{obj_dir}/restore.log"
+);
+
+if (!$Self->errors && !$Self->skips) {
+    my @full = output_lines("$Self->{obj_dir}/full.log");
+    my @restored = output_lines("$Self->{obj_dir}/restore.log");
+    my ($first) = ($restored[0] || "") =~ /^\[(\d+)\]/;
+    error("Restored run did not start after the checkpoint: $restored[0]")
+        if !defined $first || $first <= 10;
+    # The restored run has to finish exactly like the whole simulation
+    error("Restored run differs from the end of the whole simulation")
+        if @restored > @full
+        || join("", @restored) ne join("", @full[$#full - $#restored .. $#full]);
+}
+
+ok(1);
+1;
@@ -0,0 +1,31 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// With +boot the simulation stops early, so a run restored from its
+// checkpoint goes on from there.
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2023 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (
+    input wire clk
+);
+
+    reg [31:0] cnt = 32'h0;
+    reg [63:0] acc = 64'h1;
+    reg [31:0] other = 32'h0;
+
+    always @(posedge clk) cnt <= cnt + 1;
+    always @(posedge clk) acc <= acc * 64'd6364136223846793005 + {32'h0, cnt};
+    always @(posedge clk) other <= other ^ acc[63:32];
+
+    always @(posedge clk) begin
+        $display("[%0d] acc=%x other=%x", cnt, acc, other);
+        if ($test$plusargs("boot") && cnt == 10) $finish;
+        if (cnt == 30) begin
+            $write("*-* All Finished *-*\n");
+            $finish;
+        end
+    end
+
+endmodule
@@ -0,0 +1,18 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2023 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (
+    input wire clk_a,
+    input wire clk_b
+);
+
+    reg [31:0] cnt_a = 32'h0;
+    reg [31:0] cnt_b = 32'h0;
+
+    always @(posedge clk_a) cnt_a <= cnt_a + 1;
+    always @(posedge clk_b) cnt_b <= cnt_b + cnt_a;
+
+endmodule
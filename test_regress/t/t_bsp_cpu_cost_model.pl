@@ -0,0 +1,34 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(
+    simulator => 1,
+    iv => 1
+);
+
+top_filename("t/t_bsp_cpu_partition_cache.v");
+
+# Every 32-bit add and every multiply costs 100000 cycles in the table, which
+# the built-in model never gets close to on this design
+compile(
+    verilator_flags2 => ["--bsp-cpu --bsp-cost-model t/t_bsp_cpu_cost_model.txt --stats"],
+    make_main => 0
+);
+
+if ($Self->{vlt_all}) {
+    file_grep($Self->{stats}, qr/BspMerger, sequential cost\s+\d{6,}/i);
+}
+
+execute(
+    check_finished => 1
+);
+
+ok(1);
+1;
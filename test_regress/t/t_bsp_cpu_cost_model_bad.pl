@@ -0,0 +1,25 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+top_filename("t/t_bsp_cpu_partition_cache.v");
+
+compile(
+    verilator_flags2 => ["--bsp-cpu --bsp-cost-model t/t_bsp_cpu_cost_model_bad.txt"],
+    make_main => 0,
+    fails => 1
+);
+
+file_grep("$Self->{obj_dir}/vlt_compile.log",
+          qr/Malformed --bsp-cost-model entry at t\/t_bsp_cpu_cost_model_bad.txt:3/);
+
+ok(1);
+1;
@@ -0,0 +1,53 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(
+    simulator => 1,
+    iv => 1
+);
+
+# Output of the default flow, checking host requests every cycle, without the
+# driver's "- " lines
+my $default = "$Self->{obj_dir}/default.log";
+
+compile(
+    verilator_flags2 => ["--bsp-cpu"],
+    make_main => 0
+);
+
+execute(
+    check_finished => 1,
+    logfile => $default
+);
+
+write_wholefile("$default.out", join("", grep { !/^- / } split(/^/, file_contents($default))));
+
+compile(
+    verilator_flags2 => ["--bsp-cpu --bsp-cycle-batch 8 --stats"],
+    make_main => 0
+);
+
+if ($Self->{vlt_all}) {
+    file_grep($Self->{stats}, qr/BspDpi, cycles per host condition check\s+8/i);
+}
+
+execute(
+    check_finished => 1,
+    expect_filename => "$default.out"
+);
+
+if ($Self->{vlt_all}) {
+    # every host request raised within a batch rolls it back
+    my @logs = glob_all("$Self->{obj_dir}/*_runtime.log");
+    file_grep_any(\@logs, qr/batch replays: ([1-9]\d*)/i);
+}
+
+ok(1);
+1;
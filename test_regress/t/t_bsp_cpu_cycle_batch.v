@@ -0,0 +1,37 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2023 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (
+    input wire clk
+);
+
+    reg [31:0] cyc = 32'h0;
+    always @(posedge clk) cyc <= cyc + 1;
+
+    // State in several partitions that a rolled back batch has to restore
+    genvar i;
+    generate
+        for (i = 0; i < 4; i = i + 1) begin : lane
+            reg [31:0] acc = 32'h0;
+            always @(posedge clk) acc <= (acc * 32'h5) + cyc + i;
+        end
+    endgenerate
+
+    // Host requests at irregular cycles, most in the middle of a batch of 8
+    wire print = (cyc == 3) || (cyc == 13) || (cyc == 14) || (cyc == 27) || (cyc == 40);
+
+    always @(posedge clk) begin
+        if (print) begin
+            $display("@%0d acc = 0x%x 0x%x 0x%x 0x%x", cyc, lane[0].acc, lane[1].acc,
+                     lane[2].acc, lane[3].acc);
+        end
+        if (cyc == 50) begin
+            $write("*-* All Finished *-*\n");
+            $finish;
+        end
+    end
+
+endmodule
@@ -0,0 +1,41 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+# $random values of the run checking host requests every cycle, without the
+# driver's "- " lines
+my $default = "$Self->{obj_dir}/default.log";
+
+compile(
+    verilator_flags2 => ["--bsp-cpu"],
+    make_main => 0
+);
+
+execute(
+    check_finished => 1,
+    logfile => $default
+);
+
+write_wholefile("$default.out", join("", grep { !/^- / } split(/^/, file_contents($default))));
+
+# A replayed batch restores the PRNG state with the rest of the state
+compile(
+    verilator_flags2 => ["--bsp-cpu --bsp-cycle-batch 8"],
+    make_main => 0
+);
+
+execute(
+    check_finished => 1,
+    expect_filename => "$default.out"
+);
+
+ok(1);
+1;
@@ -0,0 +1,30 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2023.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+
+   // Drawn every cycle but displayed only now and then, so the batch that raised a
+   // display is rolled back and replayed, and has to draw the same values again
+   logic [31:0] ra = 0;
+   logic [31:0] rb = 0;
+   always @(posedge clk) ra <= ra ^ $random;
+   always @(posedge clk) rb <= rb + $random;
+
+   always @(posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc % 5 == 3) $display("cyc=%0d ra=%x rb=%x", cyc, ra, rb);
+      if (cyc == 40) begin
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
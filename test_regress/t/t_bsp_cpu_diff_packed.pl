@@ -0,0 +1,54 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(
+    simulator => 1,
+    iv => 1
+);
+
+# Output with full copies of every exchanged variable, without the driver's "- "
+# lines
+my $default = "$Self->{obj_dir}/default.log";
+
+compile(
+    verilator_flags2 => ["--bsp-cpu -fno-ipu-diff-exchange --stats"],
+    make_main => 0
+);
+
+if ($Self->{vlt_all}) {
+    file_grep_not($Self->{stats}, qr/ipu differential exchanges applied/i);
+}
+
+execute(
+    check_finished => 1,
+    logfile => $default
+);
+
+write_wholefile("$default.out", join("", grep { !/^- / } split(/^/, file_contents($default))));
+
+compile(
+    verilator_flags2 => ["--bsp-cpu --stats"],
+    make_main => 0
+);
+
+if ($Self->{vlt_all}) {
+    # the partial writes of ring survive V3Delayed
+    file_grep($Self->{stats}, qr/ipu differential exchanges applied\s+([1-9]\d*)/i);
+    # keyed would send the 32 words of key to save 16
+    file_grep($Self->{stats}, qr/ipu differential exchanges applied to packed\s+(\d+)/i, 1);
+}
+
+execute(
+    check_finished => 1,
+    expect_filename => "$default.out"
+);
+
+ok(1);
+1;
@@ -0,0 +1,40 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2023 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (
+    input wire clk
+);
+
+    reg [31:0] cyc = 32'h0;
+    always @(posedge clk) cyc <= cyc + 1;
+
+    // Wide packed variable only written through 32-bit slices, so only the written
+    // word, the variables of its offset and an enable bit need to be exchanged
+    reg [511:0] ring = 512'h0;
+    always @(posedge clk) ring[cyc[3:0] * 32 +: 32] <= cyc * 32'h9e3779b9;
+
+    // Same, but the offset reads a variable wider than the written one, so sending
+    // the whole variable is cheaper
+    reg [1023:0] key = 1024'h0;
+    always @(posedge clk) key <= {key[991:0], cyc};
+    reg [511:0] keyed = 512'h0;
+    always @(posedge clk) keyed[key[1023:1020] * 32 +: 32] <= cyc ^ 32'h5a5a5a5a;
+
+    // Read in other partitions
+    reg [31:0] ringSum = 32'h0;
+    always @(posedge clk) ringSum <= ringSum ^ ring[31:0] ^ ring[287:256] ^ ring[511:480];
+    reg [31:0] keyedSum = 32'h0;
+    always @(posedge clk) keyedSum <= keyedSum + keyed[31:0] + keyed[159:128] + keyed[511:480];
+
+    always @(posedge clk) begin
+        $display("@%0d ring = 0x%x keyed = 0x%x", cyc, ringSum, keyedSum);
+        if (cyc == 40) begin
+            $write("*-* All Finished *-*\n");
+            $finish;
+        end
+    end
+
+endmodule
@@ -0,0 +1,55 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+# Spread the pairs over several IPUs of four tiles, one of which is reserved
+my $flags = "--bsp-cpu --tiles 16 --tiles-per-ipu 4 --workers 1 --stats";
+
+# Output of the linear placement, without the driver's "- " lines
+my $linear = "$Self->{obj_dir}/linear.log";
+
+compile(
+    verilator_flags2 => ["$flags -fno-ipu-exchange-place"],
+    make_main => 0
+);
+
+file_grep_not($Self->{stats}, qr/BspPlace, inter-IPU exchange words/i);
+
+execute(
+    check_finished => 1,
+    logfile => $linear
+);
+
+write_wholefile("$linear.out", join("", grep { !/^- / } split(/^/, file_contents($linear))));
+
+compile(
+    verilator_flags2 => [$flags],
+    make_main => 0
+);
+
+my $stats = file_contents($Self->{stats});
+my ($linearCut) = $stats =~ /BspPlace, inter-IPU exchange words, linear\s+(\d+)/i;
+my ($refinedCut) = $stats =~ /BspPlace, inter-IPU exchange words, refined\s+(\d+)/i;
+if (!defined $linearCut || !defined $refinedCut) {
+    error("Missing exchange placement stats in $Self->{stats}");
+} elsif (!$linearCut) {
+    error("The partitions do not span several IPUs");
+} elsif ($refinedCut > $linearCut) {
+    error("Exchange placement increased the inter-IPU words: $linearCut -> $refinedCut");
+}
+
+execute(
+    check_finished => 1,
+    expect_filename => "$linear.out"
+);
+
+ok(1);
+1;
@@ -0,0 +1,40 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2023 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (
+    input wire clk
+);
+
+    reg [31:0] cyc = 32'h0;
+    always @(posedge clk) cyc <= cyc + 1;
+
+    // Each pair exchanges wide values every cycle but nothing with the other pairs, so
+    // the placement should keep the two halves of a pair on the same IPU
+    genvar i;
+    generate
+        for (i = 0; i < 6; i = i + 1) begin : pair
+            reg [255:0] ping = 256'h0;
+            reg [255:0] pong = 256'h0;
+            always @(posedge clk) ping <= {pong[254:0], pong[255]} ^ {8{cyc ^ i}};
+            always @(posedge clk) pong <= {ping[0], ping[255:1]} + {8{cyc + i}};
+        end
+    endgenerate
+
+    reg [31:0] sum;
+    always @* begin
+        sum = pair[0].ping[31:0] ^ pair[1].ping[63:32] ^ pair[2].ping[95:64];
+        sum = sum ^ pair[3].pong[31:0] ^ pair[4].pong[63:32] ^ pair[5].pong[95:64];
+    end
+
+    always @(posedge clk) begin
+        $display("@%0d sum = 0x%x", cyc, sum);
+        if (cyc == 20) begin
+            $write("*-* All Finished *-*\n");
+            $finish;
+        end
+    end
+
+endmodule
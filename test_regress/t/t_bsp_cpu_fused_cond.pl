@@ -0,0 +1,51 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(
+    simulator => 1,
+    iv => 1
+);
+
+# Output with the host request condition in a superstep of its own, without the
+# driver's "- " lines
+my $default = "$Self->{obj_dir}/default.log";
+
+compile(
+    verilator_flags2 => ["--bsp-cpu -fno-ipu-fused-cond --stats"],
+    make_main => 0
+);
+
+if ($Self->{vlt_all}) {
+    file_grep($Self->{stats}, qr/BspDpi, host condition fused with the workload\s+0/i);
+}
+
+execute(
+    check_finished => 1,
+    logfile => $default
+);
+
+write_wholefile("$default.out", join("", grep { !/^- / } split(/^/, file_contents($default))));
+
+compile(
+    verilator_flags2 => ["--bsp-cpu --stats"],
+    make_main => 0
+);
+
+if ($Self->{vlt_all}) {
+    file_grep($Self->{stats}, qr/BspDpi, host condition fused with the workload\s+1/i);
+}
+
+execute(
+    check_finished => 1,
+    expect_filename => "$default.out"
+);
+
+ok(1);
+1;
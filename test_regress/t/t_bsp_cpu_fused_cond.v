@@ -0,0 +1,30 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2023 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (
+    input wire clk
+);
+
+    reg [31:0] cyc = 32'h0;
+    always @(posedge clk) cyc <= cyc + 1;
+
+    reg [15:0] lfsr = 16'hace1;
+    always @(posedge clk) lfsr <= {lfsr[14:0], lfsr[15] ^ lfsr[13] ^ lfsr[12] ^ lfsr[10]};
+
+    reg [31:0] acc = 32'h0;
+    always @(posedge clk) acc <= acc + {16'h0, lfsr};
+
+    // The host is only needed when the LFSR hits a pattern, and only prints, so the
+    // condition can be evaluated along with the workload of the next cycle
+    always @(posedge clk) begin
+        if (lfsr[3:0] == 4'h5) $display("@%0d lfsr = 0x%x acc = 0x%x", cyc, lfsr, acc);
+        if (cyc == 100) begin
+            $write("*-* All Finished *-*\n");
+            $finish;
+        end
+    end
+
+endmodule
@@ -0,0 +1,33 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+top_filename("t/t_instances.v");
+
+# The copies share the primary clock, so the BSP flow accepts them
+compile(
+    verilator_flags2 => ["--bsp-cpu --instances 2"],
+    make_main => 0
+);
+
+execute(
+    check_finished => 1,
+    all_run_flags => ["+limit=3", "+1:limit=6"],
+);
+
+# Each copy reads its own plusargs, and the simulation only finishes once the
+# later copy finished too
+file_grep($Self->{run_log_filename}, qr/^limit=3 cyc=3\n.*^limit=6 cyc=6$/ms);
+file_grep($Self->{run_log_filename},
+          qr/\$finish of instance 0\n.*\$finish of instance 1\n.*\$finish$/ms);
+
+ok(1);
+1;
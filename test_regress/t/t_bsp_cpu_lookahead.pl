@@ -0,0 +1,55 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(
+    simulator => 1,
+    iv => 1
+);
+
+# Output of the default flow, exchanging every cycle, without the driver's "- "
+# lines
+my $default = "$Self->{obj_dir}/default.log";
+
+compile(
+    verilator_flags2 => ["--bsp-cpu --bsp-cycle-batch 8 --stats"],
+    make_main => 0
+);
+
+if ($Self->{vlt_all}) {
+    file_grep_not($Self->{stats}, qr/BspLookahead, replicated vertices/i);
+}
+
+execute(
+    check_finished => 1,
+    logfile => $default
+);
+
+write_wholefile("$default.out", join("", grep { !/^- / } split(/^/, file_contents($default))));
+
+compile(
+    verilator_flags2 => ["--bsp-cpu", "--bsp-cycle-batch 8", "--bsp-lookahead 2",
+                         "--lookahead-threshold 10", "--stats"],
+    make_main => 0
+);
+
+if ($Self->{vlt_all}) {
+    file_grep($Self->{stats}, qr/BspLookahead, replicated vertices\s+([1-9]\d*)/i);
+    file_grep($Self->{stats}, qr/BspLookahead, cycles per exchange\s+(\d+)/i, 2);
+    # differential exchange is on by default, and makes way for the lookahead
+    file_grep_not($Self->{stats}, qr/ipu differential exchanges applied/i);
+}
+
+execute(
+    check_finished => 1,
+    expect_filename => "$default.out"
+);
+
+ok(1);
+1;
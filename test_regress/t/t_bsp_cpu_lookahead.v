@@ -0,0 +1,32 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2023 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (
+    input wire clk
+);
+
+    reg [31:0] cyc = 32'h0;
+    always @(posedge clk) cyc <= cyc + 1;
+
+    // A chain of cheap registers in different partitions, each stage can be replicated
+    // into the next one to compute two cycles between exchanges
+    reg [31:0] stage1 = 32'h0;
+    reg [31:0] stage2 = 32'h0;
+    reg [31:0] stage3 = 32'h0;
+    always @(posedge clk) stage1 <= cyc ^ 32'h1234;
+    always @(posedge clk) stage2 <= stage1 + (stage1 << 3);
+    always @(posedge clk) stage3 <= stage3 + stage2;
+
+    // Host requests every 8 cycles only, so whole batches run without one
+    always @(posedge clk) begin
+        if (cyc[2:0] == 3'h0) $display("@%0d stage3 = 0x%x", cyc, stage3);
+        if (cyc == 40) begin
+            $write("*-* All Finished *-*\n");
+            $finish;
+        end
+    end
+
+endmodule
@@ -0,0 +1,43 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2023 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (
+    input wire clk
+);
+
+    reg [31:0] cyc = 32'h0;
+    always @(posedge clk) cyc <= cyc + 1;
+
+    // Four clusters of lanes that share a wide value within the cluster only, so a
+    // good partition of the fibers over the devices cuts little more than the sum
+    genvar c;
+    genvar i;
+    generate
+        for (c = 0; c < 4; c = c + 1) begin : cluster
+            reg [127:0] shared = 128'h0;
+            always @(posedge clk) shared <= {4{cyc * (c + 3)}};
+            for (i = 0; i < 4; i = i + 1) begin : lane
+                reg [31:0] acc = 32'h0;
+                always @(posedge clk) acc <= acc + shared[i * 32 +: 32];
+            end
+        end
+    endgenerate
+
+    reg [31:0] sum;
+    always @* begin
+        sum = cluster[0].lane[0].acc ^ cluster[0].lane[3].acc ^ cluster[1].lane[1].acc;
+        sum = sum ^ cluster[2].lane[2].acc ^ cluster[3].lane[3].acc;
+    end
+
+    always @(posedge clk) begin
+        $display("@%0d sum = 0x%x", cyc, sum);
+        if (cyc == 20) begin
+            $write("*-* All Finished *-*\n");
+            $finish;
+        end
+    end
+
+endmodule
@@ -0,0 +1,41 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(
+    simulator => 1,
+    iv => 1
+);
+
+# The first build writes the partition cache
+compile(
+    verilator_flags2 => ["--bsp-cpu -fipu-partition-cache --stats"],
+    make_main => 0
+);
+
+execute(
+    check_finished => 1
+);
+
+# The second build finds every fiber of the first one
+compile(
+    verilator_flags2 => ["--bsp-cpu -fipu-partition-cache --stats"],
+    make_main => 0
+);
+
+if ($Self->{vlt_all}) {
+    file_grep($Self->{stats}, qr/BspSched, partition cache fiber misses\s+(\d+)/i, 0);
+}
+
+execute(
+    check_finished => 1
+);
+
+ok(1);
+1;
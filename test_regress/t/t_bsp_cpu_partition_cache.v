@@ -0,0 +1,38 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2023 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (
+    input wire clk
+);
+
+    reg [31:0] cnt = 32'h0;
+    reg [31:0] up = 32'h0;
+    reg [31:0] down = 32'h0;
+    reg [31:0] prod;
+    reg [31:0] mix;
+
+    always @(posedge clk) cnt <= cnt + 1;
+
+    // prod is dead after this block, so its definition is a sink of both fibers
+    // that replicate the block to compute mix
+    always @* begin
+        prod = cnt * 32'h3;
+        mix = prod ^ 32'h5a5a5a5a;
+    end
+
+    always @(posedge clk) up <= up + mix;
+    always @(posedge clk) down <= down - mix;
+
+    always @(posedge clk) begin
+        $display("@%0d up = 0x%x down = 0x%x", cnt, up, down);
+        if (cnt == 8) begin
+            if (up != 32'hd2d2d2a4 || down != 32'h2d2d2d5c) $stop;
+            $write("*-* All Finished *-*\n");
+            $finish;
+        end
+    end
+
+endmodule
@@ -0,0 +1,62 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+my $cache = "$Self->{obj_dir}/$Self->{vm_prefix}__bsp_partitions.dat";
+
+# Placement of each partition in the cache file, keyed by its sorted fiber hashes
+sub placements {
+    my %placement;
+    foreach my $line (split /\n/, file_contents($cache)) {
+        next if $line =~ /^config /;
+        my ($tile, $worker, $cost, @fibers) = split ' ', $line;
+        $placement{join(" ", sort @fibers)} = "$tile $worker";
+    }
+    return %placement;
+}
+
+compile(
+    verilator_flags2 => ["--bsp-cpu -fipu-partition-cache --stats"],
+    make_main => 0
+);
+
+execute(
+    check_finished => 1
+);
+
+my %before = placements();
+
+# Recompile with lane 0 edited
+compile(
+    verilator_flags2 => ["--bsp-cpu -fipu-partition-cache --stats +define+TEST_EDIT"],
+    make_main => 0
+);
+
+file_grep($Self->{stats}, qr/BspSched, partition cache fiber hits\s+[1-9]/i);
+file_grep($Self->{stats}, qr/BspSched, partition cache placements kept\s+[1-9]/i);
+
+execute(
+    check_finished => 1
+);
+
+my %after = placements();
+my $unchanged = 0;
+foreach my $fibers (sort keys %after) {
+    next if !defined $before{$fibers};
+    ++$unchanged;
+    if ($before{$fibers} ne $after{$fibers}) {
+        error("Unchanged partition moved from $before{$fibers} to $after{$fibers}: $fibers");
+    }
+}
+error("No partition survived the edit") if !$unchanged;
+
+ok(1);
+1;
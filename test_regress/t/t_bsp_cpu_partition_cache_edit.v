@@ -0,0 +1,41 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2023 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (
+    input wire clk
+);
+
+    reg [31:0] cnt = 32'h0;
+    always @(posedge clk) cnt <= cnt + 1;
+
+    // Independent lanes, so each one is a fiber of its own
+    genvar i;
+    generate
+        for (i = 0; i < 6; i = i + 1) begin : lane
+            reg [31:0] acc = 32'h0;
+`ifdef TEST_EDIT
+            // The edit only touches lane 0, the other lanes keep their fibers
+            if (i == 0) begin : edited
+                always @(posedge clk) acc <= acc + (cnt ^ 32'h1234);
+            end
+            else begin : same
+                always @(posedge clk) acc <= acc * 32'h3 + cnt + i;
+            end
+`else
+            always @(posedge clk) acc <= acc * 32'h3 + cnt + i;
+`endif
+        end
+    endgenerate
+
+    always @(posedge clk) begin
+        if (cnt == 8) begin
+            $display("acc = 0x%x 0x%x", lane[0].acc, lane[5].acc);
+            $write("*-* All Finished *-*\n");
+            $finish;
+        end
+    end
+
+endmodule
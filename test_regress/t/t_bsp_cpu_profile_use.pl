@@ -0,0 +1,41 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+top_filename("t/t_bsp_cpu_partition_cache_edit.v");
+
+# Profile the tiles of a first build, then partition a second one with it
+compile(
+    verilator_flags2 => ["--bsp-cpu -fipu-partition-cache"],
+    make_main => 0
+);
+
+execute(
+    all_run_flags => ["+bsp+profile"],
+    check_finished => 1
+);
+
+my $profile = glob_one("$Self->{obj_dir}/*_tileProfile.txt");
+file_grep($profile, qr/^\d+ \d+/m);
+
+compile(
+    verilator_flags2 => ["--bsp-cpu -fipu-partition-cache --stats --bsp-profile-use $profile"],
+    make_main => 0
+);
+
+file_grep($Self->{stats}, qr/BspSched, profiled fibers\s+[1-9]/i);
+
+execute(
+    check_finished => 1
+);
+
+ok(1);
+1;
@@ -0,0 +1,75 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt => 1);
+
+# Values each signal goes through, one BSP cycle is one time unit and one
+# --cc cycle is several, so only the order of the values can be compared
+sub vcd_values {
+    my $filename = shift;
+    my %names;
+    my %values;
+    my @scopes;
+    my $fh = IO::File->new("<$filename") or error("$! $filename");
+    while (defined(my $line = $fh->getline)) {
+        if ($line =~ /\$scope \S+ (\S+)/) {
+            push @scopes, $1;
+        } elsif ($line =~ /\$upscope/) {
+            pop @scopes;
+        } elsif ($line =~ /\$var \S+ \d+ (\S+) (\S+)/) {
+            push @{$names{$1}}, join(".", (grep { $_ ne "TOP" } @scopes), $2);
+        } elsif ($line =~ /^b([01xz]+) (\S+)/ || $line =~ /^([01xz])(\S+)/) {
+            my ($value, $code) = ($1, $2);
+            $value =~ s/^0+(?=.)//;
+            foreach my $name (@{$names{$code} || []}) {
+                my $seq = ($values{$name} ||= []);
+                push @$seq, $value if !@$seq || $seq->[-1] ne $value;
+            }
+        }
+    }
+    return \%values;
+}
+
+# Trace of the default flow
+compile(
+    verilator_flags2 => ["--cc --trace-fst"],
+);
+
+execute(
+    check_finished => 1,
+);
+
+fst2vcd($Self->trace_filename, "$Self->{obj_dir}/default.vcd");
+
+compile(
+    verilator_flags2 => ["--bsp-cpu --trace"],
+    make_main => 0
+);
+
+execute(
+    check_finished => 1,
+    all_run_flags => ["+trace+file+$Self->{obj_dir}/bsp.fst"],
+);
+
+fst2vcd("$Self->{obj_dir}/bsp.fst", "$Self->{obj_dir}/bsp.vcd");
+
+if (!$Self->errors && !$Self->skips) {
+    my $default = vcd_values("$Self->{obj_dir}/default.vcd");
+    my $bsp = vcd_values("$Self->{obj_dir}/bsp.vcd");
+    error("No signal in the --bsp-cpu trace") if !%$bsp;
+    foreach my $name (sort keys %$bsp) {
+        my $got = join(" ", @{$bsp->{$name}});
+        my $exp = join(" ", @{$default->{$name} || []});
+        error("Trace of $name differs\n  got: $got\n  exp: $exp\n") if $got ne $exp;
+    }
+}
+
+ok(1);
+1;
@@ -0,0 +1,35 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// The traced signals settle before the end, so the cycle computed after
+// $finish does not show up in the trace.
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2023 by Wilson Snyder.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (
+    input wire clk
+);
+
+    // verilator tracing_off
+    reg [31:0] cyc = 32'h0;
+    // verilator tracing_on
+    reg [7:0] cnt = 8'h0;
+    reg flag = 1'b0;
+    reg [99:0] wide = 100'h0;
+    reg [31:0] other = 32'h0;
+
+    always @(posedge clk) cyc <= cyc + 1;
+    always @(posedge clk) if (cnt != 8'd20) cnt <= cnt + 1;
+    always @(posedge clk) flag <= cnt[1] ^ cnt[3];
+    always @(posedge clk) if (cnt != 8'd20) wide <= {wide[67:0], 24'h5a5a5a, cnt};
+    always @(posedge clk) if (cnt[2:0] == 3'h3) other <= other + {24'h0, cnt};
+
+    always @(posedge clk) begin
+        if (cyc == 30) begin
+            $write("*-* All Finished *-*\n");
+            $finish;
+        end
+    end
+
+endmodule
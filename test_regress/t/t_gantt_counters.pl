@@ -0,0 +1,55 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+# Test for +verilator+prof+exec+counters, end to end through bin/verilator_gantt
+
+scenarios(vltmt => 1);
+
+top_filename("t/t_gen_alw.v");
+
+compile(
+    v_flags2 => ["--prof-exec"],
+    threads => 2,
+    );
+
+execute(
+    all_run_flags => ["+verilator+prof+exec+start+2",
+                      " +verilator+prof+exec+window+2",
+                      " +verilator+prof+exec+counters",
+                      " +verilator+prof+exec+file+$Self->{obj_dir}/profile_exec.dat",
+                      ],
+    check_finished => 1,
+    );
+
+run(cmd => ["$ENV{VERILATOR_ROOT}/bin/verilator_gantt",
+            "--no-vcd",
+            "$Self->{obj_dir}/profile_exec.dat",
+            "| tee $Self->{obj_dir}/gantt.log"],
+    );
+
+file_grep("$Self->{obj_dir}/gantt.log", qr/Total evals += 2/i);
+
+# The counters are not available on every host (containers, perf_event_paranoid),
+# in which case the run warns once and profiles without them
+if (file_contents("$Self->{obj_dir}/vlt_sim.log")
+    =~ /%Warning: Cannot open hardware performance counters/) {
+    file_grep_not("$Self->{obj_dir}/profile_exec.dat", qr/predictCost \d+ [a-zA-Z]+ \d+/);
+    file_grep_not("$Self->{obj_dir}/gantt.log", qr/Hardware counters/);
+} else {
+    # Not every event is counted on every CPU, so accept any of them
+    file_grep("$Self->{obj_dir}/profile_exec.dat", qr/VLPROFEXEC EVAL_END \d+ [a-zA-Z]+ \d+/);
+    file_grep("$Self->{obj_dir}/profile_exec.dat",
+              qr/VLPROFEXEC MTASK_END .* predictCost \d+ [a-zA-Z]+ \d+/);
+    file_grep("$Self->{obj_dir}/gantt.log", qr/Hardware counters/);
+    file_grep("$Self->{obj_dir}/gantt.log", qr/evals:/);
+}
+
+ok(1);
+1;
@@ -0,0 +1,51 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vlt_all => 1);
+
+# Copy 1 overrides the shared limit, a single copy ignores that override
+my @run_flags = ("+limit=3", "+1:limit=6");
+
+compile(
+    make_top_shell => 0,
+    make_main => 0,
+    verilator_flags2 => ["--exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+execute(
+    check_finished => 1,
+    all_run_flags => \@run_flags,
+    expect_filename => $Self->{golden_filename},
+    );
+
+# --instances 1 is the default, so a single copy finishes as before
+file_grep_not($Self->{run_log_filename}, qr/of instance/);
+file_grep($Self->{run_log_filename}, qr/Verilog \$finish$/m);
+
+compile(
+    make_top_shell => 0,
+    make_main => 0,
+    verilator_flags2 => ["--exe $Self->{t_dir}/$Self->{name}.cpp --instances 2"],
+    );
+
+my $log = "$Self->{obj_dir}/instances.log";
+execute(
+    check_finished => 1,
+    logfile => $log,
+    all_run_flags => \@run_flags,
+    );
+
+# Each copy reads its own plusargs, and the simulation only finishes once the
+# later copy finished too
+file_grep($log, qr/^limit=3 cyc=3\n.*^limit=6 cyc=6$/ms);
+file_grep($log, qr/\$finish of instance 0\n.*\$finish of instance 1\n.*\$finish$/ms);
+
+ok(1);
+1;
@@ -0,0 +1,28 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2023.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   integer limit = 0;
+
+   initial begin
+      if (!$value$plusargs("limit=%d", limit)) limit = 4;
+   end
+
+   always @(posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc == limit) begin
+         $write("limit=%0d cyc=%0d\n", limit, cyc);
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,45 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed under the Creative Commons Public Domain, for
+// any use, without warranty, 2023.
+// SPDX-License-Identifier: CC0-1.0
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+
+   // Independent lanes, each its own mtask, so every thread has work and
+   // writes variables of its own
+   genvar i;
+   generate
+      for (i = 0; i < 8; i = i + 1) begin : lane
+         logic [31:0] x = i + 1;
+         logic [31:0] y = 0;
+         always @(posedge clk) begin
+            x <= x * 32'd1664525 + 32'd1013904223 + i;
+            y <= y + (x ^ (x >> 7));
+         end
+      end
+   endgenerate
+
+   wire [31:0] sum = (lane[0].x ^ lane[0].y) + (lane[1].x ^ lane[1].y)
+               + (lane[2].x ^ lane[2].y) + (lane[3].x ^ lane[3].y)
+               + (lane[4].x ^ lane[4].y) + (lane[5].x ^ lane[5].y)
+               + (lane[6].x ^ lane[6].y) + (lane[7].x ^ lane[7].y);
+
+   always @(posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc == 99) begin
+`ifdef TEST_VERBOSE
+         $write("sum=%x\n", sum);
+`endif
+         if (sum !== 32'h0f5e648e) $stop;
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
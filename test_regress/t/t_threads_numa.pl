@@ -0,0 +1,32 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vltmt => 1);
+
+top_filename("t/t_threads_counter.v");
+
+if ($^O ne "linux") {
+    skip("NUMA placement requires Linux");
+} else {
+    compile(
+        verilator_flags2 => ['--cc', '--threads-numa'],
+        threads => 4
+        );
+
+    execute(
+        all_run_flags => ['+verilator+threads+numa+0'],
+        check_finished => 1,
+        );
+
+    file_grep($Self->{obj_dir} . "/$Self->{vm_prefix}__Syms.cpp", qr/numaPlace/);
+}
+
+ok(1);
+1;
@@ -0,0 +1,30 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vltmt => 1);
+
+top_filename("t/t_threads_mtasks.v");
+
+compile(
+    verilator_flags2 => ['--cc', '--threads-persistent'],
+    threads => 4
+    );
+
+# The lanes are spread over the workers, which are handed their job in one step
+my @files = glob_all("$Self->{obj_dir}/$Self->{VM_PREFIX}*.cpp");
+file_grep_any(\@files, qr/__Vm_threadPoolp->runPersistent\(/);
+file_grep_any(\@files, qr/__Vm_threadPoolp->waitPersistent\(\)/);
+
+execute(
+    check_finished => 1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,33 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vltmt => 1);
+
+top_filename("t/t_threads_mtasks.v");
+
+compile(
+    verilator_flags2 => ['--cc --stats'],
+    threads => 4
+    );
+
+file_grep($Self->{stats}, qr/MTask graph, final, mtask count\s+([2-9]|\d\d+)$/m);
+
+# Workers that block waiting for tasks, then workers that spin
+execute(
+    check_finished => 1,
+    );
+
+execute(
+    all_run_flags => ["+verilator+threads+spin"],
+    check_finished => 1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,44 @@
+#!/usr/bin/env perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2023 by Wilson Snyder. This program is free software; you
+# can redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+# SPDX-License-Identifier: LGPL-3.0-only OR Artistic-2.0
+
+scenarios(vltmt => 1);
+
+# The lanes are written by different threads
+top_filename("t/t_threads_mtasks.v");
+
+compile(
+    verilator_flags2 => ['--cc', '--stats'],
+    threads => 4
+    );
+
+# Declared in the previous order, by MTask affinity, variables of different threads
+# share cache lines, ordered by writer thread they do not
+file_grep($Self->{stats}, qr/Variable order, false shared cache lines before\s+([1-9]\d*)/i);
+file_grep($Self->{stats}, qr/Variable order, false shared cache lines after\s+(\d+)/i, 0);
+
+execute(
+    check_finished => 1,
+    );
+
+# The cache line aligned model is allocated with plain new, also without C++17,
+# where the thread groups are kept apart by padding rather than alignment
+compile(
+    verilator_flags2 => ['--cc', '-CFLAGS -std=c++14'],
+    threads => 4
+    );
+
+file_grep("$Self->{obj_dir}/$Self->{VM_PREFIX}___024root.h", qr/VL_CACHE_LINE_PAD\(__Vpad_/);
+
+execute(
+    check_finished => 1,
+    );
+
+ok(1);
+1;